@@ -0,0 +1,555 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  bankroll.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The bankroll store. The caller's thread only touches memory: it updates the sorted balances and
+ *               queues a journal record. The writer thread takes the whole queue at once, appends it to the journal
+ *               and syncs it, so the players settled in one round cost a single sync. Compaction writes the balances
+ *               to a new index, renames it over the old one and then empties the journal, so neither file grows
+ *               past the players and one compaction's worth of changes.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "bankroll.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define BANKROLL_MAGIC "BJBANK"
+#define BANKROLL_VERSION 1
+#define BANKROLL_COMMIT_MS 100          // how long the writer holds a group open for more changes
+#define BANKROLL_GROUP 256              // a group this big is committed without waiting
+#define BANKROLL_COMPACT_BYTES 65536    // journal past the index before the index is rewritten
+#define BANKROLL_REPLAY 256             // journal records read at a time when opening
+
+typedef struct BankrollIndexHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t numEntries;
+    uint64_t journalSize;               // bytes of the journal the entries include
+} BankrollIndexHeader;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static void *commit_changes(void *arg);
+static void compact_store(BankrollStore *store);
+static bool read_index(BankrollStore *store);
+static bool write_index(const char *path, const BankrollEntry *entries, uint32_t numEntries, uint64_t journalSize);
+static bool replay_journal(BankrollStore *store);
+static bool set_entry(BankrollStore *store, const BankrollEntry *entry);
+static uint32_t find_entry(const BankrollStore *store, const char *key, bool *found);
+static void make_key(const char *name, char *key);
+static uint32_t record_check(const BankrollEntry *entry);
+static char *store_path(const char *path, const char *suffix);
+
+/***************
+ *  Summary: Open the bankroll store
+ *
+ *  Description: Loads the balances from the index, replays the journal written since the index, and starts the
+ *      writer thread. A journal that ends in a torn record is cut back to the last whole one. The files are created
+ *      if they don't exist.
+ *
+ *  Parameter(s):
+ *      path: the store's path, the journal and index are path.journal and path.index
+ *
+ *  Returns:
+ *      store: pointer to the BankrollStore struct or NULL if an error
+ */
+BankrollStore *bankroll_open(const char *path)
+{
+    BankrollStore *store = calloc(1, sizeof(BankrollStore));
+    if (store == NULL)
+    {
+        zerror("Couldn't allocate memory for bankroll store.");
+        return NULL;
+    }
+
+    char *journalPath = store_path(path, ".journal");
+    store->indexPath = store_path(path, ".index");
+    store->journal = journalPath ? open(journalPath, O_RDWR | O_CREAT | O_APPEND, 0644) : -1;
+    if (store->journal < 0 || store->indexPath == NULL)
+    {
+        zerror("Couldn't open bankroll journal %s.", journalPath ? journalPath : path);
+        if (store->journal >= 0) close(store->journal);
+        free(journalPath);
+        free(store->indexPath);
+        free(store);
+        return NULL;
+    }
+    free(journalPath);
+
+    pthread_mutex_init(&store->lock, NULL);
+    pthread_cond_init(&store->wake, NULL);
+    if (!read_index(store) || !replay_journal(store)
+            || pthread_create(&store->writer, NULL, commit_changes, store) != 0)
+    {
+        zerror("Couldn't load bankroll store %s.", path);
+        pthread_cond_destroy(&store->wake);
+        pthread_mutex_destroy(&store->lock);
+        close(store->journal);
+        free(store->entries);
+        free(store->indexPath);
+        free(store);
+        return NULL;
+    }
+    zinfo("Bankroll store %s opened with %u players, %llu journal bytes to compact.", path, store->numEntries,
+            (unsigned long long) (store->journalSize - store->indexedSize));
+
+    return store;
+}
+
+/***************
+ *  Summary: Close the bankroll store
+ *
+ *  Description: The writer commits whatever is still queued and compacts the journal into the index before it stops,
+ *      so the next open has nothing to replay.
+ *
+ *  Parameter(s):
+ *      store: the BankrollStore struct, can be NULL
+ *
+ *  Returns:
+ *      N/A
+ */
+void bankroll_close(BankrollStore *store)
+{
+    if (store == NULL) return;
+
+    pthread_mutex_lock(&store->lock);
+    store->closing = true;
+    pthread_cond_signal(&store->wake);
+    pthread_mutex_unlock(&store->lock);
+    pthread_join(store->writer, NULL);
+
+    close(store->journal);
+    pthread_cond_destroy(&store->wake);
+    pthread_mutex_destroy(&store->lock);
+    free(store->entries);
+    free(store->queued);
+    free(store->indexPath);
+    free(store);
+
+    return;
+}
+
+/***************
+ *  Summary: Look up a player's bankroll
+ *
+ *  Parameter(s):
+ *      store: the BankrollStore struct
+ *      name: the player's name, only the first BANKROLL_NAME - 1 characters count
+ *      money: set to the player's balance if they're in the store
+ *
+ *  Returns:
+ *      bool: false if the player isn't in the store
+ */
+bool bankroll_lookup(BankrollStore *store, const char *name, uint32_t *money)
+{
+    char key[BANKROLL_NAME];
+    bool found;
+
+    make_key(name, key);
+    pthread_mutex_lock(&store->lock);
+    uint32_t pos = find_entry(store, key, &found);
+    if (found) *money = store->entries[pos].money;
+    pthread_mutex_unlock(&store->lock);
+
+    return found;
+}
+
+/***************
+ *  Summary: Record a player's new bankroll
+ *
+ *  Description: The balance changes in memory straight away and the change is queued for the writer, which commits
+ *      it with the other changes that arrive close by. A player not in the store is added.
+ *
+ *  Parameter(s):
+ *      store: the BankrollStore struct
+ *      name: the player's name
+ *      money: the player's balance
+ *
+ *  Returns:
+ *      bool: false if there wasn't the memory to record it
+ */
+bool bankroll_update(BankrollStore *store, const char *name, uint32_t money)
+{
+    BankrollRecord record = {.entry.money = money};
+    make_key(name, record.entry.name);
+    record.check = record_check(&record.entry);
+
+    pthread_mutex_lock(&store->lock);
+    bool updated = set_entry(store, &record.entry);
+    if (updated && store->numQueued == store->maxQueued)
+    {
+        uint32_t maxQueued = store->maxQueued ? store->maxQueued * 2 : BANKROLL_GROUP;
+        BankrollRecord *queued = realloc(store->queued, maxQueued * sizeof(BankrollRecord));
+        if (queued)
+        {
+            store->queued = queued;
+            store->maxQueued = maxQueued;
+        }
+        updated = (queued != NULL);
+    }
+    if (updated)
+    {
+        store->queued[store->numQueued++] = record;
+        // the first change starts the writer's group, a full group ends it early
+        if (store->numQueued == 1 || store->numQueued == BANKROLL_GROUP) pthread_cond_signal(&store->wake);
+    }
+    pthread_mutex_unlock(&store->lock);
+
+    if (!updated) zerror("Couldn't record %s's bankroll of %u.", name, money);
+    return updated;
+}
+
+/***************
+ *  Summary: The writer thread, committing the queued changes in groups
+ *
+ *  Description: Waits for a change, holds the group open for BANKROLL_COMMIT_MS so the rest of the round's changes
+ *      join it, then swaps the queue for its own buffer and writes and syncs the group without holding the lock.
+ *      A failed write is cut off the journal and the group is lost; the balances in memory still have it.
+ *
+ *  Parameter(s):
+ *      arg: the BankrollStore struct
+ *
+ *  Returns:
+ *      NULL
+ */
+static void *commit_changes(void *arg)
+{
+    BankrollStore *store = arg;
+    BankrollRecord *group = NULL;
+    uint32_t maxGroup = 0;
+
+    pthread_mutex_lock(&store->lock);
+    while (!store->closing || store->numQueued)
+    {
+        if (store->numQueued == 0)
+        {
+            pthread_cond_wait(&store->wake, &store->lock);
+            continue;
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += BANKROLL_COMMIT_MS * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        while (!store->closing && store->numQueued < BANKROLL_GROUP
+                && pthread_cond_timedwait(&store->wake, &store->lock, &deadline) != ETIMEDOUT)
+        {
+        }
+
+        BankrollRecord *queued = store->queued;
+        uint32_t numGroup = store->numQueued;
+        uint32_t maxQueued = store->maxQueued;
+        store->queued = group;
+        store->maxQueued = maxGroup;
+        store->numQueued = 0;
+        group = queued;
+        maxGroup = maxQueued;
+        pthread_mutex_unlock(&store->lock);
+
+        size_t size = numGroup * sizeof(BankrollRecord);
+        bool committed = (write(store->journal, group, size) == (ssize_t) size) && (fdatasync(store->journal) == 0);
+
+        pthread_mutex_lock(&store->lock);
+        if (committed)
+        {
+            store->journalSize += size;
+        }
+        else
+        {
+            zerror("Couldn't commit %u bankroll changes to the journal.", numGroup);
+            if (ftruncate(store->journal, store->journalSize)) zerror("Couldn't cut back the bankroll journal.");
+        }
+        zdebug("Committed %u bankroll changes.", numGroup);
+
+        // the index must match the journal it covers, so it's only written with nothing queued past it
+        if (store->numQueued == 0 && store->journalSize - store->indexedSize >= BANKROLL_COMPACT_BYTES)
+        {
+            compact_store(store);
+        }
+    }
+    if (store->journalSize != store->indexedSize) compact_store(store);
+    pthread_mutex_unlock(&store->lock);
+    free(group);
+
+    return NULL;
+}
+
+/***************
+ *  Summary: Rewrite the index from the balances and empty the journal, called by the writer with the lock held
+ *
+ *  Description: Copies the balances and writes them without the lock, so updates carry on meanwhile. The index is
+ *      written as covering none of the journal before the journal is cut back, so a crash in between only replays
+ *      records the index already has; they hold balances rather than changes, so replaying them again is harmless.
+ */
+static void compact_store(BankrollStore *store)
+{
+    uint32_t numEntries = store->numEntries;
+    uint64_t journalSize = store->journalSize;
+    BankrollEntry *entries = malloc((numEntries ? numEntries : 1) * sizeof(BankrollEntry));
+    if (entries == NULL)
+    {
+        zerror("Couldn't allocate memory to compact the bankroll journal.");
+        return;
+    }
+    memcpy(entries, store->entries, numEntries * sizeof(BankrollEntry));
+    pthread_mutex_unlock(&store->lock);
+
+    bool written = write_index(store->indexPath, entries, numEntries, 0);
+    free(entries);
+
+    pthread_mutex_lock(&store->lock);
+    if (written)
+    {
+        // only this thread appends to the journal, so it still ends at journalSize and the index holds all of it
+        store->indexedSize = 0;
+        if (ftruncate(store->journal, 0) == 0)
+        {
+            store->journalSize = 0;
+            zinfo("Bankroll index rewritten with %u players, %llu journal bytes compacted.", numEntries,
+                    (unsigned long long) journalSize);
+        }
+        else
+        {
+            zerror("Couldn't empty the bankroll journal, the next open replays all of it.");
+        }
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Load the balances from the index, if there is one
+ */
+static bool read_index(BankrollStore *store)
+{
+    int fd = open(store->indexPath, O_RDONLY);
+    if (fd < 0) return (errno == ENOENT);
+
+    BankrollIndexHeader header;
+    struct stat st;
+    bool loaded = (fstat(fd, &st) == 0) && (read(fd, &header, sizeof(header)) == sizeof(header))
+            && !memcmp(header.magic, BANKROLL_MAGIC, sizeof(BANKROLL_MAGIC)) && header.version == BANKROLL_VERSION
+            && (uint64_t) st.st_size == sizeof(header) + (uint64_t) header.numEntries * sizeof(BankrollEntry);
+    if (loaded && header.numEntries)
+    {
+        size_t size = header.numEntries * sizeof(BankrollEntry);
+        store->entries = malloc(size);
+        loaded = store->entries && (read(fd, store->entries, size) == (ssize_t) size);
+        store->numEntries = store->maxEntries = loaded ? header.numEntries : 0;
+    }
+    close(fd);
+
+    if (!loaded)
+    {
+        zerror("Bankroll index %s is damaged.", store->indexPath);
+        return false;
+    }
+    store->indexedSize = header.journalSize;
+
+    return true;
+}
+
+/***************
+ *  Summary: Write the balances to a new index and rename it over the old one
+ */
+static bool write_index(const char *path, const BankrollEntry *entries, uint32_t numEntries, uint64_t journalSize)
+{
+    BankrollIndexHeader header = {.magic = BANKROLL_MAGIC, .version = BANKROLL_VERSION, .numEntries = numEntries,
+            .journalSize = journalSize};
+    size_t size = numEntries * sizeof(BankrollEntry);
+
+    char *tempPath = store_path(path, ".tmp");
+    int fd = tempPath ? open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    bool written = (fd >= 0);
+    if (written)
+    {
+        written = (write(fd, &header, sizeof(header)) == sizeof(header))
+                && (write(fd, entries, size) == (ssize_t) size) && (fsync(fd) == 0);
+        written = (close(fd) == 0) && written;
+        written = written && (rename(tempPath, path) == 0);
+        if (!written) unlink(tempPath);
+    }
+    free(tempPath);
+
+    if (!written) zerror("Couldn't write bankroll index %s.", path);
+    return written;
+}
+
+/***************
+ *  Summary: Apply the journal written since the index, cutting off a torn record at its end
+ */
+static bool replay_journal(BankrollStore *store)
+{
+    struct stat st;
+    if (fstat(store->journal, &st)) return false;
+    uint64_t size = st.st_size;
+
+    if (size < store->indexedSize)
+    {
+        // the index is newer than the journal, so it's all there is
+        zerror("Bankroll journal is shorter than its index covers, starting the journal over.");
+        if (ftruncate(store->journal, 0)) return false;
+        store->journalSize = store->indexedSize = 0;
+        return true;
+    }
+
+    BankrollRecord records[BANKROLL_REPLAY];
+    uint64_t offset = store->indexedSize;
+    uint64_t replayed = 0;
+    bool torn = false;
+    while (offset < size && !torn)
+    {
+        ssize_t bytes = pread(store->journal, records, sizeof(records), offset);
+        if (bytes <= 0) return false;
+
+        uint32_t numRecords = bytes / sizeof(BankrollRecord);
+        torn = (numRecords == 0);
+        for (uint32_t record = 0; record < numRecords && !torn; record++)
+        {
+            torn = (records[record].check != record_check(&records[record].entry));
+            if (!torn && !set_entry(store, &records[record].entry)) return false;
+            offset += torn ? 0 : sizeof(BankrollRecord);
+            replayed += !torn;
+        }
+    }
+    if (offset != size)
+    {
+        zerror("Bankroll journal ends in a torn record, cutting it back to byte %llu.", (unsigned long long) offset);
+        if (ftruncate(store->journal, offset)) return false;
+    }
+    store->journalSize = offset;
+    zdebug("Replayed %llu bankroll changes.", (unsigned long long) replayed);
+
+    return true;
+}
+
+/***************
+ *  Summary: Set a player's balance, adding them in name order if they're new
+ */
+static bool set_entry(BankrollStore *store, const BankrollEntry *entry)
+{
+    bool found;
+    uint32_t pos = find_entry(store, entry->name, &found);
+    if (found)
+    {
+        store->entries[pos].money = entry->money;
+        return true;
+    }
+
+    if (store->numEntries == store->maxEntries)
+    {
+        uint32_t maxEntries = store->maxEntries ? store->maxEntries * 2 : 16;
+        BankrollEntry *entries = realloc(store->entries, maxEntries * sizeof(BankrollEntry));
+        if (entries == NULL) return false;
+        store->entries = entries;
+        store->maxEntries = maxEntries;
+    }
+    memmove(&store->entries[pos + 1], &store->entries[pos], (store->numEntries - pos) * sizeof(BankrollEntry));
+    store->entries[pos] = *entry;
+    store->numEntries++;
+
+    return true;
+}
+
+/***************
+ *  Summary: Binary search the balances for a name
+ *
+ *  Returns:
+ *      pos: where the name is, or where it would go if found is false
+ */
+static uint32_t find_entry(const BankrollStore *store, const char *key, bool *found)
+{
+    uint32_t low = 0;
+    uint32_t high = store->numEntries;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        int cmp = memcmp(store->entries[mid].name, key, BANKROLL_NAME);
+        if (cmp == 0)
+        {
+            *found = true;
+            return mid;
+        }
+        if (cmp < 0) low = mid + 1;
+        else high = mid;
+    }
+    *found = false;
+
+    return low;
+}
+
+static void make_key(const char *name, char *key)
+{
+    memset(key, 0, BANKROLL_NAME);
+    strncpy(key, name, BANKROLL_NAME - 1);
+
+    return;
+}
+
+/***************
+ *  Summary: FNV-1a over a journal entry
+ */
+static uint32_t record_check(const BankrollEntry *entry)
+{
+    const uint8_t *bytes = (const uint8_t *) entry;
+    uint32_t hash = 2166136261u;
+    for (size_t ii = 0; ii < sizeof(BankrollEntry); ii++)
+    {
+        hash = (hash ^ bytes[ii]) * 16777619u;
+    }
+
+    return hash;
+}
+
+static char *store_path(const char *path, const char *suffix)
+{
+    size_t size = strlen(path) + strlen(suffix) + 1;
+    char *fullPath = malloc(size);
+    if (fullPath) snprintf(fullPath, size, "%s%s", path, suffix);
+
+    return fullPath;
+}
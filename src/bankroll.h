@@ -0,0 +1,96 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  bankroll.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: A store of the players' bankrolls kept between games, keyed by name. Every change is appended to a
+ *               journal; an index of the balances, sorted by name, records how much of the journal it covers, so
+ *               opening the store reads the index and replays only the journal written since. Changes are queued
+ *               and committed by a background thread in groups, one sync per group, and the same thread rewrites
+ *               the index once enough journal has built up past it.
+ */
+
+#ifndef BANKROLL_H_
+#define BANKROLL_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/***********
+ * DEFINES *
+ ***********/
+#define BANKROLL_PATH "bankroll"    // default store, bankroll.journal and bankroll.index in the working directory
+#define BANKROLL_NAME 12            // room for a player's name and its terminator
+#define BANKROLL_START 1000         // money a new player starts with
+
+typedef struct BankrollEntry
+{
+    char name[BANKROLL_NAME];       // NUL padded so entries compare with memcmp
+    uint32_t money;
+} BankrollEntry;
+
+typedef struct BankrollRecord       // one change in the journal
+{
+    BankrollEntry entry;            // the player's balance after the change
+    uint32_t check;                 // checksum, a record torn by a crash ends the journal
+} BankrollRecord;
+
+typedef struct BankrollStore
+{
+    int journal;
+    char *indexPath;
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;            // signals the writer there are changes queued or the store is closing
+    BankrollEntry *entries;         // balances, sorted by name
+    uint32_t numEntries;
+    uint32_t maxEntries;
+    BankrollRecord *queued;         // changes waiting for the writer
+    uint32_t numQueued;
+    uint32_t maxQueued;
+    uint64_t journalSize;           // bytes committed to the journal
+    uint64_t indexedSize;           // bytes of the journal the index on disk covers
+    bool closing;
+} BankrollStore;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+BankrollStore *bankroll_open(const char *path);
+void bankroll_close(BankrollStore *store);
+bool bankroll_lookup(BankrollStore *store, const char *name, uint32_t *money);
+bool bankroll_update(BankrollStore *store, const char *name, uint32_t money);
+
+#endif /* BANKROLL_H_ */
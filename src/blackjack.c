@@ -36,49 +36,138 @@
 #include <limits.h>
 #include <unistd.h>
 #include <locale.h>
+#include <signal.h>
 
+#include "bankroll.h"
 #include "curses_output.h"
+#include "renderer.h"
+#include "engine.h"
+#include "seat_batch.h"
+#include "shoe_prep.h"
+#include "snapshot.h"
+#include "strategy.h"
+#include "text_output.h"
+#include "phase_timer.h"
 #include "logger.h"
 
 /***********
  * DEFINES *
  ***********/
-enum errorCode {NO_ERROR, ERR_PLAYER_ALLOC, ERR_DEALER_ALLOC, ERR_DECK_ALLOC, PLAYER_QUIT};
+enum errorCode {NO_ERROR, ERR_PLAYER_ALLOC, ERR_DEALER_ALLOC, ERR_DECK_ALLOC, ERR_BATCH_ALLOC, PLAYER_QUIT};
+
+static const Renderer *renderers[] = {&CURSES_RENDERER, &TEXT_RENDERER, &NULL_RENDERER};
 
 /****************
  * DECLARATIONS *
  ****************/
 uint8_t setup_table(Table *table);
-uint8_t get_num_players();
-Player *init_players(uint8_t num_players);
+uint8_t resume_table(Table *table);
+uint8_t get_num_players(const Renderer *ui);
+Player *init_players(uint8_t num_players, BankrollStore *bankroll, const Renderer *ui);
 Dealer *init_dealer();
 void play_game(Table *table);
-void deal_hands(Table *table);
+bool deal_hands(Table *table);
 bool check_dealer_hand(Table *table);
 void play_hands(Table *table);
 bool get_bets(Table *table);
-void play_dealer_hand(Dealer *dealer, Deck *shoe, WINDOW* msgWin);
-bool double_down(Player *player, Hand *hand, WINDOW* msgWin);
-bool check_table(Table table, bool dealerBlackjack);
-void clear_hands(Hand *hand);
-bool split_hand(Hand *handToSplit, uint32_t *bank, Deck *shoe);
+void play_dealer_hand(Dealer *dealer, Deck *shoe, const Renderer *ui, const Rules *rules);
+bool double_down(Player *player, Hand *hand, const Renderer *ui, const Rules *rules);
+bool check_table(Table *table, bool dealerBlackjack);
+void report_result(Table *table, Player *player, HandResult result, uint32_t moneyWon);
+void offer_insurance(Table *table);
 
-int main()
+int main(int argc, char *argv[])
 {
+    const char *strategyPath = NULL;
+    const char *rulesPath = NULL;
+    const char *checkpointPath = NULL;
+    const char *bankrollPath = BANKROLL_PATH;
+    const Renderer *ui = &CURSES_RENDERER;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:R:C:B:u:")) != -1)
+    {
+        switch (opt)
+        {
+            case 's':
+                strategyPath = optarg;
+                break;
+            case 'R':
+                rulesPath = optarg;
+                break;
+            case 'C':
+                checkpointPath = optarg;
+                break;
+            case 'B':
+                bankrollPath = optarg;
+                break;
+            case 'u':
+                ui = NULL;
+                for (size_t renderer = 0; renderer < sizeof(renderers) / sizeof(renderers[0]); renderer++)
+                {
+                    if (strcmp(optarg, renderers[renderer]->name) == 0) ui = renderers[renderer];
+                }
+                if (ui) break;
+                fprintf(stderr, "Unknown display %s, use curses, text or null.\n", optarg);
+                return EXIT_FAILURE;
+            default:
+                fprintf(stderr, "Usage: %s [-s strategy.so] [-R rules.conf] [-C checkpoint] [-B bankroll] "
+                        "[-u curses|text|null]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
     // seed random number generator
 #if DEBUG
-    srandom(1968);
+    seed_random(1968);
 #else
-    srandom(time(NULL));
+    seed_random(time(NULL));
 #endif
     setlocale(LC_ALL, "");
 
-    if (init_zlog("blackjack.conf", "log")) return ERR;
+    if (init_zlog("blackjack.conf", "log")) return EXIT_FAILURE;
 
-    init_window();
-    zinfo("ncurses initialized.");
-    welcome_screen();
-    zinfo("Welcome screen displayed.");
+    // load the rules and strategy plugin before starting the display so errors go to the terminal
+    Rules rules = RULES_S17;
+    if (rulesPath && !load_rules(rulesPath, &rules))
+    {
+        fprintf(stderr, "Couldn't read rules file %s, see the log.\n", rulesPath);
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    const Strategy *strategy = NULL;
+    if (strategyPath && !(strategy = load_strategy(strategyPath)))
+    {
+        fprintf(stderr, "Couldn't load strategy plugin %s.\n", strategyPath);
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    // an existing checkpoint resumes the game saved in it, with the rules it was played by
+    Table resumed = {0};
+    Snapshot *snapshot = NULL;
+    if (checkpointPath && access(checkpointPath, F_OK) == 0
+            && !(snapshot = snapshot_restore(checkpointPath, &resumed, &rules)))
+    {
+        fprintf(stderr, "Couldn't restore checkpoint %s, see the log.\n", checkpointPath);
+        unload_strategy();
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    BankrollStore *bankroll = bankroll_open(bankrollPath);
+    if (bankroll == NULL)
+    {
+        fprintf(stderr, "Couldn't open bankroll store %s, see the log.\n", bankrollPath);
+        snapshot_close(snapshot);
+        unload_strategy();
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    ui->open();
+    zinfo("%s display opened.", ui->name);
 
     // create table struct
     Table *table = calloc(1, sizeof(Table));
@@ -89,15 +178,38 @@ int main()
     }
     else
     {
-        switch (setup_table(table))
+        table->ui = ui;
+        table->strategy = strategy;
+        table->rules = &rules;
+        table->checkpoint = checkpointPath;
+        table->bankroll = bankroll;
+        if (snapshot)
+        {
+            table->numPlayers = resumed.numPlayers;
+            table->players = resumed.players;
+            table->dealer = resumed.dealer;
+            table->shoe = resumed.shoe;
+            table->snapshot = snapshot;
+        }
+        switch (snapshot ? resume_table(table) : setup_table(table))
         {
             /***** No breaks or default on purpose *****/
             case NO_ERROR:
                 zinfo("Calling play game with table->numPlayers: %i, table->players: %p, table->dealer: %p.",
                         table->numPlayers, table->players, table->dealer);
                 play_game(table);
-                zdebug("Freeing message window: %p.", table->msgWin);
-                delwin(table->msgWin);
+                zdebug("Freeing table->batch: %p.", table->batch);
+                seat_batch_free(table->batch);
+            case ERR_BATCH_ALLOC:
+                if (table->snapshot)
+                {
+                    // the players, dealer and shoe live in the mapped snapshot
+                    zdebug("Closing table->snapshot: %p.", table->snapshot);
+                    snapshot_close(table->snapshot);
+                    zdebug("Freeing table: %p.", table);
+                    free(table);
+                    break;
+                }
                 zdebug("Freeing table->shoe->shoe: %p.", table->shoe->shoe);
                 free(table->shoe->shoe);
                 zdebug("Freeing table->shoe: %p.", table->shoe);
@@ -115,8 +227,10 @@ int main()
         }
     }
 
-    zlog_debug(zc, "Stopping ncurses.");
-    end_window();
+    zlog_debug(zc, "Closing the %s display.", ui->name);
+    ui->close();
+    bankroll_close(bankroll);
+    unload_strategy();
     end_zlog();
 
     return 0;
@@ -137,7 +251,7 @@ int main()
 uint8_t setup_table(Table *table)
 {
     // get the number of players at table
-    table->numPlayers = get_num_players();
+    table->numPlayers = get_num_players(table->ui);
     if (table->numPlayers == 0)
     {
         zdebug("Got 0 back which means player wants to quit.");
@@ -145,7 +259,7 @@ uint8_t setup_table(Table *table)
     }
 
     // instantiate player(s)
-    table->players = init_players(table->numPlayers);
+    table->players = init_players(table->numPlayers, table->bankroll, table->ui);
     zdebug("table->players pointer: %p.", table->players);
     if (!table->players)
     {
@@ -170,71 +284,81 @@ uint8_t setup_table(Table *table)
         zerror("Couldn't allocate memory for deck of cards.");
         return ERR_DECK_ALLOC;
     }
+
+    table->batch = seat_batch_new(table->numPlayers * table->rules->maxHands);
+    zdebug("table->batch pointer: %p.", table->batch);
+    if (!table->batch)
+    {
+        zerror("Couldn't allocate memory for seat batch.");
+        return ERR_BATCH_ALLOC;
+    }
     
-    table->msgWin = init_message_window();
+    table->ui->seat(table);
     return NO_ERROR;
 }
 
 /***************
- *  Summary: Get the number of players
+ *  Summary: Set-up a table restored from a checkpoint
  *
- *  Description: Asks how many players will be playing, only accepting 1 to 5 players. All other
- *      keypresses besides 'q' (for quitting the game) will be ignored.
+ *  Description: The players, dealer and shoe came from the snapshot, so only the seat batch and the message window
+ *      are left to create.
  *
  *  Parameter(s):
- *      N/A
+ *      table: a pointer to the Table struct
  *
  *  Returns:
- *      numOfPlayers: The number of players playing blackjack
+ *      error:
  */
-uint8_t get_num_players()
+uint8_t resume_table(Table *table)
 {
-    uint8_t numOfPlayers = 0;
-    char input;
-
-    curs_set(CURS_NORMAL);
-    mvwaddstr(stdscr, 0, 0, "How many people are playing? (1-5 or q to quit.) ");
-
-    while (numOfPlayers == 0)
+    zinfo("Resuming %i players from checkpoint %s.", table->numPlayers, table->checkpoint);
+    table->batch = seat_batch_new(table->numPlayers * table->rules->maxHands);
+    zdebug("table->batch pointer: %p.", table->batch);
+    if (!table->batch)
     {
-        input = wgetch(stdscr);
-
-        // q was entered to quit program
-        if (tolower(input) == 'q')
-        {
-            numOfPlayers = 0;
-            zdebug("'q' was entered. Exiting loop.");
-            break;
-        }
-
-        // convert input to a number and make sure it's in our acceptable range
-        if (atoi(&input))
-        {
-            numOfPlayers = (atoi(&input) > 5) ? 0 : 1; // TODO change 1 back to atoi(&input) when ready
-        }
+        zerror("Couldn't allocate memory for seat batch.");
+        return ERR_BATCH_ALLOC;
     }
 
+    table->ui->seat(table);
+    return NO_ERROR;
+}
+
+/***************
+ *  Summary: Get the number of players
+ *
+ *  Description: Asks how many players will be playing, 1 to 5, or none to quit the game.
+ *
+ *  Parameter(s):
+ *      ui: the Renderer to ask through
+ *
+ *  Returns:
+ *      numOfPlayers: The number of players playing blackjack
+ */
+uint8_t get_num_players(const Renderer *ui)
+{
+    uint8_t numOfPlayers = ui->num_players(MAX_PLAYERS);
     zinfo("Got %i players as input.", numOfPlayers);
-    waddch(stdscr, input);
-    curs_set(CURS_INVIS);
 
-    return numOfPlayers;
+    return (numOfPlayers > 1) ? 1 : numOfPlayers;   // TODO return numOfPlayers when ready
 }
 
 /***************
  *  Summary: Instantiate the players array
  *
- *  Description: Sets up the players array by getting the names of all the players and giving each
- *      one an initial bank of $1,000.
+ *  Description: Sets up the players array by getting the names of all the players. A player in the bankroll
+ *      store picks up with the money they left with, anyone new or who left broke gets an initial bank of $1,000.
  *
  *  Parameter(s):
  *      numPlayers: the number of player structs to set up. Must be between 1 and 5 inclusive.
+ *      bankroll: the BankrollStore to look the players up in
+ *      ui: the Renderer to ask for the names through; a player who gives none is called after their seat
  *
  *  Returns:
  *      players: a pointer to an array of player structs with their name and initial amount of money
  *          or NULL if we couldn't allocate memory
  */
-Player *init_players(uint8_t numPlayers)
+Player *init_players(uint8_t numPlayers, BankrollStore *bankroll, const Renderer *ui)
 {
     if (numPlayers < 1 || numPlayers > 5)
     {
@@ -247,22 +371,21 @@ Player *init_players(uint8_t numPlayers)
     if (players)
     {
         /***** Get player names *****/
-        curs_set(CURS_NORMAL); // enable cursor
-        mvwaddstr(stdscr, 2, 0, "Player names are limited to 10 characters max.");
-        echo(); // Turn echo on temporarily
         for (uint8_t ii = 0; ii < numPlayers; ii++)
         {
-            mvwprintw(stdscr, 3 + ii, 0, "What is player %i's name? ", ii + 1);
-            wgetnstr(stdscr, players[ii].name, 10);
-            players[ii].money = 1000;
+            if (!ui->player_name(ii, players[ii].name, sizeof(players[ii].name)))
+            {
+                snprintf(players[ii].name, sizeof(players[ii].name), "Player %u", ii + 1);
+            }
+            if (!bankroll_lookup(bankroll, players[ii].name, &players[ii].money) || players[ii].money == 0)
+            {
+                players[ii].money = BANKROLL_START;
+            }
+            zinfo("%s starts with %u.", players[ii].name, players[ii].money);
             players[ii].hand.cards = NULL;
             players[ii].hand.bet = 0;
             players[ii].hand.nextHand = NULL;
         }
-        noecho();
-        curs_set(CURS_INVIS);   // disable cursor
-        wclear(stdscr);         // clear screen before returning
-        wrefresh(stdscr);       // display the screen
     }
     
     return players;
@@ -314,14 +437,25 @@ void play_game(Table *table)
 {
     zinfo("play_game called with num_players: %i, players: %p, dealer: %p.",
             table->numPlayers, table->players, table->dealer);
-    zinfo("Shuffling shoe.");
-    shuffle_cards(table->shoe);
-    print_message(table->msgWin, "Shuffling the shoe.");
+    if (!table->snapshot)   // a restored shoe carries on from where it was dealt to
+    {
+        zinfo("Shuffling shoe.");
+        PHASE_START(shuffleStart);
+        shuffle_cards(table->shoe);
+        PHASE_END(PHASE_SHUFFLE, shuffleStart);
+        table->ui->message("Shuffling the shoe.");
+    }
+    // a continuous shuffler never runs the shoe down to the cut card, so there's no next shoe to shuffle ahead
+    if (!table->rules->continuousShuffle) table->prep = shoe_prep_start(table->shoe, shoe_prep_seed());
+    zdebug("table->prep pointer: %p.", table->prep);
+    PHASE_DUMP_ON(SIGUSR1);
 
     zdebug("Setting game_over flag and starting game loop.");
     bool gameOver = FALSE;
     while (!gameOver)
     {
+        PHASE_POLL(NULL);   // a SIGUSR1 since the last round logs the phase timings
+
         // Reset players & dealer number of cards to 0
         for (uint8_t i = 0; i < table->numPlayers; i++)
         {
@@ -331,30 +465,66 @@ void play_game(Table *table)
         clear_hands(&table->dealer->hand);
         table->dealer->faceup = FALSE;
 
-        // Display the windows for players & dealer
-        zinfo("Display windows.");
-        wclear(stdscr);
-        wrefresh(stdscr);
-        display_dealer(table->dealer);
-        for (uint8_t i = 0; i < table->numPlayers; i++)
+        // the hands are empty between rounds, so this is where the table can be saved
+        if (table->checkpoint && !snapshot_save(table->checkpoint, table, NULL, 0))
         {
-            display_player(&table->players[i]);
+            table->ui->message("Couldn't save the checkpoint.");
         }
+
+        // Display the windows for players & dealer
+        zinfo("Display windows.");
+        table->ui->table(table);
         
         zinfo("Get bets from players.");
-        if ((gameOver = get_bets(table))) continue;
+        PHASE_START(betsStart);
+        gameOver = get_bets(table);
+        PHASE_END(PHASE_BETS, betsStart);
+        if (gameOver) continue;
+
         zinfo("Calling deal_hands for initial deal.");
-        deal_hands(table);
+        PHASE_START(dealStart);
+        bool dealt = deal_hands(table);
+        PHASE_END(PHASE_DEAL, dealStart);
+        if (!dealt)  // even a full shoe can't go round the table, so hand the bets back and stop
+        {
+            for (uint8_t i = 0; i < table->numPlayers; i++)
+            {
+                table->players[i].money += table->players[i].hand.bet;
+                table->players[i].hand.bet = 0;
+                bankroll_update(table->bankroll, table->players[i].name, table->players[i].money);
+            }
+            table->ui->message("The shoe is too small to deal a round. Game over.");
+            gameOver = TRUE;
+            continue;
+        }
+
         zinfo("Check dealer hand for blackjack.");
-        if (check_dealer_hand(table) == FALSE)  // if dealer has blackjack we skip the players turns
+        PHASE_START(checkStart);
+        bool dealerBlackjack = check_dealer_hand(table);
+        PHASE_END(PHASE_DEALER_CHECK, checkStart);
+        if (dealerBlackjack == FALSE)  // if dealer has blackjack we skip the players turns
         {
+            PHASE_START(handsStart);
             play_hands(table);
-            play_dealer_hand(table->dealer, table->shoe, table->msgWin);
+            PHASE_END(PHASE_PLAY_HANDS, handsStart);
+
+            PHASE_START(dealerStart);
+            play_dealer_hand(table->dealer, table->shoe, table->ui, table->rules);
+            PHASE_END(PHASE_DEALER_HAND, dealerStart);
         }
         zinfo("******************************");
-        gameOver = check_table(*table, FALSE);
+        PHASE_START(settleStart);
+        gameOver = check_table(table, dealerBlackjack);
+        PHASE_END(PHASE_SETTLE, settleStart);
         zinfo("******************************");
+        if (gameOver && table->checkpoint)  // everyone is broke, there's no game left to resume
+        {
+            unlink(table->checkpoint);
+        }
     }
+    shoe_prep_stop(table->prep);
+    table->prep = NULL;
+    PHASE_REPORT(NULL);
 
     return;
 }
@@ -363,48 +533,65 @@ void play_game(Table *table)
  *  Summary: Deal the initial hands to the table
  *
  *  Description: Deal the initial round of cards to the table, setting the dealers faceup boolean to
- *      false.
+ *      false. If the shoe runs short the discards are shuffled back in and the deal tried again.
  *
  *  Parameter(s):
  *  	table: Table struct containing everything
  *
  *	Returns:
- *		N/A
+ *		bool: FALSE if the shoe can't deal the round even with every card back in it
  */
-void deal_hands(Table *table)
+bool deal_hands(Table *table)
 {
-    // re-shuffle the deck if we're nearing the end
-    // TODO Get rid of magic number. Switch to calculated random point or just use a #define
-    if ((table->shoe->cards - table->shoe->deal) < (table->shoe->cards * 0.2))
+    Hand *hands[MAX_PLAYERS + 1];
+    uint8_t numHands = 0;
+
+    for (uint8_t i = 0; i < table->numPlayers && i < MAX_PLAYERS; i++)
+    {
+        hands[numHands++] = &table->players[i].hand;
+    }
+    hands[numHands++] = &table->dealer->hand;
+
+    // a continuous shuffler takes the last round's discards back; otherwise re-shuffle the deck if we're nearing the
+    // end, or there aren't the cards left to go round
+    if (table->rules->continuousShuffle)
+    {
+        PHASE_START(shuffleStart);
+        shuffle_discards(table->shoe);
+        PHASE_END(PHASE_SHUFFLE, shuffleStart);
+    }
+    else if (shoe_needs_shuffle(table->shoe) || (table->shoe->cards - table->shoe->deal) < numHands * INITIAL_CARDS)
     {
         zinfo("Re-shuffling deck.");
-        print_message(table->msgWin, "Re-shuffling the deck.");
-        shuffle_cards(table->shoe);
+        table->ui->message("Re-shuffling the deck.");
+        PHASE_START(shuffleStart);
+        if (table->prep) shoe_prep_swap(table->prep);
+        else shuffle_discards(table->shoe);
+        PHASE_END(PHASE_SHUFFLE, shuffleStart);
     }
 
-    print_message(table->msgWin, "Dealing cards.");
+    table->ui->message("Dealing cards.");
     
     // deal two cards to players and dealer
-    for (uint8_t c = 0; c < 2; c++)
+    if (!deal_round(table->shoe, hands, numHands))
     {
-        for (uint8_t i = 0; i < table->numPlayers; i++)
-        {
-            deal_card(table->shoe, &table->players[i].hand);
-        }
-        deal_card(table->shoe, &table->dealer->hand);
+        zinfo("Shoe ran short, re-shuffling the discards.");
+        table->ui->message("Re-shuffling the deck.");
+        shuffle_discards(table->shoe);
+        if (!deal_round(table->shoe, hands, numHands)) return FALSE;
     }
 
 //    zinfo("Set dealer faceup flag to false. Returning.");
 //    table->dealer->faceup = false;
 
     // display player and dealer hands
-    display_dealer(table->dealer);
+    table->ui->dealer(table->dealer);
     for (uint8_t i = 0; i < table->numPlayers; i++)
     {
-        display_player(&table->players[i]);
+        table->ui->player(&table->players[i]);
     }
     
-    return;
+    return TRUE;
 }
 
 /***************
@@ -412,8 +599,8 @@ void deal_hands(Table *table)
  *
  *  Description: Checks the dealer's hand in order to offer insurance or for blackjack which is an
  *      automatic win. First check dealer upcard for an Ace, and offer insurance to players if true.
- *      If not an Ace (or after offering insurance) check if we have a blackjack, and collect all
- *      bets if we do.
+ *      If not an Ace (or after offering insurance) check if we have a blackjack, settling the
+ *      insurance bets either way; the hands themselves are settled by check_table.
  *
  *  Parameter(s):
  *      dealer: pointer to Dealer struct
@@ -424,7 +611,6 @@ void deal_hands(Table *table)
 bool check_dealer_hand(Table *table)
 {
     Dealer dealer = *table->dealer;
-//    WINDOW msgWin = *table->msgWin;
     
     if (dealer.hand.cards == NULL)
     {
@@ -433,25 +619,39 @@ bool check_dealer_hand(Table *table)
     }
     
     // if our upcard is not a face card or Ace, no need to run the checks
-    if (dealer.hand.cards->nextCard->card->value < 10)
+    if (dealer_upcard(&dealer.hand)->value < 10)
     {
         zinfo("Upcard is not an Ace or face card. Exiting check.");
         return FALSE;
     }
     
     // check for Ace in dealer upcard and offer insurance if it is
-    if (!strcmp(dealer.hand.cards->nextCard->card->rank, " A"))
+    if (!strcmp(dealer_upcard(&dealer.hand)->rank, " A"))
     {
         zinfo("Dealer is showing an Ace.");
-        print_message(table->msgWin, "Dealer is showing an Ace. Offering insurance bets.");
-        //TODO offer players insurance
+        table->ui->message("Dealer is showing an Ace. Offering insurance bets.");
+        offer_insurance(table);
     }
 
     // No Ace or we've offered insurance, now check if we have blackjack
-    if (blackjack_count(dealer.hand) == 21)
+    bool dealerBlackjack = dealer_has_blackjack(&dealer.hand);
+    for (uint8_t player = 0; player < table->numPlayers; player++)
+    {
+        Player *currentPlayer = &table->players[player];
+        if (currentPlayer->hand.insurance == 0) continue;
+
+        char msg[80];
+        uint32_t payout = settle_insurance(&currentPlayer->hand, dealerBlackjack, &currentPlayer->money);
+        if (payout) snprintf(msg, sizeof(msg), "%s's insurance pays %u.", currentPlayer->name, payout);
+        else snprintf(msg, sizeof(msg), "%s loses the insurance bet.", currentPlayer->name);
+        table->ui->message(msg);
+        table->ui->player(currentPlayer);
+    }
+
+    if (dealerBlackjack)
     {
         zinfo("Dealer has blackjack. Players lose.");
-        print_message(table->msgWin, "Dealer has blackjack! Everybody loses.");
+        table->ui->message("Dealer has blackjack!");
         return TRUE;
     }
 
@@ -472,8 +672,6 @@ bool check_dealer_hand(Table *table)
  */
 void play_hands(Table *table)
 {
-    struct timespec sleep = {.tv_nsec = 500000000, .tv_sec = 0};
-    struct timespec remain;
     for (uint8_t player = 0; player < table->numPlayers; player++)
     {
         Player *currentPlayer = &table->players[player];
@@ -485,45 +683,65 @@ void play_hands(Table *table)
             bool playHand = TRUE;
             while (playHand)
             {
-                switch(get_player_choice(currentPlayer, table->msgWin))
+                PHASE_START(inputStart);
+                PlayerChoice choice = table->strategy
+                        ? strategy_decide(table->strategy, currentHand, &table->dealer->hand, table->shoe,
+                                currentPlayer->money, table->rules)
+                        : table->ui->choice(currentPlayer, can_surrender(currentHand, table->rules));
+                PHASE_END(PHASE_INPUT, inputStart);
+                switch(choice)
                 {
                     case STAND:
                         playHand = FALSE;
                         break;
                     case HIT:
-                        // get a new card
-                        deal_card(table->shoe, currentHand);
-                        if (blackjack_count(*currentHand) > 21)
+                        // get a new card, or stand if the shoe has run out
+                        if (!deal_card(table->shoe, currentHand))
                         {
-                            print_message(table->msgWin, "You've busted!");
+                            table->ui->message("The shoe is out of cards, standing.");
+                            playHand = FALSE;
+                        }
+                        else if (blackjack_count(*currentHand) > 21)
+                        {
+                            table->ui->message("You've busted!");
                             playHand = FALSE;    // player busted
                         }
-                        display_player(currentPlayer);
+                        table->ui->player(currentPlayer);
                         break;
                     case DOUBLE:
-                        if (double_down(currentPlayer, currentHand, table->msgWin))
+                        if (can_deal(table->shoe, 1)
+                                && double_down(currentPlayer, currentHand, table->ui, table->rules))
                         {
                             deal_card(table->shoe, currentHand);
                             playHand = FALSE;
                         }
-                        display_player(currentPlayer);
+                        table->ui->player(currentPlayer);
                         break;
                     case SPLIT:
-                        if (split_hand(currentHand, &currentPlayer->money, table->shoe))
+                        if (split_hand(currentHand, &currentPlayer->money, table->shoe, table->rules))
                         {
-                            print_message(table->msgWin, "Hand split successfully.");
+                            table->ui->message("Hand split successfully.");
                         }
                         else
                         {
-                            print_message(table->msgWin, "Hand not split. Cards not same value or not enough money.");
+                            table->ui->message("Hand not split. Cards not same value, too many hands or not "
+                                    "enough money.");
+                        }
+                        table->ui->player(currentPlayer);
+                        break;
+                    case SURRENDER:
+                        if (play_choice(currentHand, &currentPlayer->money, table->shoe, SURRENDER, table->rules)
+                                == HAND_FINISHED)
+                        {
+                            table->ui->message("Hand surrendered.");
+                            playHand = FALSE;
                         }
-                        display_player(currentPlayer);
                         break;
                     default:
                         // no default case
                         break;
                 }
-                nanosleep(&sleep, &remain);
+                if (!table->strategy) table->ui->pause();   // no need to pause for a plugin
             }
         currentHand = currentHand->nextHand;
         }
@@ -550,22 +768,30 @@ bool get_bets(Table *table)
     char *endptr = NULL;
     char msg[80];
     long bet = 0;
-    echo();
     
     zinfo("Start player loop.");
     for (uint8_t player = 0; player < table->numPlayers; player++)
     {
+        if (table->strategy)
+        {
+            bet = strategy_bet(table->strategy, table->shoe, table->players[player].money, table->rules);
+            table->players[player].hand.bet = (uint32_t) bet;
+            table->players[player].money -= (uint32_t) bet;
+            continue;
+        }
+
         zinfo("Input while loop");
         bool validBet = FALSE;
         while (!validBet)
         {
             zinfo("Print prompt and get input");
             snprintf(msg, sizeof(msg), "%s, how much money do you wish to bet? ('q' to quit.) ", table->players[player].name);
-            print_message(table->msgWin, msg);
-            wgetnstr(table->msgWin, input, 7);
+            PHASE_START(inputStart);
+            bool answered = table->ui->read_line(msg, input, sizeof(input));
+            PHASE_END(PHASE_INPUT, inputStart);
             
-            // check if player wants to quit
-            if (tolower(input[0]) == 'q')
+            // check if player wants to quit, or has no more input to give
+            if (!answered || tolower(input[0]) == 'q')
             {
                 table->numPlayers--;
                 validBet = TRUE;
@@ -595,12 +821,11 @@ bool get_bets(Table *table)
                 char output[80];
                 snprintf(output, 80, "Invalid amount bet. Must be between 0 and %u. Press a key to try again.",
                         table->players[player].money);
-                print_message(table->msgWin, output);
+                table->ui->message(output);
             }
         }
     }
     
-    noecho();
     return (table->numPlayers == 0);
 }
 
@@ -613,27 +838,26 @@ bool get_bets(Table *table)
  *  Parameter(s):
  *      dealer: Dealer struct with dealer's hand
  *      shoe:   shoe of cards to deal a card from if needed
+ *      ui:     the Renderer showing the play
  *
  *  Returns:
  *      N/A
  */
-void play_dealer_hand(Dealer *dealer, Deck *shoe, WINDOW* msgWin)
+void play_dealer_hand(Dealer *dealer, Deck *shoe, const Renderer *ui, const Rules *rules)
 {
     zinfo("Set dealer->faceup flag to TRUE.");
     dealer->faceup = TRUE;
-    display_dealer(dealer);
-    struct timespec sleep = {.tv_nsec = 500000000, .tv_sec = 0};
-    struct timespec remain;
+    ui->dealer(dealer);
     
-    while (blackjack_count(dealer->hand) < 17)
+    while (dealer_must_hit(&dealer->hand, rules) && can_deal(shoe, 1))
     {
-        print_message(msgWin, "Dealer hits.");
+        ui->message("Dealer hits.");
         deal_card(shoe, &dealer->hand);
-        display_dealer(dealer);
-        nanosleep(&sleep, &remain);
+        ui->dealer(dealer);
+        ui->pause();
     }
     
-    print_message(msgWin, "Dealer stands.");
+    ui->message("Dealer stands.");
     zinfo("Dealer is at 17 or greater. Standing.");
     return;
 }
@@ -646,22 +870,21 @@ void play_dealer_hand(Dealer *dealer, Deck *shoe, WINDOW* msgWin)
  *
  *  Parameter(s):
  *      player: Player struct with player's hand
+ *      rules: the table's Rules, which may restrict doubling down
  *
  *  Returns:
  *      bool:   TRUE if we could double down, FALSE if couldn't
  */
-bool double_down(Player *player, Hand *hand, WINDOW* msgWin)
+bool double_down(Player *player, Hand *hand, const Renderer *ui, const Rules *rules)
 {
-    // check we have enough money to double down
-    if (hand->bet > player->money)
+    // check the rules allow it and we have enough money to double down
+    if (!double_bet(hand, &player->money, rules))
     {
-        print_message(msgWin, "Not enough money to double down! Choose another option.");
+        ui->message("Can't double down on this hand! Choose another option.");
         return FALSE;
     }
     
-    player->money -= hand->bet;
-    hand->bet *=2;
-    print_message(msgWin, "Doubling bet.");
+    ui->message("Doubling bet.");
     return TRUE;
 }
 
@@ -669,147 +892,122 @@ bool double_down(Player *player, Hand *hand, WINDOW* msgWin)
  *  Summary: Compare player and dealer hands
  *
  *  Description: Compare the player and dealer hands and pay out or collect bets as required.
- *      Compare player hand to dealer hand to determine either player won or lost.
- *      Dealer blackjack overrides comparisions and is automatic loss for player.
- *      Player insurance pays only if dealer blackjack has occured.
+ *      Every hand at the table is gathered into the table's SeatBatch and settled in one pass.
+ *      Dealer blackjack overrides comparisions and is automatic loss for player, other than a player
+ *      blackjack which pushes. Insurance was already settled at the peek by check_dealer_hand.
  *
  *  Parameter(s):
  *      table: pointer to Table struct
  *      dealerBlackjack: boolean if dealer has blackjack
  *
  *  Returns:
- *      N/A
+ *      bool: TRUE if every player is out of money
  */
-bool check_table(Table table, bool dealerBlackjack)
+bool check_table(Table *table, bool dealerBlackjack)
 {
-    bool playerWon;
     uint8_t playerCount;
+    uint8_t playersLeft = table->numPlayers;
     char msg[80];
     zinfo("Get dealer count.");
-    uint8_t dealerCount = blackjack_count(table.dealer->hand);
+    uint8_t dealerCount = blackjack_count(table->dealer->hand);
     snprintf(msg, sizeof(msg), "Dealer has %u.", dealerCount);
-    print_message(table.msgWin, msg);
+    table->ui->message(msg);
     zinfo("Dealer has %u. Checking players hands now.", dealerCount);
-    
-    for (uint8_t player = 0; player < table.numPlayers; player++)
+
+    SeatBatch *batch = table->batch;
+    seat_batch_clear(batch);
+    for (uint8_t player = 0; player < table->numPlayers; player++)
     {
-        Hand *currentHand = &table.players[player].hand;
+        Hand *currentHand = &table->players[player].hand;
         while (currentHand != NULL)
         {
-            // determine if player has won or not
-            playerWon = FALSE;
             if (dealerBlackjack == FALSE)   // check players hand only if dealer doesn't have blackjack
             {
                 playerCount = blackjack_count(*currentHand);
-                snprintf(msg, sizeof(msg), "%s has %u.", table.players[player].name, playerCount);
-                print_message(table.msgWin, msg);
+                snprintf(msg, sizeof(msg), "%s has %u.", table->players[player].name, playerCount);
+                table->ui->message(msg);
                 zinfo("Dealer doesn't have blackjack. Player has %u.", playerCount);
-                if (playerCount <= 21)      // make sure player hasn't gone over 21
+                if (playerCount > 21)
                 {
-                    zinfo("Player hasn't busted. Comparing against dealer.");
-                    if (dealerCount > 21 || playerCount >= dealerCount)
-                    {
-                        zinfo("Player won. Setting flag to TRUE.");
-                        playerWon = TRUE;   // player has won only if dealer busted or we have higher count
-                                            // also TRUE if playerCount equals dealerCount which is a tie
-                    }
-                }
-                else
-                {
-                    snprintf(msg, sizeof(msg), "%s has busted.", table.players[player].name);
-                    print_message(table.msgWin, msg);
+                    snprintf(msg, sizeof(msg), "%s has busted.", table->players[player].name);
+                    table->ui->message(msg);
                 }
             }
-
-            // handle pay out or collection
-            if (playerWon == TRUE)
+            if (!seat_batch_add(batch, player, currentHand))
             {
-                uint32_t moneyWon = 0;
-                if  (playerCount == dealerCount)
-                {
-                    snprintf(msg, sizeof(msg), "%s tied with dealer. Get your bet of %u back.",
-                             table.players[player].name, currentHand->bet);
-                    print_message(table.msgWin, msg);
-                    zinfo("Player tied with dealer.");
-                    table.players[player].money += currentHand->bet;
-                }
-                else
-                {
-                    if (playerCount == 21 && (currentHand->cards->nextCard->nextCard == NULL)) // it's blackjack
-                    {
-                        moneyWon = currentHand->bet * 2.5;
-                        snprintf(msg, sizeof(msg), "%s has blackjack! You win %u.", table.players[player].name, moneyWon);
-                        print_message(table.msgWin, msg);
-                        zinfo("Player has blackjack. Get half bet added: %u.", moneyWon);
-                        table.players[player].money += moneyWon;
-                    }
-                    else
-                    {
-                        moneyWon = currentHand->bet * 2;
-                        snprintf(msg, sizeof(msg), "%s wins %u.", table.players[player].name, moneyWon);
-                        print_message(table.msgWin, msg);
-                        zinfo("Player won. Get twice bet back: %u.", moneyWon);
-                        table.players[player].money += moneyWon;
-                    }
-                }
+                // the batch can't take it, so settle this hand on its own rather than lose the bet
+                uint32_t moneyWon;
+                HandResult result = settle_hand(currentHand, dealerCount, dealerBlackjack, table->rules,
+                                                &table->players[player].money, &moneyWon);
+                report_result(table, &table->players[player], result, moneyWon);
             }
-            // TODO: handle insurance bets here
 
             currentHand = currentHand->nextHand;
         }
-//        // reset bet amount here
-//        zinfo("Reset players bet back to zero.");
-//        table.players[player].hand.bet = 0;
-        
-        if (table.players[player].money == 0)
+    }
+
+    // handle pay out or collection; the money is kept in the Player structs so it is credited here
+    settle_batch(batch, dealerCount, dealerBlackjack, table->rules);
+    for (uint32_t hand = 0; hand < batch->count; hand++)
+    {
+        Player *currentPlayer = &table->players[batch->seat[hand]];
+        currentPlayer->money += batch->payout[hand];
+        report_result(table, currentPlayer, batch->result[hand], batch->payout[hand]);
+    }
+
+    for (uint8_t player = 0; player < table->numPlayers; player++)
+    {
+        bankroll_update(table->bankroll, table->players[player].name, table->players[player].money);
+        if (table->players[player].money == 0)
         {
-            table.numPlayers--;
+            playersLeft--;
         }
     }
 
-    return (table.numPlayers == 0);
+    return (playersLeft == 0);
 }
 
 /***************
- *  Summary: Clear the hand of cards
- *
- *  Description: Clear the hand of cards, setting to NULL or freeing as needed.
+ *  Summary: Tell the table how a settled hand came out
  *
  *  Parameter(s):
- *      hand: Hand struct of the hand to clear
+ *      table: pointer to Table struct
+ *      player: the Player the hand belongs to
+ *      result: the HandResult from settling the hand
+ *      moneyWon: the amount paid back to the player
  *
  *  Returns:
  *      N/A
  */
-void clear_hands(Hand *hand)
+void report_result(Table *table, Player *player, HandResult result, uint32_t moneyWon)
 {
-    Hand *currHand = hand;
-    Hand *tempHand = NULL;
-    
-    while (currHand != NULL)
+    char msg[80];
+    switch (result)
     {
-        CardList *currCard = currHand->cards;
-        CardList *tempCard = NULL;
-        
-        while (currCard != NULL)
-        {
-            tempCard = currCard->nextCard;
-            free(currCard);
-            currCard = tempCard;
-        }
-        
-        currHand->cards = NULL;
-        tempHand = currHand->nextHand;
-        if (currHand != hand)
-        {
-            free(currHand);
-        }
-        currHand = tempHand;
+        case HAND_PUSH:
+            snprintf(msg, sizeof(msg), "%s tied with dealer. Get your bet of %u back.", player->name, moneyWon);
+            table->ui->message(msg);
+            zinfo("Player tied with dealer.");
+            break;
+        case HAND_BLACKJACK:
+            snprintf(msg, sizeof(msg), "%s has blackjack! You win %u.", player->name, moneyWon);
+            table->ui->message(msg);
+            zinfo("Player has blackjack. Get the payout added: %u.", moneyWon);
+            break;
+        case HAND_SURRENDERED:
+            snprintf(msg, sizeof(msg), "%s surrendered. Get %u back.", player->name, moneyWon);
+            table->ui->message(msg);
+            zinfo("Player surrendered. Get half bet back: %u.", moneyWon);
+            break;
+        case HAND_WON:
+            snprintf(msg, sizeof(msg), "%s wins %u.", player->name, moneyWon);
+            table->ui->message(msg);
+            zinfo("Player won. Get twice bet back: %u.", moneyWon);
+            break;
+        case HAND_LOST:
+            break;
     }
-    
-    hand->bet = 0;
-    hand->nextHand = NULL;
-    
+
     return;
 }
 
@@ -817,73 +1015,51 @@ void clear_hands(Hand *hand)
  *  Summary: Offer insurance bets to the players
  *
  *  Description: Ask each player in turn if they'd like the insurance bet when the dealer is showing an Ace for an
- *      upcard. Deducts the bet from each player if they have enough money otherwise we move on.
+ *      upcard. Deducts the bet from each player if they have enough money otherwise we move on. A player with
+ *      blackjack is offered even money instead. With a strategy plugin the plugin decides.
  *
  *  Parameter(s):
- *      N/A
+ *      table: pointer to Table struct
  *
  *  Returns:
  *      N/A
  */
-void offer_insurance()
+void offer_insurance(Table *table)
 {
-    return;
-}
+    char msg[80];
 
-/***************
- *  Summary: Split a hand of two cards of same value into two hands
- *
- *  Description: Splits a hand of two cards into two hands. There must be two cards only of the same value, and the
- *      player must have enough money to replicate the bet of the hand being split. (The new hand will have the same bet
- *      as the hand being split.)
- *
- *  Parameter(s):
- *      hand - Hand struct to be split
- *
- *  Returns:
- *      N/A
- */
-bool split_hand(Hand *handToSplit, uint32_t *bank, Deck *shoe)
-{
-    // check if we have one card in the hand
-    if (handToSplit->cards->nextCard == NULL)
-    {
-        zerror("Hand to be split only has one card.");
-        return FALSE;
-    }
-    
-    // check if we have more than two cards in the hand
-    if(handToSplit->cards->nextCard->nextCard != NULL)
-    {
-        zerror("Hand has more than two cards.");
-        return FALSE;
-    }
-    
-    // we have only two cards so make sure they're the same value
-    if (handToSplit->cards->card->value == handToSplit->cards->nextCard->card->value)
+    for (uint8_t player = 0; player < table->numPlayers; player++)
     {
-        // cards have same value, do we have enough money to cover the additional bet
-        if (handToSplit->bet < *bank)
+        Player *currentPlayer = &table->players[player];
+        Hand *hand = &currentPlayer->hand;
+        if (!can_insure(hand, &table->dealer->hand, currentPlayer->money)) continue;
+
+        bool blackjack = is_blackjack(hand);
+        bool insure;
+        if (table->strategy)
         {
-            Hand *newHand = calloc(1, sizeof(Hand));
-            newHand->cards = handToSplit->cards->nextCard;
-            newHand->cards->nextCard = NULL;
-            newHand->bet = handToSplit->bet;
-            newHand->nextHand = handToSplit->nextHand;
-            handToSplit->cards->nextCard = NULL;
-            handToSplit->nextHand = newHand;
-            deal_card(shoe, handToSplit);
-            deal_card(shoe, newHand);
-            *bank -= handToSplit->bet;
-            return TRUE;
+            insure = strategy_insure(table->strategy, hand, &table->dealer->hand, table->shoe, currentPlayer->money,
+                    table->rules);
         }
         else
         {
-            zinfo("Not enough money to split cards.");
-            return FALSE;
+            if (blackjack) snprintf(msg, sizeof(msg), "%s, take even money?", currentPlayer->name);
+            else snprintf(msg, sizeof(msg), "%s, insure for %u?", currentPlayer->name, hand->bet / 2);
+            insure = table->ui->yes_no(msg);
         }
+        if (!insure) continue;
+
+        if (take_insurance(hand, &currentPlayer->money))
+        {
+            snprintf(msg, sizeof(msg), "%s takes even money.", currentPlayer->name);
+        }
+        else
+        {
+            snprintf(msg, sizeof(msg), "%s insures for %u.", currentPlayer->name, hand->insurance);
+        }
+        table->ui->message(msg);
+        table->ui->player(currentPlayer);
     }
-    
-    zinfo("Cards are not the same value!");
-    return FALSE;
-}
\ No newline at end of file
+
+    return;
+}
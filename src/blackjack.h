@@ -46,12 +46,15 @@
  * INCLUDES *
  ************/
 #include <stdint.h>
-#include <ncurses.h>
+#include <stdbool.h>
 #include "deck_of_cards.h"
+#include "engine.h"
 
 /***********
  * DEFINES *
  ***********/
+#define MAX_PLAYERS 5       // seats at the table
+
 typedef struct Player
 {
     char name[11];
@@ -72,15 +75,19 @@ typedef struct Table
     Player *players;
     Dealer *dealer;
     Deck *shoe;
-    WINDOW *msgWin;         // ncurses window to display messages in
+    const struct Renderer *ui;          // what shows the game and asks the players
+    const struct Strategy *strategy;    // plugin making bets and decisions, NULL to ask the players
+    const Rules *rules;     // house rules the table plays by
+    struct SeatBatch *batch;            // the round's hands, gathered to be settled together
+    struct Snapshot *snapshot;          // the snapshot the table was restored from, NULL for a new table
+    const char *checkpoint; // file to save the table to between rounds, NULL not to save it
+    struct BankrollStore *bankroll;     // players' money kept between games
+    struct ShoePrep *prep;  // shuffles the next shoe while this one is dealt, NULL to shuffle at the cut card
 } Table;
 
-typedef enum PlayerChoice
-{
-    STAND, HIT, DOUBLE, SPLIT
-} PlayerChoice;
-
-#define DEBUG 1 // set to 0 to get true random shuffle, etc.
+#ifndef DEBUG
+#define DEBUG 1 // set to 0 to get true random shuffle, etc. (the release build passes -DDEBUG=0)
+#endif
 
 /****************
  * DECLARATIONS *
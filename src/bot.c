@@ -0,0 +1,289 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  bot.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Play any number of tables over stdin and stdout using the line protocol in session.h. Every line in
+ *               either direction starts with the number of the table it belongs to, e.g. "3 BET 10" or "3 TURN ...".
+ *               A bot playing many tables answers the decisions of all of them in one write, and the replies to a
+ *               whole read are sent back in one write, so the cost of the pipe is shared across the tables.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "bot.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "session.h"
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+typedef struct Output
+{
+    char *data;
+    size_t len;
+    size_t cap;
+} Output;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static uint16_t feed_line(Output *output, Session **sessions, uint16_t tables, char *line, size_t len);
+static bool collect_output(Output *output, Session *session, uint16_t table);
+static bool reserve(Output *output, size_t needed);
+static bool write_all(int fd, const char *data, size_t len);
+
+/***************
+ *  Summary: Play tables of blackjack over stdin and stdout
+ *
+ *  Description: Opens the tables, then reads as much input as is available, plays every complete line and writes
+ *      all of the replies in one go. Runs until stdin is closed or every table has closed.
+ *
+ *  Parameter(s):
+ *      tables: the number of tables to open
+ *      rules: the house Rules every table plays by
+ *
+ *  Returns:
+ *      int: EXIT_SUCCESS or EXIT_FAILURE if a table couldn't be opened or the output couldn't be written
+ */
+int run_bot(uint16_t tables, const Rules *rules)
+{
+    int result = EXIT_FAILURE;
+    Output output = {0};
+    char *input = malloc(BOT_BUFFER_SIZE);
+    Session **sessions = calloc(tables, sizeof(Session *));
+    if (input == NULL || sessions == NULL)
+    {
+        zerror("Bot memory allocation failed.");
+        goto error;
+    }
+
+    for (uint16_t table = 0; table < tables; table++)
+    {
+        sessions[table] = session_new(rules);
+        if (sessions[table] == NULL) goto error;
+    }
+
+    size_t inputLen = 0;
+    uint16_t open = tables;
+    while (open > 0)
+    {
+        for (uint16_t table = 0; table < tables; table++)
+        {
+            if (sessions[table] != NULL && !collect_output(&output, sessions[table], table + 1))
+            {
+                goto error;
+            }
+        }
+        if (!write_all(STDOUT_FILENO, output.data, output.len)) goto error;
+        output.len = 0;
+
+        ssize_t bytes = read(STDIN_FILENO, input + inputLen, BOT_BUFFER_SIZE - inputLen);
+        if (bytes < 0 && errno == EINTR) continue;
+        if (bytes <= 0) break;
+        inputLen += bytes;
+
+        // play every complete line and keep the partial one for the next read
+        char *line = input;
+        char *end;
+        while ((end = memchr(line, '\n', inputLen - (line - input))) != NULL)
+        {
+            uint16_t table = feed_line(&output, sessions, tables, line, end - line + 1);
+            line = end + 1;
+            if (table > 0 && sessions[table - 1]->state == SESSION_CLOSED)
+            {
+                collect_output(&output, sessions[table - 1], table);
+                session_free(sessions[table - 1]);
+                sessions[table - 1] = NULL;
+                open--;
+            }
+        }
+        inputLen -= line - input;
+        if (inputLen == BOT_BUFFER_SIZE)
+        {
+            zerror("Bot input line too long.");
+            goto error;
+        }
+        memmove(input, line, inputLen);
+    }
+
+    if (write_all(STDOUT_FILENO, output.data, output.len)) result = EXIT_SUCCESS;
+
+error:
+    if (sessions != NULL)
+    {
+        for (uint16_t table = 0; table < tables; table++)
+        {
+            session_free(sessions[table]);
+        }
+    }
+    free(sessions);
+    free(input);
+    free(output.data);
+    return result;
+}
+
+/***************
+ *  Summary: Feed one input line to the table it names
+ *
+ *  Description: Lines naming a table that doesn't exist or has closed are answered with an error on table 0.
+ *
+ *  Parameter(s):
+ *      output: the Output buffer for the error reply
+ *      sessions: the open sessions
+ *      tables: the number of tables
+ *      line: the line, including the newline
+ *      len: the length of the line
+ *
+ *  Returns:
+ *      table: the table number the line was fed to or 0 if none
+ */
+static uint16_t feed_line(Output *output, Session **sessions, uint16_t tables, char *line, size_t len)
+{
+    static const char error[] = "0 ERR no such table\n";
+    char *command;
+    unsigned long table = strtoul(line, &command, 10);
+
+    if (command == line || table < 1 || table > tables || sessions[table - 1] == NULL)
+    {
+        if (reserve(output, output->len + sizeof(error) - 1))
+        {
+            memcpy(output->data + output->len, error, sizeof(error) - 1);
+            output->len += sizeof(error) - 1;
+        }
+        return 0;
+    }
+
+    while (*command == ' ') command++;
+    session_feed(sessions[table - 1], command, len - (command - line));
+    return table;
+}
+
+/***************
+ *  Summary: Move a session's replies to the output, prefixed with the table number
+ *
+ *  Parameter(s):
+ *      output: the Output buffer
+ *      session: the Session struct
+ *      table: the table number
+ *
+ *  Returns:
+ *      bool: false if the output buffer couldn't grow
+ */
+static bool collect_output(Output *output, Session *session, uint16_t table)
+{
+    char prefix[8];
+    int prefixLen = snprintf(prefix, sizeof(prefix), "%u ", table);
+    size_t lines = 0;
+
+    for (size_t ii = 0; ii < session->outLen; ii++)
+    {
+        if (session->out[ii] == '\n') lines++;
+    }
+
+    if (!reserve(output, output->len + session->outLen + lines * prefixLen)) return false;
+
+    const char *line = session->out;
+    const char *end = session->out + session->outLen;
+    while (line < end)
+    {
+        const char *eol = memchr(line, '\n', end - line);
+        size_t len = (eol ? eol + 1 : end) - line;
+        memcpy(output->data + output->len, prefix, prefixLen);
+        memcpy(output->data + output->len + prefixLen, line, len);
+        output->len += prefixLen + len;
+        line += len;
+    }
+    session_consume(session, session->outLen);
+
+    return true;
+}
+
+/***************
+ *  Summary: Make room in the output buffer
+ *
+ *  Parameter(s):
+ *      output: the Output buffer
+ *      needed: the total size needed
+ *
+ *  Returns:
+ *      bool: false if the buffer couldn't grow
+ */
+static bool reserve(Output *output, size_t needed)
+{
+    if (needed <= output->cap) return true;
+
+    size_t cap = output->cap ? output->cap : BOT_BUFFER_SIZE;
+    while (cap < needed) cap *= 2;
+    char *data = realloc(output->data, cap);
+    if (data == NULL)
+    {
+        zerror("Bot output buffer allocation failed.");
+        return false;
+    }
+    output->data = data;
+    output->cap = cap;
+
+    return true;
+}
+
+/***************
+ *  Summary: Write a whole buffer to a blocking fd
+ *
+ *  Parameter(s):
+ *      fd: file descriptor to write to
+ *      data: bytes to write
+ *      len: number of bytes
+ *
+ *  Returns:
+ *      bool: false if the write failed
+ */
+static bool write_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t bytes = write(fd, data, len);
+        if (bytes < 0)
+        {
+            if (errno == EINTR) continue;
+            zerror("Bot output write failed: %s", strerror(errno));
+            return false;
+        }
+        data += bytes;
+        len -= bytes;
+    }
+
+    return true;
+}
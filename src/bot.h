@@ -0,0 +1,53 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  bot.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Play sessions over stdin and stdout so external programs can play through a pipe.
+ */
+
+#ifndef BOT_H_
+#define BOT_H_
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+
+#include "rules.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define BOT_BUFFER_SIZE 65536
+
+/****************
+ * DECLARATIONS *
+ ****************/
+int run_bot(uint16_t tables, const Rules *rules);
+
+#endif /* BOT_H_ */
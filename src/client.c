@@ -0,0 +1,152 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  client.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Description: A small terminal client for the game server. Lines typed are sent to the server as is and the
+ *               server's replies are printed, with a reminder of the choices when a bet or decision is asked for.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "session.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/***********
+ * DEFINES *
+ ***********/
+#define DEFAULT_SOCKET "blackjack.sock"
+#define BUFFER_SIZE 4096
+
+/****************
+ * DECLARATIONS *
+ ****************/
+void print_replies(char *buffer, size_t *len);
+
+int main(int argc, char *argv[])
+{
+    const char *path = (argc > 1) ? argv[1] : DEFAULT_SOCKET;
+
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+    {
+        fprintf(stderr, "Couldn't connect to %s: %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    printf("Connected. Type SIT followed by up to %d names to start.\n", SESSION_MAX_SEATS);
+
+    char buffer[BUFFER_SIZE];
+    size_t len = 0;
+    struct pollfd fds[2] = {{.fd = STDIN_FILENO, .events = POLLIN}, {.fd = fd, .events = POLLIN}};
+
+    while (poll(fds, 2, -1) > 0)
+    {
+        if (fds[0].revents & (POLLIN | POLLHUP))
+        {
+            char input[SESSION_LINE_MAX];
+            ssize_t bytes = read(STDIN_FILENO, input, sizeof(input));
+            if (bytes <= 0)
+            {
+                // end of input, ask the server to close the session
+                if (write(fd, "QUIT\n", 5) < 0) break;
+                fds[0].fd = -1;
+            }
+            else if (write(fd, input, bytes) < 0)
+            {
+                break;
+            }
+        }
+
+        if (fds[1].revents & (POLLIN | POLLHUP))
+        {
+            ssize_t bytes = read(fd, buffer + len, sizeof(buffer) - len - 1);
+            if (bytes <= 0) break;
+            len += bytes;
+            print_replies(buffer, &len);
+        }
+    }
+
+    close(fd);
+    return EXIT_SUCCESS;
+}
+
+/***************
+ *  Summary: Print the complete lines received from the server
+ *
+ *  Description: Prints each complete line, adding a prompt after the lines asking for input. A partial line is moved
+ *      to the front of the buffer to be completed by the next read.
+ *
+ *  Parameter(s):
+ *      buffer: received bytes
+ *      len: number of bytes in buffer, updated to the length of the partial line left
+ *
+ *  Returns:
+ *      N/A
+ */
+void print_replies(char *buffer, size_t *len)
+{
+    char *line = buffer;
+    char *end;
+
+    buffer[*len] = '\0';
+    while ((end = strchr(line, '\n')) != NULL)
+    {
+        *end = '\0';
+        printf("%s\n", line);
+        if (!strncmp(line, "BET ", 4))
+        {
+            printf("  BET <amount> or Q to leave the table\n");
+        }
+        else if (!strncmp(line, "TURN ", 5))
+        {
+            printf("  [S]tand, [H]it, [D]ouble down or S[p]lit?\n");
+        }
+        else if (!strncmp(line, "INSURE ", 7))
+        {
+            printf("  Take insurance, or even money with a blackjack? Y or N\n");
+        }
+        line = end + 1;
+    }
+    fflush(stdout);
+
+    *len = strlen(line);
+    memmove(buffer, line, *len);
+
+    return;
+}
@@ -37,9 +37,47 @@
  ************/
 #include "curses_output.h"
 
+#include <ctype.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "layout.h"
+#include "phase_timer.h"
+
+/***********
+ * DEFINES *
+ ***********/
+static Layout *screen = NULL;                       // NULL until init_message_window lays the screen out
+static Player *seated = NULL;                       // the table's players, in seat order
+static uint8_t numSeated = 0;
+static Dealer *shownDealer = NULL;                  // what each pane shows, to draw it again after a resize
+static Player *shownPlayers[LAYOUT_MAX_SEATS];
+static int ioFile = -1;                             // the drawing thread's I/O accounting, to count curses' output
+static FrameStats frameStats;
+
 /****************
  * DECLARATIONS *
  ****************/
+static void redraw_screen(void);
+static void draw_dealer(Dealer *dealer);
+static void draw_player(uint8_t seat, Player *player);
+static uint8_t seat_of(Player *player);
+static uint64_t bytes_written(void);
+static void curses_open(void);
+static void curses_seat(Table *table);
+static void curses_message(const char *msg);
+static void curses_pause(void);
+static uint8_t curses_num_players(uint8_t max);
+static bool curses_name(uint8_t seat, char *name, int size);
+static bool curses_read_line(const char *prompt, char *line, int size);
+static PlayerChoice curses_choice(Player *player, bool surrender);
+static bool curses_yes_no(const char *question);
+
+const Renderer CURSES_RENDERER = {.name = "curses", .open = curses_open, .close = end_window, .seat = curses_seat,
+        .table = display_table, .dealer = display_dealer, .player = display_player, .message = curses_message,
+        .pause = curses_pause, .num_players = curses_num_players, .player_name = curses_name,
+        .read_line = curses_read_line, .choice = curses_choice, .yes_no = curses_yes_no};
 
 /***************
  *  Summary: Start ncurses
@@ -61,6 +99,13 @@ void init_window()
 
     keypad(stdscr, TRUE);
 
+    // curses writes straight to the terminal, so its output is counted from the kernel's tally for this thread
+    ioFile = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+    if (ioFile < 0)
+    {
+        zinfo("Can't read /proc/thread-self/io, frames won't be measured in bytes.");
+    }
+
     return;
 }
 
@@ -82,8 +127,15 @@ void end_window()
     getmaxyx(stdscr, lines, columns);
     mvwaddstr(stdscr, lines - 2, (columns - 35) / 2, "(Game over. Press any key to exit.)");
     wgetch(stdscr);
+    layout_close();
+    screen = NULL;
     endwin();
 
+    zinfo("Drew %llu frames in %llu bytes, the largest %u bytes.", (unsigned long long) frameStats.frames,
+            (unsigned long long) frameStats.bytes, frameStats.maxBytes);
+    if (ioFile >= 0) close(ioFile);
+    ioFile = -1;
+
     return;
 }
 
@@ -122,13 +174,16 @@ void welcome_screen()
     mvwaddstr(welcome, 6, 1, "in your quest to earn more. Lose it");
     mvwaddstr(welcome, 7, 1, "all and your game is over. Good luck!");
     mvwaddstr(welcome, 18, 7, "(Press a key to continue.)");
-    wrefresh(welcome);
+    wnoutrefresh(welcome);
+    present_frame();
 
     // wait for a keypress before continuing and removing the window
     wgetch(welcome);
-    wclear(welcome);
-    wrefresh(welcome);
+    werase(welcome);
+    wnoutrefresh(welcome);
     delwin(welcome);
+    present_frame();
+    if (screen) redraw_screen();    // put back the panes it covered
 
     return;
 }
@@ -136,7 +191,8 @@ void welcome_screen()
 /***************
  *  Summary: Display the dealer's hand in its own window
  *
- *  Description: Print the dealer's name and hand in a bordered window on the screen
+ *  Description: Print the dealer's name and hand in the bordered dealer pane at the top of the screen. The pane is
+ *      kept between calls and only its own contents are drawn again.
  *
  *  Parameter(s):
  *      dealer: Dealer struct with the dealer's information
@@ -146,42 +202,22 @@ void welcome_screen()
  */
 void display_dealer(Dealer *dealer)
 {
+    PHASE_START(renderStart);
     zinfo("Displaying dealer.");
-    WINDOW *dealerWindow = newwin(PLAYER_WINDOW_LINE, PLAYER_WINDOW_COLS, 0, 0);    // TODO change to variable coordinates
-
-    // build the strings to be displayed
-    char *nameString = calloc(19, sizeof(char));
-    char *statString = calloc(19, sizeof(char));
-    char *handString = calloc(1, 50); // TODO: Calculate???? instead of magic number
+    refresh_layout();
+    shownDealer = dealer;
+    draw_dealer(dealer);
+    present_frame();
+    PHASE_END(PHASE_RENDER, renderStart);
 
-    if (!nameString || !handString || !statString)
-    {
-        zerror("Memory allocation for dealer name, stat string or hand string failed.");
-        goto error;
-    }
-    
-    snprintf(nameString, 9, " %s ", dealer->name);
-//    snprintf(statString, 19, "Count: %u", blackjack_count(dealer->hand));
-
-    hand_to_string(&dealer->hand, handString, dealer->faceup);
-
-    box(dealerWindow, 0, 0);
-    mvwaddstr(dealerWindow, 0, 6, nameString);
-    mvwaddstr(dealerWindow, 2, 1, handString);
-    wrefresh(dealerWindow);
-    delwin(dealerWindow);
-
-error:
-    free(statString);
-    free(nameString);
-    free(handString);
     return;
 }
 
 /***************
  *  Summary: Display the player's hand in its own window
  *
- *  Description: Print the player's name, money and hand in a bordered window on the screen
+ *  Description: Print the player's name, money and hand in the bordered pane for their seat. A player who isn't one
+ *      of the table's given to init_message_window goes in the first seat.
  *
  *  Parameter(s):
  *      player: Player struct with the player's information
@@ -191,56 +227,91 @@ error:
  */
 void display_player(Player *player)
 {
+    PHASE_START(renderStart);
     zinfo("Displaying player %s.", player->name);
-    WINDOW *playerWindow = newwin(PLAYER_WINDOW_LINE, PLAYER_WINDOW_COLS, 8, 0);    // TODO change to variable coordinates
-    // build the strings to be displayed
-    char *nameString = calloc(19, sizeof(char));
-    char *statString = calloc(19, sizeof(char));
-    char *handString = calloc(1, 50);
+    refresh_layout();
+    uint8_t seat = seat_of(player);
+    shownPlayers[seat] = player;
+    draw_player(seat, player);
+    present_frame();
+    PHASE_END(PHASE_RENDER, renderStart);
 
-    if (!nameString || !handString)
-    {
-        zerror("Memory allocation failed for player strings.");
-        goto error;
-    }
+    return;
+}
 
-    // Set up the strings
-    snprintf(nameString, 17, " %s ", player->name);
-    snprintf(statString, 19, "        $%'9u", player->money);
-    box(playerWindow, 0, 0);
-    mvwaddstr(playerWindow, 0, ((PLAYER_WINDOW_COLS / 2) - (strlen(nameString) / 2)), nameString);
-    mvwaddstr(playerWindow, 1, 1, statString);
-    
-//    CardList *printCard = player->hand.cards;
-//    if (printCard->card != NULL)
-//    {
-//        while (printCard != NULL)
-//        {
-//            strncat(handString, printCard->card->face, 6);
-//            strncat(handString, " ", 1);
-//            printCard = printCard->nextCard;
-//        }
-//    }
-    Hand *handToPrint = &player->hand;
-    uint8_t lineToPrint = 2;
-    while (handToPrint != NULL)
+/***************
+ *  Summary: Display the whole table
+ *
+ *  Description: Draws the dealer and each player still at the table, and blanks the panes of the seats that have
+ *      emptied. This replaces clearing the screen between rounds; nothing outside the panes is touched.
+ *
+ *  Parameter(s):
+ *      table: the Table to display
+ *
+ *  Returns:
+ *      N/A
+ */
+void display_table(Table *table)
+{
+    PHASE_START(renderStart);
+    refresh_layout();
+    shownDealer = table->dealer;
+    draw_dealer(table->dealer);
+    for (uint8_t seat = 0; seat < LAYOUT_MAX_SEATS; seat++)
     {
-        hand_to_string(handToPrint, handString, TRUE);
-        mvwaddstr(playerWindow, lineToPrint++, 1, handString);
-        handToPrint = handToPrint->nextHand;
-        strcpy(handString, "");
+        shownPlayers[seat] = (seat < table->numPlayers) ? &table->players[seat] : NULL;
+        draw_player(seat, shownPlayers[seat]);
     }
-    
-    wrefresh(playerWindow);
-    delwin(playerWindow);
+    present_frame();
+    PHASE_END(PHASE_RENDER, renderStart);
 
-error:
-    free(statString);
-    free(nameString);
-    free(handString);
     return;
 }
 
+/***************
+ *  Summary: Catch up with a terminal resize
+ *
+ *  Description: Lays the screen out again if the terminal has been resized since the last call and draws every pane
+ *      over a blank screen. Cheap when nothing has changed, so it's called before drawing and while waiting for keys.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      bool: TRUE if the screen was laid out again
+ */
+bool refresh_layout(void)
+{
+    if (!screen || !layout_resized()) return FALSE;
+
+    werase(stdscr);
+    wnoutrefresh(stdscr);
+    redraw_screen();
+
+    return TRUE;
+}
+
+/***************
+ *  Summary: Wait for a key
+ *
+ *  Description: Reads a key from stdscr, redrawing the screen for any resize while waiting.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      key: the key pressed
+ */
+int read_key(void)
+{
+    while (TRUE)
+    {
+        refresh_layout();
+        int key = wgetch(stdscr);
+        if (key != ERR && key != KEY_RESIZE) return key;
+    }
+}
+
 /***************
  *  Summary: Get a choice from the player on how to play their hand
  *
@@ -249,25 +320,27 @@ error:
  *
  *  Parameter(s):
  *      player: Player struct with the player's information
+ *      surrender: TRUE if the hand can be surrendered, which adds it to the choices offered
  *
  *  Returns:
  *      N/A
  */
-PlayerChoice get_player_choice(Player *player, WINDOW* msgWin)
+PlayerChoice get_player_choice(Player *player, WINDOW* msgWin, bool surrender)
 {
     bool choiceMade = FALSE;
     PlayerChoice choice;
     char input;
     char msg[80];
     
-    snprintf(msg, sizeof(msg), "%s: [S]tand, [H]it, [D]ouble down or S[p]lit? ", player->name);
+    snprintf(msg, sizeof(msg), "%s: [S]tand, [H]it, [D]ouble down, S[p]lit%s? ", player->name,
+            surrender ? " or s[U]rrender" : "");
     print_message(msgWin, msg);
     
     while (!choiceMade)
     {
         zinfo("Ask for players choice.");
         choiceMade = TRUE;
-        input = wgetch(stdscr);
+        input = read_key();
         switch(input)
         {
             case 's':
@@ -294,6 +367,17 @@ PlayerChoice get_player_choice(Player *player, WINDOW* msgWin)
                 print_message(msgWin, "Split\n");
                 zinfo("Player chose SPLIT.");
                 break;
+            case 'u':
+            case 'U':
+                if (!surrender)
+                {
+                    choiceMade = FALSE;
+                    break;
+                }
+                choice = SURRENDER;
+                print_message(msgWin, "Surrender\n");
+                zinfo("Player chose SURRENDER.");
+                break;
             default:
                 choiceMade = FALSE;
         }
@@ -302,42 +386,69 @@ PlayerChoice get_player_choice(Player *player, WINDOW* msgWin)
     return choice;
 }
 
+/***************
+ *  Summary: Ask the player a yes or no question
+ *
+ *  Parameter(s):
+ *      msgWin: the message window to ask in
+ *      question: the question, which gets " (y/n)" added
+ *
+ *  Returns:
+ *      bool: TRUE for yes, FALSE for no
+ */
+bool get_yes_no(WINDOW *msgWin, const char *question)
+{
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%s (y/n) ", question);
+    print_message(msgWin, msg);
+
+    while (TRUE)
+    {
+        switch (read_key())
+        {
+            case 'y':
+            case 'Y':
+                zinfo("Player answered yes to: %s", question);
+                return TRUE;
+            case 'n':
+            case 'N':
+                zinfo("Player answered no to: %s", question);
+                return FALSE;
+            default:
+                break;
+        }
+    }
+}
+
 /***************
  *  Summary: Instantiate the message window
  *
- *  Description: Create and return a WINDOW pointer to a curses window for use to print messages.
+ *  Description: Lays the screen out for the table and returns the message window along its bottom. The window belongs
+ *      to the layout, which moves and resizes it with the terminal, and is deleted by end_window.
  *
  *  Parameter(s):
- *      N/A
+ *      table: the Table whose players get the seats, or NULL for a single seat
  *
  *  Returns:
- *      N/A
+ *      msgWindow: the message window
  */
-WINDOW *init_message_window()
+WINDOW *init_message_window(Table *table)
 {
     zinfo("init_message_window() called.");
-    uint16_t columns, lines;        // width and height of the stdscr window
-    getmaxyx(stdscr, lines, columns);
-    
-    // set up dimensions of our window
-    uint16_t msgY = lines - ((lines < 30) ? 7 : 12);
-    uint16_t msgX = 2;
-    uint16_t msgLines = (lines < 30) ? 5 : 10;
-    uint16_t msgColumns = columns - 4;
-    
-    // create window to display messages in and window for the border
-    WINDOW *msgWindow = newwin(msgLines, msgColumns, msgY, msgX);
-    zinfo("msgWindow pointer: %p", msgWindow);
-    wmove(msgWindow, (lines - 1), 0);
-    
-    return msgWindow;
+    seated = table ? table->players : NULL;
+    numSeated = table ? table->numPlayers : 0;
+    screen = layout_open(numSeated ? numSeated : 1);
+    zinfo("msgWindow pointer: %p", screen->message.win);
+
+    return screen->message.win;
 }
 
 /***************
  *  Summary: Display a message to the screen in a special window
  *
  *  Description: Display a message to the screen in a dedicated window with a border around it. The lines scroll from
- *      the bottom to the top with the message passed in printed at the bottom.
+ *      the bottom to the top with the message passed in printed at the bottom. The border is only drawn the first
+ *      time after the screen is laid out.
  *
  *  Parameter(s):
  *      msgWindow:  WINDOW pointer to the curses window the message gets printed to
@@ -346,49 +457,271 @@ WINDOW *init_message_window()
  *  Returns:
  *      N/A
  */
-void print_message(WINDOW *msgWindow, char *msg)
+void print_message(WINDOW *msgWindow, const char *msg)
 {
-    uint16_t maxY, maxX, begY, begX;
-    getbegyx(msgWindow, begY, begX);
-    getmaxyx(msgWindow, maxY, maxX);
-    
+    PHASE_START(renderStart);
+    uint16_t maxY = getmaxy(msgWindow);
+
     // draw a border around the message window
-    WINDOW *boxwin = newwin(maxY + 4, maxX + 4, begY - 2, begX - 2);
-    box(boxwin, 0, 0);
-    wrefresh(boxwin);
-    delwin(boxwin);
-    
+    if (screen && !screen->borderDrawn)
+    {
+        if (screen->border.win)
+        {
+            werase(screen->border.win);
+            box(screen->border.win, 0, 0);
+            wnoutrefresh(screen->border.win);
+        }
+        screen->borderDrawn = TRUE;
+        touchwin(msgWindow);    // the border's blank middle went over the messages
+    }
+
     // delete the topmost line moving the other lines up and move the cursor to the bottom line
-    touchwin(msgWindow);
-    wmove(msgWindow, 0, 0);
-    wdeleteln(msgWindow);
-    wmove(msgWindow, (maxY - 1), 0);
-    waddstr(msgWindow, msg);
-    wrefresh(msgWindow);
+    if (*msg)
+    {
+        wmove(msgWindow, 0, 0);
+        wdeleteln(msgWindow);
+        wmove(msgWindow, (maxY - 1), 0);
+        waddstr(msgWindow, msg);
+    }
+    wnoutrefresh(msgWindow);
+    present_frame();
+    PHASE_END(PHASE_RENDER, renderStart);
+
+    return;
+}
+
+/***************
+ *  Summary: Put the frame on the screen
+ *
+ *  Description: The panes are drawn with wnoutrefresh, which only copies them into curses' picture of the next
+ *      screen; this sends the difference between that and what the terminal already shows, in one go. The bytes it
+ *      took are logged and added to the frame stats.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void present_frame(void)
+{
+    uint64_t before = bytes_written();
+    doupdate();
+    uint32_t bytes = (uint32_t) (bytes_written() - before);
+
+    frameStats.frames++;
+    frameStats.bytes += bytes;
+    frameStats.lastBytes = bytes;
+    if (bytes > frameStats.maxBytes) frameStats.maxBytes = bytes;
+    zdebug("Frame %llu: %u bytes.", (unsigned long long) frameStats.frames, bytes);
 
     return;
 }
 
-void hand_to_string(Hand *hand, char *handString, bool showCard)
+/***************
+ *  Summary: Get the counts of the frames drawn so far
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      FrameStats: the frames and the bytes they took; the bytes stay 0 if they can't be counted
+ */
+FrameStats frame_stats(void)
+{
+    return frameStats;
+}
+
+static void redraw_screen(void)
 {
-    if (hand->cards != NULL)
+    if (shownDealer) draw_dealer(shownDealer);
+    for (uint8_t seat = 0; seat < LAYOUT_MAX_SEATS; seat++)
     {
-    CardList *printCard = hand->cards;
-    if (printCard->card != NULL)
+        draw_player(seat, shownPlayers[seat]);
+    }
+    screen->borderDrawn = FALSE;
+    print_message(screen->message.win, "");     // the border, and the messages kept in the window
+    present_frame();
+
+    return;
+}
+
+static void draw_dealer(Dealer *dealer)
+{
+    WINDOW *dealerWindow = screen ? screen->dealer.win : NULL;
+    if (!dealerWindow) return;
+
+    char nameString[19];
+    char handString[HAND_STRING_SIZE];
+
+    snprintf(nameString, 9, " %s ", dealer->name);
+    hand_to_string(&dealer->hand, handString, sizeof(handString), dealer->faceup);
+
+    werase(dealerWindow);
+    box(dealerWindow, 0, 0);
+    mvwaddstr(dealerWindow, 0, 6, nameString);
+    mvwaddstr(dealerWindow, 2, 1, handString);
+    wnoutrefresh(dealerWindow);
+
+    return;
+}
+
+static void draw_player(uint8_t seat, Player *player)
+{
+    WINDOW *playerWindow = screen ? screen->seats[seat].win : NULL;
+    if (!playerWindow) return;
+
+    werase(playerWindow);
+    if (player)
     {
-        if(showCard == FALSE)
+        char nameString[19];
+        char statString[19];
+        char handString[HAND_STRING_SIZE];
+
+        snprintf(nameString, 17, " %s ", player->name);
+        snprintf(statString, 19, "        $%'9u", player->money);
+        box(playerWindow, 0, 0);
+        mvwaddstr(playerWindow, 0, ((PLAYER_WINDOW_COLS / 2) - (strlen(nameString) / 2)), nameString);
+        mvwaddstr(playerWindow, 1, 1, statString);
+
+        Hand *handToPrint = &player->hand;
+        uint8_t lineToPrint = 2;
+        while (handToPrint != NULL)
         {
-            strcat(handString, "XXX ");
-            printCard = printCard->nextCard;
+            hand_to_string(handToPrint, handString, sizeof(handString), TRUE);
+            mvwaddstr(playerWindow, lineToPrint++, 1, handString);
+            handToPrint = handToPrint->nextHand;
         }
-        
-        while (printCard != NULL)
+    }
+    wnoutrefresh(playerWindow);
+
+    return;
+}
+
+static uint8_t seat_of(Player *player)
+{
+    if (seated && player >= seated && player < seated + numSeated && player - seated < LAYOUT_MAX_SEATS)
+    {
+        return (uint8_t) (player - seated);
+    }
+
+    return 0;
+}
+
+static uint64_t bytes_written(void)
+{
+    char io[512];
+
+    if (ioFile < 0) return 0;
+    ssize_t got = pread(ioFile, io, sizeof(io) - 1, 0);
+    if (got <= 0) return 0;
+    io[got] = '\0';
+
+    char *wchar = strstr(io, "wchar:");
+    return wchar ? strtoull(wchar + strlen("wchar:"), NULL, 10) : 0;
+}
+
+static void curses_open(void)
+{
+    init_window();
+    welcome_screen();
+
+    return;
+}
+
+static void curses_seat(Table *table)
+{
+    werase(stdscr);     // the questions asked before the table was set
+    wnoutrefresh(stdscr);
+    init_message_window(table);
+
+    return;
+}
+
+static void curses_message(const char *msg)
+{
+    if (screen) print_message(screen->message.win, msg);
+
+    return;
+}
+
+static void curses_pause(void)
+{
+    struct timespec sleep = {.tv_nsec = 500000000, .tv_sec = 0};
+    struct timespec remain;
+    nanosleep(&sleep, &remain);
+
+    return;
+}
+
+static uint8_t curses_num_players(uint8_t max)
+{
+    uint8_t numOfPlayers = 0;
+    int input;
+
+    curs_set(CURS_NORMAL);
+    mvwprintw(stdscr, 0, 0, "How many people are playing? (1-%u or q to quit.) ", max);
+
+    // only a number of players or 'q' (for quitting the game) is taken, all other keypresses are ignored
+    while (TRUE)
+    {
+        input = read_key();
+        if (tolower(input) == 'q') break;
+        if (input >= '1' && input <= '0' + max)
         {
-            strncat(handString, printCard->card->face, 6);
-            strncat(handString, " ", 1);
-            printCard = printCard->nextCard;
+            numOfPlayers = input - '0';
+            break;
         }
     }
+
+    waddch(stdscr, input);
+    curs_set(CURS_INVIS);
+
+    return numOfPlayers;
+}
+
+static bool curses_name(uint8_t seat, char *name, int size)
+{
+    curs_set(CURS_NORMAL);
+    if (seat == 0) mvwprintw(stdscr, 2, 0, "Player names are limited to %d characters max.", size - 1);
+    echo();
+    int read;
+    do
+    {
+        mvwprintw(stdscr, 3 + seat, 0, "What is player %i's name? ", seat + 1);
+        wclrtoeol(stdscr);
+        read = wgetnstr(stdscr, name, size - 1);
+    } while (read == KEY_RESIZE);
+    noecho();
+    curs_set(CURS_INVIS);
+
+    return (read != ERR && read != KEY_RESIZE && name[0] != '\0');
+}
+
+static bool curses_read_line(const char *prompt, char *line, int size)
+{
+    line[0] = '\0';
+    if (!screen) return FALSE;
+
+    print_message(screen->message.win, prompt);
+    echo();
+    int read = wgetnstr(screen->message.win, line, size - 1);
+    noecho();
+    if (read == ERR || read == KEY_RESIZE)    // a resize interrupts the read; the question is asked again
+    {
+        line[0] = '\0';
+        refresh_layout();
     }
-    return;
-}
\ No newline at end of file
+
+    return TRUE;
+}
+
+static PlayerChoice curses_choice(Player *player, bool surrender)
+{
+    return get_player_choice(player, screen->message.win, surrender);
+}
+
+static bool curses_yes_no(const char *question)
+{
+    return get_yes_no(screen->message.win, question);
+}
@@ -37,6 +37,10 @@
 
 #define NCURSES_WIDECHAR 1
 
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
 /************
  * INCLUDES *
  ************/
@@ -44,6 +48,7 @@
 #include <stdlib.h>
 
 #include "blackjack.h"
+#include "renderer.h"
 #include "unicode_box_chars.h"
 #include "logger.h"
 
@@ -55,6 +60,16 @@
 
 enum cursorMode {CURS_INVIS, CURS_NORMAL, CURS_VVIS};
 
+typedef struct FrameStats
+{
+    uint64_t frames;        // times the screen was brought up to date
+    uint64_t bytes;         // written to the terminal doing it
+    uint32_t lastBytes;
+    uint32_t maxBytes;
+} FrameStats;
+
+extern const Renderer CURSES_RENDERER;
+
 /****************
  * DECLARATIONS *
  ****************/
@@ -63,9 +78,14 @@ void end_window();
 void welcome_screen();
 void display_dealer(Dealer *dealer);
 void display_player(Player *player);
-PlayerChoice get_player_choice(Player *player, WINDOW *msgWin);
-WINDOW *init_message_window();
-void print_message(WINDOW *msgWindow, char *msg);
-void hand_to_string(Hand *hand, char *handString, bool showCard);
+void display_table(Table *table);
+bool refresh_layout(void);
+int read_key(void);
+void present_frame(void);
+FrameStats frame_stats(void);
+PlayerChoice get_player_choice(Player *player, WINDOW *msgWin, bool surrender);
+bool get_yes_no(WINDOW *msgWin, const char *question);
+WINDOW *init_message_window(Table *table);
+void print_message(WINDOW *msgWindow, const char *msg);
 
 #endif /* CURSES_OUTPUT_H_ */
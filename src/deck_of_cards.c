@@ -45,6 +45,13 @@
 /****************
  * DECLARATIONS *
  ****************/
+// random() state, two buffers so a saved state can be switched to without setstate overwriting it
+static int32_t randomStates[2][RANDOM_STATE_SIZE / sizeof(int32_t)];
+static uint8_t activeState = 0;
+static bool seeded = false;
+
+static void reset_remaining(Deck *shoe);
+static Card *draw_counted(Deck *shoe);
 
 /***************
  *  Summary: Instantiate one or more decks of cards
@@ -71,32 +78,127 @@ Deck *init_deck(uint8_t decks)
         zerror("Deck memory allocation failed.");
         return NULL;
     }
+    fill_cards(deck->shoe, cards);
     
-    char *ranks[13] = {" A", " 2", " 3", " 4", " 5", " 6", " 7", " 8", " 9", "10", " J", " Q", " K"};
-    char *suits[4] =  {SPADE, CLUB, HEART, DIAMOND};
-    uint8_t values[13] = {11, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10};
+    deck->kind = SHOE_ORDERED;
+    deck->cards = cards;
+    deck->deal = 0;
+    reset_remaining(deck);
     
-    for (uint16_t card = 0; card < cards; card++)
+    return deck;
+}
+
+/***************
+ *  Summary: Instantiate a shoe that only counts the cards left
+ *
+ *  Description: Keeps the number of cards of each value left instead of the cards themselves, with a single deck of
+ *      cards for the dealt cards to point at. The memory used doesn't depend on the number of decks and shuffling
+ *      only resets the counts, which suits analyses that don't care about the order of the cards. With
+ *      INFINITE_DECKS the counts never go down, as if drawing from an endless shoe, and the shoe never needs
+ *      shuffling.
+ *
+ *  Parameter(s):
+ *      decks: the number of decks in the shoe, 1 to MAX_COUNTED_DECKS, or INFINITE_DECKS
+ *
+ *  Returns:
+ *      deck: pointer to the Deck struct or NULL if an error
+ */
+Deck *init_counted_deck(uint16_t decks)
+{
+    if (decks > MAX_COUNTED_DECKS)
     {
-        uint16_t cc = card % CARDS_IN_DECK;
-        strncpy(deck->shoe[card].rank, ranks[cc % 13], 3);
-        strncpy(deck->shoe[card].suit, suits[cc / 13], 4);
-        strncpy(deck->shoe[card].face, ranks[cc % 13], 3);
-        strncat(deck->shoe[card].face, suits[cc / 13], 4);
-        deck->shoe[card].value = values[cc % 13];
+        zerror("Counted shoe can hold at most %d decks, not %u.", MAX_COUNTED_DECKS, decks);
+        return NULL;
     }
-    
-    deck->cards = cards;
+
+    Deck *deck = calloc(1, sizeof(Deck));
+    if (deck == NULL || (deck->shoe = calloc(CARDS_IN_DECK, sizeof(Card))) == NULL)
+    {
+        zerror("Deck memory allocation failed.");
+        free(deck);
+        return NULL;
+    }
+    fill_cards(deck->shoe, CARDS_IN_DECK);
+
+    // an infinite shoe keeps the proportions of a single deck
+    deck->kind = (decks == INFINITE_DECKS) ? SHOE_INFINITE : SHOE_COUNTED;
+    deck->cards = (decks == INFINITE_DECKS) ? CARDS_IN_DECK : decks * CARDS_IN_DECK;
     deck->deal = 0;
-    
+    reset_remaining(deck);
+
     return deck;
 }
 
+/***************
+ *  Summary: Seed the random number generator used for shuffling and drawing
+ *
+ *  Description: Like srandom, but the state is kept in a buffer of our own so it can be saved and restored.
+ *
+ *  Parameter(s):
+ *      seed: the seed
+ *
+ *  Returns:
+ *      N/A
+ */
+void seed_random(unsigned int seed)
+{
+    initstate(seed, (char *) randomStates[activeState], RANDOM_STATE_SIZE);
+    seeded = true;
+
+    return;
+}
+
+/***************
+ *  Summary: Save the state of the random number generator
+ *
+ *  Description: Switching to the state that is already in use makes random() write its position into the state
+ *      buffer, so the copy is complete.
+ *
+ *  Parameter(s):
+ *      state: buffer of RANDOM_STATE_SIZE bytes for the state
+ *
+ *  Returns:
+ *      bool: false if the generator wasn't seeded with seed_random and there is no state to save
+ */
+bool save_random(char *state)
+{
+    if (!seeded)
+    {
+        zerror("Random state can't be saved without seed_random.");
+        return false;
+    }
+
+    setstate((char *) randomStates[activeState]);
+    memcpy(state, randomStates[activeState], RANDOM_STATE_SIZE);
+
+    return true;
+}
+
+/***************
+ *  Summary: Restore a state saved by save_random
+ *
+ *  Parameter(s):
+ *      state: the saved state
+ *
+ *  Returns:
+ *      N/A
+ */
+void restore_random(const char *state)
+{
+    uint8_t next = activeState ^ 1;
+    memcpy(randomStates[next], state, RANDOM_STATE_SIZE);
+    setstate((char *) randomStates[next]);
+    activeState = next;
+    seeded = true;
+
+    return;
+}
+
 /***************
  *  Summary: Shuffle a shoe of cards
  *
  *  Description: Using the Fisher-Yates algorithm, shuffle a shoe of cards consisting of one or
- *      more decks of cards.
+ *      more decks of cards. A counted shoe has no order, so it just gets all of its cards back.
  *
  *  Parameter(s):
  *      shoe: pointer to a shoe of cards
@@ -109,9 +211,18 @@ void shuffle_cards(Deck *shoe)
     Card shoe_tmp;
     uint16_t swap;
 
+    if (shoe->kind != SHOE_ORDERED)
+    {
+        shoe->deal = 0;
+        reset_remaining(shoe);
+        return;
+    }
+
+    // the swap can be the card itself; leaving it out (random() % card) would be Sattolo's algorithm, which only
+    // makes the single cycle permutations and never leaves a card where it was
     for (int card = shoe->cards - 1; card > 0; card--)
     {
-        swap = random() % card;
+        swap = random() % (card + 1);
 
         shoe_tmp = shoe->shoe[swap];
         shoe->shoe[swap] = shoe->shoe[card];
@@ -119,27 +230,125 @@ void shuffle_cards(Deck *shoe)
     }
 
     shoe->deal = 0; // Set the card to be dealt to the first card
+    reset_remaining(shoe);
 
     return;
 }
 
+/***************
+ *  Summary: Shuffle the discard tray back into the shoe
+ *
+ *  Description: The dealt cards sit at the front of an ordered shoe, so between rounds shoe[0] to shoe[deal - 1] is
+ *      the discard tray. The cards still to be dealt are already in random order, so each discarded card only needs to
+ *      swap with a random card among itself and those after it, the last steps of Fisher-Yates, to leave the whole
+ *      shoe as random as shuffle_cards would. This touches the discarded cards alone, which makes it cheap enough to
+ *      run after every round, the way a continuous shuffling machine does. A counted shoe just gets its cards back.
+ *      No hand may be holding a card.
+ *
+ *  Parameter(s):
+ *      shoe: pointer to a shoe of cards
+ *
+ *  Returns:
+ *      N/A
+ */
+void shuffle_discards(Deck *shoe)
+{
+    Card shoe_tmp;
+    uint16_t swap;
+
+    if (shoe->kind != SHOE_ORDERED)
+    {
+        shuffle_cards(shoe);
+        return;
+    }
+
+    for (int card = shoe->deal - 1; card >= 0; card--)
+    {
+        shoe->remaining[VALUE_INDEX(shoe->shoe[card].value)]++;
+        swap = card + random() % (shoe->cards - card);
+
+        shoe_tmp = shoe->shoe[swap];
+        shoe->shoe[swap] = shoe->shoe[card];
+        shoe->shoe[card] = shoe_tmp;
+    }
+
+    shoe->deal = 0;
+
+    return;
+}
+
+/***************
+ *  Summary: Put a shuffled set of cards in the shoe
+ *
+ *  Description: The alternative to shuffle_cards when the next shoe was shuffled ahead of time: the shoe switches to
+ *      the new cards and starts dealing from the first one. No hand may be holding a card from the old ones.
+ *
+ *  Parameter(s):
+ *      shoe: pointer to an ordered shoe of cards
+ *      cards: the shuffled cards, as many as the shoe holds
+ *
+ *  Returns:
+ *      cards: the shoe's old cards, for the caller to reuse or free
+ */
+Card *replace_cards(Deck *shoe, Card *cards)
+{
+    Card *oldCards = shoe->shoe;
+
+    shoe->shoe = cards;
+    shoe->deal = 0;
+    reset_remaining(shoe);
+
+    return oldCards;
+}
+
+/***************
+ *  Summary: Check the shoe has cards left to deal
+ *
+ *  Parameter(s):
+ *      shoe: a Deck struct
+ *      cards: the number of cards wanted
+ *
+ *  Returns:
+ *      bool: true if an ordered shoe has that many cards left; a counted shoe always has
+ */
+bool can_deal(const Deck *shoe, uint16_t cards)
+{
+    return (shoe->kind != SHOE_ORDERED || shoe->cards - shoe->deal >= cards);
+}
+
 /***************
  *  Summary: Deal a card from the shoe
  *
  *  Description: Using the supplied shoe Deck struct, add the next card to be dealt onto the end of the hand Hand struct
- *      linked list. Also increments the shoe.deal counter.
+ *      linked list. Also increments the shoe.deal counter. A counted shoe draws the card instead, see draw_counted.
+ *      The cards in play are mixed in with the discards, so an ordered shoe that's run out can't be topped up in the
+ *      middle of a round and the card is refused instead.
  *
  *  Parameter(s):
  *      shoe: a Deck struct
  *      hand: a Hand struct
  *  Returns:
- *      N/A
+ *      bool: false if the shoe is out of cards
  */
-void deal_card(Deck *shoe, Hand *hand)
+bool deal_card(Deck *shoe, Hand *hand)
 {
+    if (!can_deal(shoe, 1))
+    {
+        zerror("Shoe is out of cards, %u of %u dealt.", shoe->deal, shoe->cards);
+        return false;
+    }
+
     // allocate new node and assign the next card in the deck to it
     CardList *newCard = calloc(1, sizeof(CardList));
-    newCard->card = &shoe->shoe[shoe->deal++];
+    if (shoe->kind == SHOE_ORDERED)
+    {
+        newCard->card = &shoe->shoe[shoe->deal++];
+        shoe->remaining[VALUE_INDEX(newCard->card->value)]--;
+    }
+    else
+    {
+        newCard->card = draw_counted(shoe);
+    }
     newCard->nextCard = NULL;
     
     CardList *currCard = hand->cards;
@@ -161,7 +370,67 @@ void deal_card(Deck *shoe, Hand *hand)
     }
     
     zinfo("Card dealt is: %s", newCard->card->face);
-    return;
+    return true;
+}
+
+/***************
+ *  Summary: Deal the first cards of a round to every hand
+ *
+ *  Description: Deals a card to each hand in turn, then a second, the way a dealer goes round the table. The cards go
+ *      in the nodes each Hand keeps for them, so nothing is allocated and no list is walked, and an ordered shoe is
+ *      checked once for the cards the whole round needs and then dealt straight from. The counts of the cards left
+ *      are kept up to date as for deal_card. The hands must be empty.
+ *
+ *  Parameter(s):
+ *      shoe: the Deck struct to deal from
+ *      hands: the hands in the order they're dealt to, the dealer's last
+ *      numHands: the number of hands
+ *
+ *  Returns:
+ *      bool: false, with nothing dealt, if an ordered shoe hasn't the cards left for the round
+ */
+bool deal_round(Deck *shoe, Hand **hands, uint16_t numHands)
+{
+    uint32_t cards = (uint32_t) numHands * INITIAL_CARDS;
+
+    if (shoe->kind == SHOE_ORDERED && shoe->deal + cards > shoe->cards)
+    {
+        zerror("Shoe has %u cards left, a round needs %u.", shoe->cards - shoe->deal, cards);
+        return false;
+    }
+
+    for (uint16_t hand = 0; hand < numHands; hand++)
+    {
+        hands[hand]->cards = &hands[hand]->dealt[0];
+        hands[hand]->dealt[0].nextCard = &hands[hand]->dealt[1];
+        hands[hand]->dealt[1].nextCard = NULL;
+    }
+
+    if (shoe->kind == SHOE_ORDERED)
+    {
+        Card *card = &shoe->shoe[shoe->deal];
+        for (uint8_t round = 0; round < INITIAL_CARDS; round++)
+        {
+            for (uint16_t hand = 0; hand < numHands; hand++, card++)
+            {
+                hands[hand]->dealt[round].card = card;
+                shoe->remaining[VALUE_INDEX(card->value)]--;
+            }
+        }
+        shoe->deal += cards;
+    }
+    else
+    {
+        for (uint8_t round = 0; round < INITIAL_CARDS; round++)
+        {
+            for (uint16_t hand = 0; hand < numHands; hand++)
+            {
+                hands[hand]->dealt[round].card = draw_counted(shoe);
+            }
+        }
+    }
+
+    return true;
 }
 
 /***************
@@ -225,3 +494,101 @@ uint8_t blackjack_count(Hand hand)
     zdebug("Final count: %u", count);
     return count;
 }
+
+/***************
+ *  Summary: Count the cards of each value in the shoe
+ *
+ *  Description: Sets the remaining counts for a full shoe. After this deal_card keeps them up to date so nobody needs
+ *      to re-scan the shoe to know what is left in it.
+ *
+ *  Parameter(s):
+ *      shoe: pointer to a shoe of cards
+ *
+ *  Returns:
+ *      N/A
+ */
+static void reset_remaining(Deck *shoe)
+{
+    // a counted shoe holds one deck of cards, each standing for that card in every deck
+    uint16_t cards = (shoe->kind == SHOE_ORDERED) ? shoe->cards : CARDS_IN_DECK;
+    uint16_t copies = (shoe->kind == SHOE_ORDERED) ? 1 : shoe->cards / CARDS_IN_DECK;
+
+    memset(shoe->remaining, 0, sizeof(shoe->remaining));
+    for (uint16_t card = 0; card < cards; card++)
+    {
+        shoe->remaining[VALUE_INDEX(shoe->shoe[card].value)] += copies;
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Fill in cards with the ranks and suits in order
+ *
+ *  Parameter(s):
+ *      cards: the cards to fill in
+ *      numCards: the number of cards, a whole number of decks
+ *
+ *  Returns:
+ *      N/A
+ */
+void fill_cards(Card *cards, uint16_t numCards)
+{
+    char *ranks[13] = {" A", " 2", " 3", " 4", " 5", " 6", " 7", " 8", " 9", "10", " J", " Q", " K"};
+    char *suits[4] =  {SPADE, CLUB, HEART, DIAMOND};
+    uint8_t values[13] = {11, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10};
+    
+    for (uint16_t card = 0; card < numCards; card++)
+    {
+        uint16_t cc = card % CARDS_IN_DECK;
+        strncpy(cards[card].rank, ranks[cc % 13], 3);
+        strncpy(cards[card].suit, suits[cc / 13], 4);
+        strncpy(cards[card].face, ranks[cc % 13], 3);
+        strncat(cards[card].face, suits[cc / 13], 4);
+        cards[card].value = values[cc % 13];
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Draw a card from a counted shoe
+ *
+ *  Description: Picks a value with probability in proportion to the number of cards of that value left, then one of
+ *      the cards of that value at random for its rank and suit. Running out of cards starts the shoe again, which can
+ *      only happen if a round is dealt past the cut card and through the whole shoe.
+ *
+ *  Parameter(s):
+ *      shoe: pointer to a counted shoe of cards
+ *
+ *  Returns:
+ *      card: pointer to the card in the shoe's single deck
+ */
+static Card *draw_counted(Deck *shoe)
+{
+    if (shoe->deal == shoe->cards)
+    {
+        zerror("Counted shoe ran out of cards, starting it again.");
+        shuffle_cards(shoe);
+    }
+
+    uint32_t pick = random() % (shoe->cards - shoe->deal);
+    uint8_t index = 0;
+    while (pick >= shoe->remaining[index])
+    {
+        pick -= shoe->remaining[index++];
+    }
+
+    if (shoe->kind == SHOE_COUNTED)
+    {
+        shoe->remaining[index]--;
+        shoe->deal++;
+    }
+
+    // the single deck is in rank order within each suit: A, 2 to 9, then the four ten valued ranks
+    uint8_t value = index + 2;
+    uint8_t rank = (value == 11) ? 0 : (value == 10) ? 9 + random() % 4 : value - 1;
+    uint8_t suit = random() % 4;
+
+    return &shoe->shoe[suit * 13 + rank];
+}
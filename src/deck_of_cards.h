@@ -58,6 +58,22 @@
 #define CLUB "\u2663"
 #define HEART "\u2665"
 #define DIAMOND "\u2666"
+#define FACE_LENGTH 5                   // bytes in Card.face: the rank padded to two characters and a three byte suit
+#define CARD_VALUES 10                  // 2 through 10 plus the Ace
+#define VALUE_INDEX(value) ((value) - 2) // index into Deck.remaining for a card value
+#define INFINITE_DECKS 0                // decks for init_counted_deck to draw as if from an endless shoe
+#define MAX_COUNTED_DECKS (UINT16_MAX / CARDS_IN_DECK)
+#define RANDOM_STATE_SIZE 256           // bytes of random() state kept by seed_random
+#define INITIAL_CARDS 2                 // cards dealt to each hand at the start of a round
+#define MAX_HAND_CARDS 22               // 21 Aces and the card that busts them, the most a hand can hold
+#define DEALT_IN_HAND(hand, node) ((node) == &(hand)->dealt[0] || (node) == &(hand)->dealt[1])
+
+typedef enum ShoeKind
+{
+    SHOE_ORDERED,       // every card in shoe, dealt in the order shuffled
+    SHOE_COUNTED,       // only the count of each value left, cards drawn by weighted sampling
+    SHOE_INFINITE       // counted, but the counts never go down
+} ShoeKind;
 
 typedef struct Card
 {
@@ -69,9 +85,11 @@ typedef struct Card
 
 typedef struct Deck
 {
-    Card *shoe;
+    Card *shoe;                         // the cards in order, or one deck of them to draw from when counted
+    ShoeKind kind;
     uint16_t cards;
-    uint16_t deal;
+    uint16_t deal;                      // next card to deal; those before it are in play or, between rounds, discarded
+    uint16_t remaining[CARD_VALUES];    // cards of each value left to deal, kept as cards are dealt
 } Deck;
 
 typedef struct CardList
@@ -84,15 +102,29 @@ typedef struct Hand
 {
     CardList *cards;
     uint32_t bet;
+    uint8_t splits;         // splits made at the seat so far, kept up to date on this hand and those after it
+    bool surrendered;
+    bool evenMoney;         // blackjack taken at 1:1 against a dealer Ace
+    uint32_t insurance;     // insurance bet, settled when the dealer checks for blackjack
     struct Hand *nextHand;
+    CardList dealt[INITIAL_CARDS];      // nodes for the first cards, so deal_round needn't allocate; never freed
 } Hand;
 
 /****************
  * DECLARATIONS *
  ****************/
 Deck *init_deck(uint8_t decks);
+Deck *init_counted_deck(uint16_t decks);
+void seed_random(unsigned int seed);
+bool save_random(char *state);
+void restore_random(const char *state);
 void shuffle_cards(Deck *shoe);
-void deal_card(Deck *shoe, Hand *hand);
+void shuffle_discards(Deck *shoe);
+void fill_cards(Card *cards, uint16_t numCards);
+Card *replace_cards(Deck *shoe, Card *cards);
+bool can_deal(const Deck *shoe, uint16_t cards);
+bool deal_card(Deck *shoe, Hand *hand);
+bool deal_round(Deck *shoe, Hand **hands, uint16_t numHands);
 uint8_t blackjack_count(Hand hand);
 
 #endif /* DECK_OF_CARDS_H_ */
@@ -0,0 +1,607 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  edge.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Exact house edge for a rule set and number of decks, as a reference for the simulator. Every
+ *               starting hand against every dealer upcard is enumerated card by card with the probability of each
+ *               card given what has been dealt, the player taking the best choice at every point with the cards in
+ *               their own hand known. Hands are judged by the engine: blackjack_count, the can_* checks and the
+ *               dealer_must_hit rule play_dealer_hand plays by. Splits are played out for one hand and counted
+ *               twice, without resplitting, and the player draws as if the dealer's hole card were back in the
+ *               shoe, the usual approximations of combinatorial analyzers. The starting hands are shared out among
+ *               one thread per core.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "engine.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "deck_of_cards.h"
+#include "rules.h"
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define EDGE_DECKS 6
+#define EDGE_MAX_DECKS 64
+#define EDGE_MAX_THREADS 256
+#define EDGE_MAX_CARDS 24           // more than a hand can hold without busting, even from 64 decks of Aces
+#define EDGE_CACHE_BITS 15          // a worker remembers this many hand compositions, 2^bits
+#define DEALER_OUTCOMES 6           // the dealer ends on 17, 18, 19, 20, 21 or busts
+#define DEALER_BUST 5
+#define CARD_INDEX(value) VALUE_INDEX(value)
+
+typedef struct EdgeHand             // a hand built on the stack, so the engine's functions can judge it
+{
+    Hand hand;
+    CardList cards[EDGE_MAX_CARDS];
+    uint8_t numCards;
+} EdgeHand;
+
+typedef struct EdgeEntry            // what's known about one composition of the cards left
+{
+    uint16_t counts[CARD_VALUES];
+    bool split;                     // the player's hand is one half of a split pair
+    bool used;
+    bool haveDealer;
+    bool havePlay;
+    double dealer[DEALER_OUTCOMES]; // chance of each dealer outcome with these cards left
+    double play;                    // expected value of standing or hitting, whichever is better
+} EdgeEntry;
+
+typedef struct EdgeTask             // one starting hand against one upcard
+{
+    uint8_t first;
+    uint8_t second;
+    uint8_t upcard;
+    double weight;                  // chance of the deal, doubled for the two orders of unpaired cards
+    double ev;                      // expected value per unit bet, filled in by a worker
+} EdgeTask;
+
+typedef struct EdgeWorker
+{
+    const Rules *rules;
+    uint16_t counts[CARD_VALUES];   // cards left, by value
+    uint16_t total;
+    EdgeHand player;
+    EdgeHand dealer;
+    bool split;
+    EdgeEntry *cache;
+    uint32_t cached;
+} EdgeWorker;
+
+typedef struct EdgeJob              // the tasks, shared by the workers
+{
+    EdgeTask *tasks;
+    uint32_t numTasks;
+    uint32_t next;                  // the next task to hand out
+    pthread_mutex_t lock;
+    const Rules *rules;
+    const uint16_t *counts;         // the full shoe
+} EdgeJob;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static Card valueCards[CARD_VALUES];   // one card of each value for the hands to point at
+
+static void *run_worker(void *arg);
+static double deal_ev(EdgeWorker *worker, const EdgeTask *task);
+static double play_ev(EdgeWorker *worker);
+static double hit_ev(EdgeWorker *worker);
+static double stand_ev(EdgeWorker *worker);
+static double double_ev(EdgeWorker *worker);
+static double split_ev(EdgeWorker *worker);
+static void dealer_outcomes(EdgeWorker *worker, double *outcomes);
+static void dealer_draws(EdgeWorker *worker, double prob, double *outcomes);
+static EdgeEntry *find_entry(EdgeWorker *worker);
+static void take_card(EdgeWorker *worker, EdgeHand *hand, uint8_t value);
+static void return_card(EdgeWorker *worker, EdgeHand *hand);
+static void push_card(EdgeHand *hand, uint8_t value);
+static void pop_card(EdgeHand *hand);
+
+int main(int argc, char *argv[])
+{
+    long decks = EDGE_DECKS;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *rulesPath = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:R:j:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd':
+                decks = strtol(optarg, NULL, 10);
+                break;
+            case 'R':
+                rulesPath = optarg;
+                break;
+            case 'j':
+                threads = strtol(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-d decks] [-R rules.conf] [-j threads]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (decks < 1 || decks > EDGE_MAX_DECKS)
+    {
+        fprintf(stderr, "Decks must be 1 to %d.\n", EDGE_MAX_DECKS);
+        return EXIT_FAILURE;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > EDGE_MAX_THREADS) threads = EDGE_MAX_THREADS;
+
+    if (init_zlog("edge.conf", "log")) return EXIT_FAILURE;
+
+    Rules rules = RULES_S17;
+    if (rulesPath && !load_rules(rulesPath, &rules))
+    {
+        fprintf(stderr, "Couldn't read rules file %s, see the log.\n", rulesPath);
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    // one card of each value, and the full shoe counted by value
+    Card deck[CARDS_IN_DECK];
+    uint16_t counts[CARD_VALUES] = {0};
+    uint16_t total = decks * CARDS_IN_DECK;
+    fill_cards(deck, CARDS_IN_DECK);
+    for (uint8_t card = 0; card < CARDS_IN_DECK; card++)
+    {
+        valueCards[CARD_INDEX(deck[card].value)] = deck[card];
+        counts[CARD_INDEX(deck[card].value)] += decks;
+    }
+
+    // every starting pair of values against every upcard, weighted by the chance of it being dealt
+    static EdgeTask tasks[CARD_VALUES * (CARD_VALUES + 1) / 2 * CARD_VALUES];
+    EdgeJob job = {.tasks = tasks, .rules = &rules, .counts = counts};
+    for (uint8_t first = 0; first < CARD_VALUES; first++)
+    {
+        for (uint8_t second = first; second < CARD_VALUES; second++)
+        {
+            for (uint8_t upcard = 0; upcard < CARD_VALUES; upcard++)
+            {
+                double weight = (double) counts[first] / total;
+                weight *= (double) (counts[second] - (second == first)) / (total - 1);
+                weight *= (double) (counts[upcard] - (upcard == first) - (upcard == second)) / (total - 2);
+                tasks[job.numTasks++] = (EdgeTask) {.first = first + 2, .second = second + 2, .upcard = upcard + 2,
+                        .weight = (first == second) ? weight : 2 * weight};
+            }
+        }
+    }
+    pthread_mutex_init(&job.lock, NULL);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_t workers[EDGE_MAX_THREADS];
+    long started = 0;
+    while (started < threads && pthread_create(&workers[started], NULL, run_worker, &job) == 0)
+    {
+        started++;
+    }
+    for (long worker = 0; worker < started; worker++)
+    {
+        pthread_join(workers[worker], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_mutex_destroy(&job.lock);
+    if (started == 0 || job.next < job.numTasks)
+    {
+        fprintf(stderr, "Couldn't finish the analysis, see the log.\n");
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    // summed in task order so the result doesn't depend on which worker finished first
+    double ev = 0;
+    for (uint32_t task = 0; task < job.numTasks; task++)
+    {
+        ev += tasks[task].weight * tasks[task].ev;
+    }
+    printf("Decks:       %ld\n", decks);
+    printf("Rules:       %s, blackjack pays %u:%u, %s, split to %u hands%s\n", rules.hitSoft17 ? "H17" : "S17",
+            rules.payoutNum, rules.payoutDen, rules.doubleAfterSplit ? "DAS" : "no DAS", rules.maxHands,
+            rules.surrender ? ", late surrender" : "");
+    printf("Player EV:   %+.4f%%\n", 100.0 * ev);
+    printf("House edge:  %.4f%%\n", -100.0 * ev);
+    printf("Time:        %.3f s (%ld threads)\n",
+            (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, started);
+    end_zlog();
+
+    return EXIT_SUCCESS;
+}
+
+/***************
+ *  Summary: A worker thread, analyzing tasks until there are none left
+ *
+ *  Parameter(s):
+ *      arg: the EdgeJob struct
+ *
+ *  Returns:
+ *      NULL
+ */
+static void *run_worker(void *arg)
+{
+    EdgeJob *job = arg;
+    EdgeWorker worker = {.rules = job->rules};
+    worker.cache = malloc(sizeof(EdgeEntry) << EDGE_CACHE_BITS);
+    if (worker.cache == NULL)
+    {
+        zerror("Couldn't allocate memory for a worker's cache.");
+        return NULL;
+    }
+
+    while (true)
+    {
+        pthread_mutex_lock(&job->lock);
+        uint32_t task = job->next;
+        job->next += (task < job->numTasks);
+        pthread_mutex_unlock(&job->lock);
+        if (task >= job->numTasks) break;
+
+        // each task removes different cards, so nothing remembered from the last one applies
+        memcpy(worker.counts, job->counts, sizeof(worker.counts));
+        worker.total = 0;
+        for (uint8_t value = 0; value < CARD_VALUES; value++)
+        {
+            worker.total += worker.counts[value];
+        }
+        memset(worker.cache, 0, sizeof(EdgeEntry) << EDGE_CACHE_BITS);
+        worker.cached = 0;
+        job->tasks[task].ev = deal_ev(&worker, &job->tasks[task]);
+        zdebug("%2u,%2u against %2u: %+.6f", job->tasks[task].first, job->tasks[task].second, job->tasks[task].upcard,
+                job->tasks[task].ev);
+    }
+    free(worker.cache);
+
+    return NULL;
+}
+
+/***************
+ *  Summary: Expected value of a starting hand against an upcard
+ *
+ *  Description: The dealer checks for blackjack first, so the player's choices are only made, and the dealer's hand
+ *      only played out, when the hole card doesn't make one. A player's blackjack wins the blackjack payout unless
+ *      the dealer has one too.
+ *
+ *  Parameter(s):
+ *      worker: the EdgeWorker struct, with the full shoe counted
+ *      task: the starting hand and upcard
+ *
+ *  Returns:
+ *      ev: expected value per unit bet
+ */
+static double deal_ev(EdgeWorker *worker, const EdgeTask *task)
+{
+    worker->player.numCards = worker->dealer.numCards = 0;
+    worker->player.hand = (Hand) {.bet = 1};
+    worker->dealer.hand = (Hand) {0};
+    worker->split = false;
+    take_card(worker, &worker->player, task->first);
+    take_card(worker, &worker->player, task->second);
+    take_card(worker, &worker->dealer, task->upcard);
+
+    uint8_t holeBlackjack = (task->upcard == 11) ? 10 : (task->upcard == 10) ? 11 : 0;
+    double dealerBlackjack = holeBlackjack ? (double) worker->counts[CARD_INDEX(holeBlackjack)] / worker->total : 0;
+    if (is_blackjack(&worker->player.hand))
+    {
+        return (1 - dealerBlackjack) * worker->rules->payoutNum / worker->rules->payoutDen;
+    }
+
+    double best = play_ev(worker);
+    if (can_double(&worker->player.hand, UINT32_MAX, worker->rules))
+    {
+        double ev = double_ev(worker);
+        if (ev > best) best = ev;
+    }
+    if (can_split(&worker->player.hand, UINT32_MAX, worker->rules))
+    {
+        double ev = split_ev(worker);
+        if (ev > best) best = ev;
+    }
+    if (can_surrender(&worker->player.hand, worker->rules) && best < -0.5)
+    {
+        best = -0.5;
+    }
+
+    return -dealerBlackjack + (1 - dealerBlackjack) * best;
+}
+
+/***************
+ *  Summary: Expected value of the player's hand from here, standing or hitting, whichever is better
+ */
+static double play_ev(EdgeWorker *worker)
+{
+    uint8_t count = blackjack_count(worker->player.hand);
+    if (count > 21) return -1;
+    if (count == 21) return stand_ev(worker);
+
+    EdgeEntry *entry = find_entry(worker);
+    if (entry && entry->havePlay) return entry->play;
+
+    double stand = stand_ev(worker);
+    double hit = hit_ev(worker);
+    double best = (hit > stand) ? hit : stand;
+    if (entry)
+    {
+        entry->play = best;
+        entry->havePlay = true;
+    }
+
+    return best;
+}
+
+static double hit_ev(EdgeWorker *worker)
+{
+    double ev = 0;
+    uint16_t total = worker->total;
+
+    for (uint8_t value = 2; value <= 11; value++)
+    {
+        uint16_t count = worker->counts[CARD_INDEX(value)];
+        if (count == 0) continue;
+
+        take_card(worker, &worker->player, value);
+        ev += (double) count / total * play_ev(worker);
+        return_card(worker, &worker->player);
+    }
+
+    return ev;
+}
+
+/***************
+ *  Summary: Expected value of standing, from the chances of each way the dealer's hand can end
+ */
+static double stand_ev(EdgeWorker *worker)
+{
+    uint8_t count = blackjack_count(worker->player.hand);
+    if (count > 21) return -1;
+
+    double dealer[DEALER_OUTCOMES];
+    dealer_outcomes(worker, dealer);
+    double ev = dealer[DEALER_BUST];
+    for (uint8_t outcome = 0; outcome < DEALER_BUST; outcome++)
+    {
+        uint8_t dealerCount = DEALER_STANDS_ON + outcome;
+        ev += (count > dealerCount) ? dealer[outcome] : (count < dealerCount) ? -dealer[outcome] : 0;
+    }
+
+    return ev;
+}
+
+static double double_ev(EdgeWorker *worker)
+{
+    double ev = 0;
+    uint16_t total = worker->total;
+
+    for (uint8_t value = 2; value <= 11; value++)
+    {
+        uint16_t count = worker->counts[CARD_INDEX(value)];
+        if (count == 0) continue;
+
+        take_card(worker, &worker->player, value);
+        ev += (double) count / total * stand_ev(worker);
+        return_card(worker, &worker->player);
+    }
+
+    return 2 * ev;
+}
+
+/***************
+ *  Summary: Expected value of splitting a pair
+ *
+ *  Description: One of the two hands is played out, drawing to its single card with both of the pair's cards gone
+ *      from the shoe, and counted for both. The split hands can double if the rules allow it after a split but
+ *      aren't split again.
+ */
+static double split_ev(EdgeWorker *worker)
+{
+    double ev = 0;
+    uint16_t total = worker->total;
+
+    pop_card(&worker->player);
+    worker->player.hand.splits = 1;
+    worker->split = true;
+    for (uint8_t value = 2; value <= 11; value++)
+    {
+        uint16_t count = worker->counts[CARD_INDEX(value)];
+        if (count == 0) continue;
+
+        take_card(worker, &worker->player, value);
+        double best = play_ev(worker);
+        if (can_double(&worker->player.hand, UINT32_MAX, worker->rules))
+        {
+            double doubled = double_ev(worker);
+            if (doubled > best) best = doubled;
+        }
+        ev += (double) count / total * best;
+        return_card(worker, &worker->player);
+    }
+    worker->split = false;
+    worker->player.hand.splits = 0;
+    push_card(&worker->player, worker->player.cards[0].card->value);
+
+    return 2 * ev;
+}
+
+/***************
+ *  Summary: Chances of each way the dealer's hand can end with the cards left
+ *
+ *  Description: The hole card is drawn knowing it didn't give the dealer blackjack, then the dealer draws by
+ *      dealer_must_hit like play_dealer_hand does.
+ */
+static void dealer_outcomes(EdgeWorker *worker, double *outcomes)
+{
+    EdgeEntry *entry = find_entry(worker);
+    if (entry && entry->haveDealer)
+    {
+        memcpy(outcomes, entry->dealer, sizeof(entry->dealer));
+        return;
+    }
+
+    uint8_t upcard = worker->dealer.cards[0].card->value;
+    uint8_t holeBlackjack = (upcard == 11) ? 10 : (upcard == 10) ? 11 : 0;
+    uint16_t total = worker->total - (holeBlackjack ? worker->counts[CARD_INDEX(holeBlackjack)] : 0);
+    memset(outcomes, 0, DEALER_OUTCOMES * sizeof(double));
+    for (uint8_t value = 2; value <= 11; value++)
+    {
+        uint16_t count = worker->counts[CARD_INDEX(value)];
+        if (count == 0 || value == holeBlackjack) continue;
+
+        take_card(worker, &worker->dealer, value);
+        dealer_draws(worker, (double) count / total, outcomes);
+        return_card(worker, &worker->dealer);
+    }
+    if (entry)
+    {
+        memcpy(entry->dealer, outcomes, sizeof(entry->dealer));
+        entry->haveDealer = true;
+    }
+
+    return;
+}
+
+static void dealer_draws(EdgeWorker *worker, double prob, double *outcomes)
+{
+    if (!dealer_must_hit(&worker->dealer.hand, worker->rules))
+    {
+        uint8_t count = blackjack_count(worker->dealer.hand);
+        outcomes[(count > 21) ? DEALER_BUST : count - DEALER_STANDS_ON] += prob;
+        return;
+    }
+
+    uint16_t total = worker->total;
+    for (uint8_t value = 2; value <= 11; value++)
+    {
+        uint16_t count = worker->counts[CARD_INDEX(value)];
+        if (count == 0) continue;
+
+        take_card(worker, &worker->dealer, value);
+        dealer_draws(worker, prob * count / total, outcomes);
+        return_card(worker, &worker->dealer);
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Find the worker's cache entry for the cards left, adding it if it's new
+ *
+ *  Description: Open addressing on an FNV-1a hash of the counts. Within a task the cards left say exactly what's in
+ *      the player's hand, apart from which half of a split it is, so they're the whole key.
+ *
+ *  Returns:
+ *      entry: pointer to the EdgeEntry struct or NULL if the cache is full, and the caller has to work it out
+ */
+static EdgeEntry *find_entry(EdgeWorker *worker)
+{
+    const uint8_t *bytes = (const uint8_t *) worker->counts;
+    uint32_t hash = 2166136261u;
+    for (size_t ii = 0; ii < sizeof(worker->counts); ii++)
+    {
+        hash = (hash ^ bytes[ii]) * 16777619u;
+    }
+    hash = (hash ^ worker->split) * 16777619u;
+
+    uint32_t mask = (1u << EDGE_CACHE_BITS) - 1;
+    for (uint32_t slot = hash & mask; ; slot = (slot + 1) & mask)
+    {
+        EdgeEntry *entry = &worker->cache[slot];
+        if (!entry->used)
+        {
+            // keep a quarter free so probing stays short
+            if (worker->cached >= (mask + 1) / 4 * 3) return NULL;
+            memcpy(entry->counts, worker->counts, sizeof(entry->counts));
+            entry->split = worker->split;
+            entry->used = true;
+            worker->cached++;
+            return entry;
+        }
+        if (entry->split == worker->split && !memcmp(entry->counts, worker->counts, sizeof(entry->counts)))
+        {
+            return entry;
+        }
+    }
+}
+
+/***************
+ *  Summary: Deal a card of a value from the cards left to a hand, and put it back
+ */
+static void take_card(EdgeWorker *worker, EdgeHand *hand, uint8_t value)
+{
+    worker->counts[CARD_INDEX(value)]--;
+    worker->total--;
+    push_card(hand, value);
+
+    return;
+}
+
+static void return_card(EdgeWorker *worker, EdgeHand *hand)
+{
+    worker->counts[CARD_INDEX(hand->cards[hand->numCards - 1].card->value)]++;
+    worker->total++;
+    pop_card(hand);
+
+    return;
+}
+
+/***************
+ *  Summary: Add a card of a value to the end of a hand's list of cards, and take the last one off
+ */
+static void push_card(EdgeHand *hand, uint8_t value)
+{
+    CardList *card = &hand->cards[hand->numCards];
+    card->card = &valueCards[CARD_INDEX(value)];
+    card->nextCard = NULL;
+    if (hand->numCards) hand->cards[hand->numCards - 1].nextCard = card;
+    else hand->hand.cards = card;
+    hand->numCards++;
+
+    return;
+}
+
+static void pop_card(EdgeHand *hand)
+{
+    hand->numCards--;
+    if (hand->numCards) hand->cards[hand->numCards - 1].nextCard = NULL;
+    else hand->hand.cards = NULL;
+
+    return;
+}
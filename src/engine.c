@@ -0,0 +1,539 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  engine.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Description: The rules of a round of blackjack without any display or input handling, so that
+ *               the ncurses game and the game server play by exactly the same rules.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "engine.h"
+
+/****************
+ * DECLARATIONS *
+ ****************/
+
+/***************
+ *  Summary: Check if the shoe needs re-shuffling
+ *
+ *  Description: The shoe is re-shuffled before a round once less than RESHUFFLE_POINT of the cards are left in it.
+ *
+ *  Parameter(s):
+ *      shoe: the shoe of cards being dealt from
+ *
+ *  Returns:
+ *      bool: true if the shoe should be re-shuffled before dealing
+ */
+bool shoe_needs_shuffle(Deck *shoe)
+{
+    return ((shoe->cards - shoe->deal) < (shoe->cards * RESHUFFLE_POINT));
+}
+
+/***************
+ *  Summary: Return the dealer's upcard
+ *
+ *  Description: The first card dealt to the dealer is the hole card, so the upcard is the second card in the hand.
+ *
+ *  Parameter(s):
+ *      dealerHand: the dealer's Hand struct
+ *
+ *  Returns:
+ *      Card: pointer to the upcard or NULL if the dealer doesn't have two cards yet
+ */
+Card *dealer_upcard(Hand *dealerHand)
+{
+    if (dealerHand->cards == NULL || dealerHand->cards->nextCard == NULL)
+    {
+        return NULL;
+    }
+
+    return dealerHand->cards->nextCard->card;
+}
+
+/***************
+ *  Summary: Check if the dealer has blackjack
+ *
+ *  Description: The dealer only peeks at the hole card when showing a ten valued card or an Ace.
+ *
+ *  Parameter(s):
+ *      dealerHand: the dealer's Hand struct
+ *
+ *  Returns:
+ *      bool: true if the dealer has blackjack
+ */
+bool dealer_has_blackjack(Hand *dealerHand)
+{
+    Card *upcard = dealer_upcard(dealerHand);
+    if (upcard == NULL || upcard->value < 10)
+    {
+        return false;
+    }
+
+    return (blackjack_count(*dealerHand) == 21);
+}
+
+/***************
+ *  Summary: Check if the dealer has to take another card under S17 or H17 rules, see dealer_must_hit
+ */
+bool dealer_must_hit_s17(Hand *dealerHand)
+{
+    return (blackjack_count(*dealerHand) < DEALER_STANDS_ON);
+}
+
+bool dealer_must_hit_h17(Hand *dealerHand)
+{
+    uint8_t count = blackjack_count(*dealerHand);
+    return (count < DEALER_STANDS_ON || (count == DEALER_STANDS_ON && hand_is_soft(dealerHand)));
+}
+
+/***************
+ *  Summary: Check if a hand is a blackjack
+ *
+ *  Description: A blackjack is a count of 21 with only two cards in the hand.
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct to check
+ *
+ *  Returns:
+ *      bool: true if the hand is a blackjack
+ */
+bool is_blackjack(Hand *hand)
+{
+    if (hand->cards == NULL || hand->cards->nextCard == NULL || hand->cards->nextCard->nextCard != NULL)
+    {
+        return false;
+    }
+
+    return (blackjack_count(*hand) == 21);
+}
+
+/***************
+ *  Summary: Check if a hand counts an Ace as 11
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct to check
+ *
+ *  Returns:
+ *      bool: true if the hand's count is soft
+ */
+bool hand_is_soft(Hand *hand)
+{
+    bool hasAce = false;
+    uint8_t hardCount = 0;
+
+    for (CardList *cards = hand->cards; cards != NULL; cards = cards->nextCard)
+    {
+        if (cards->card->value == 11)
+        {
+            hasAce = true;
+            hardCount += 1;
+        }
+        else
+        {
+            hardCount += cards->card->value;
+        }
+    }
+
+    return (hasAce && hardCount + 10 <= 21);
+}
+
+/***************
+ *  Summary: Return the Hi-Lo count value of a card
+ *
+ *  Parameter(s):
+ *      card: the Card struct
+ *
+ *  Returns:
+ *      int8_t: +1 for 2 to 6, -1 for ten valued cards and Aces, 0 otherwise
+ */
+int8_t hi_lo_value(Card *card)
+{
+    if (card->value <= 6) return 1;
+    if (card->value >= 10) return -1;
+    return 0;
+}
+
+/***************
+ *  Summary: Return the Hi-Lo running count of the cards dealt from the shoe
+ *
+ *  Description: Worked out from the remaining counts the shoe keeps, so it costs the same however far into the shoe we
+ *      are. It includes every card dealt, so a caller hiding the dealer's hole card has to take it back out.
+ *
+ *  Parameter(s):
+ *      shoe: the shoe of cards being dealt from
+ *
+ *  Returns:
+ *      int16_t: the running count
+ */
+int16_t running_count(Deck *shoe)
+{
+    uint16_t decks = shoe->cards / CARDS_IN_DECK;
+    int16_t count = 0;
+
+    for (uint8_t value = 2; value <= 6; value++)
+    {
+        count += (decks * 4) - shoe->remaining[VALUE_INDEX(value)];
+    }
+    count -= (decks * 16) - shoe->remaining[VALUE_INDEX(10)];
+    count -= (decks * 4) - shoe->remaining[VALUE_INDEX(11)];
+
+    return count;
+}
+
+/***************
+ *  Summary: Check if a hand can take insurance or even money
+ *
+ *  Description: Offered on the first two cards of every hand when the dealer shows an Ace. A blackjack is offered
+ *      even money instead, which costs nothing up front; anything else needs half the bet for the insurance.
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct
+ *      dealerHand: the dealer's Hand struct
+ *      bank: the player's money
+ *
+ *  Returns:
+ *      bool: true if the hand can be insured
+ */
+bool can_insure(Hand *hand, Hand *dealerHand, uint32_t bank)
+{
+    Card *upcard = dealer_upcard(dealerHand);
+    if (upcard == NULL || upcard->value != 11 || hand->insurance > 0 || hand->evenMoney || hand->bet < 2)
+    {
+        return false;
+    }
+
+    return (is_blackjack(hand) || hand->bet / 2 <= bank);
+}
+
+/***************
+ *  Summary: Take insurance, or even money on a blackjack
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct, which has passed can_insure
+ *      bank: the player's money, which the insurance bet is taken from
+ *
+ *  Returns:
+ *      bool: true for even money, false for an insurance bet
+ */
+bool take_insurance(Hand *hand, uint32_t *bank)
+{
+    if (is_blackjack(hand))
+    {
+        hand->evenMoney = true;
+        return true;
+    }
+
+    hand->insurance = hand->bet / 2;
+    *bank -= hand->insurance;
+    return false;
+}
+
+/***************
+ *  Summary: Settle an insurance bet once the dealer has checked for blackjack
+ *
+ *  Description: Insurance pays 2:1 if the dealer has blackjack and is lost otherwise. Either way the bet is cleared.
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct
+ *      dealerBlackjack: true if the dealer has blackjack
+ *      bank: the player's money, which the payout is added to
+ *
+ *  Returns:
+ *      payout: the amount added to the bank, 0 if lost or there was no bet
+ */
+uint32_t settle_insurance(Hand *hand, bool dealerBlackjack, uint32_t *bank)
+{
+    uint32_t payout = dealerBlackjack ? hand->insurance * 3 : 0;
+    *bank += payout;
+    hand->insurance = 0;
+
+    return payout;
+}
+
+/***************
+ *  Summary: Count the ten valued cards the players haven't seen
+ *
+ *  Description: Taken from the shoe's remaining counts, with the dealer's hole card put back since the players can't
+ *      see it, so it costs the same however far into the shoe we are. Tens over cards is the chance the hole card is a
+ *      ten.
+ *
+ *  Parameter(s):
+ *      shoe: the shoe being dealt from
+ *      dealerHand: the dealer's Hand struct, with the hole card dealt
+ *      tens: set to the number of unseen ten valued cards
+ *      cards: set to the number of unseen cards
+ *
+ *  Returns:
+ *      N/A
+ */
+void unseen_tens(Deck *shoe, Hand *dealerHand, uint16_t *tens, uint16_t *cards)
+{
+    *tens = shoe->remaining[VALUE_INDEX(10)];
+    *cards = shoe->cards - shoe->deal;
+
+    if (dealerHand->cards != NULL)
+    {
+        *tens += (dealerHand->cards->card->value == 10);
+        *cards += 1;
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Double the bet on a hand
+ *
+ *  Description: Takes the amount of the bet on the hand from the bank again and doubles the bet. The caller deals
+ *      the one extra card the player gets for doubling down.
+ *
+ *  Parameter(s):
+ *      hand: Hand struct being doubled down on
+ *      bank: the player's money
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      bool: true if the bet was doubled, false if the rules don't allow it or there isn't enough money
+ */
+bool double_bet(Hand *hand, uint32_t *bank, const Rules *rules)
+{
+    if (!can_double(hand, *bank, rules))
+    {
+        zinfo("Can't double down on this hand.");
+        return false;
+    }
+
+    *bank -= hand->bet;
+    hand->bet *= 2;
+    return true;
+}
+
+/***************
+ *  Summary: Split a hand of two cards of same value into two hands
+ *
+ *  Description: Splits a hand of two cards into two hands. There must be two cards only of the same value, the seat
+ *      must be under the rules' limit of hands, and the player must have enough money to replicate the bet of the hand
+ *      being split. (The new hand will have the same bet as the hand being split.)
+ *
+ *  Parameter(s):
+ *      handToSplit: Hand struct to be split
+ *      bank: the player's money
+ *      shoe: the shoe to deal the second card of each hand from
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      bool: true if the hand was split
+ */
+bool split_hand(Hand *handToSplit, uint32_t *bank, Deck *shoe, const Rules *rules)
+{
+    // check if we have one card in the hand
+    if (handToSplit->cards->nextCard == NULL)
+    {
+        zerror("Hand to be split only has one card.");
+        return false;
+    }
+    
+    // check if we have more than two cards in the hand
+    if(handToSplit->cards->nextCard->nextCard != NULL)
+    {
+        zerror("Hand has more than two cards.");
+        return false;
+    }
+    
+    if (handToSplit->splits + 1 >= rules->maxHands)
+    {
+        zinfo("Seat already has the most hands allowed.");
+        return false;
+    }
+
+    if (!can_deal(shoe, 2))
+    {
+        zinfo("Shoe hasn't the cards left for both hands.");
+        return false;
+    }
+
+    // we have only two cards so make sure they're the same value
+    if (handToSplit->cards->card->value == handToSplit->cards->nextCard->card->value)
+    {
+        // cards have same value, do we have enough money to cover the additional bet
+        if (handToSplit->bet < *bank)
+        {
+            // the second card moves to the new hand's own node, as a node dealt by deal_round belongs to its hand
+            Hand *newHand = calloc(1, sizeof(Hand));
+            CardList *secondCard = handToSplit->cards->nextCard;
+            newHand->dealt[0].card = secondCard->card;
+            newHand->cards = &newHand->dealt[0];
+            if (!DEALT_IN_HAND(handToSplit, secondCard)) free(secondCard);
+            newHand->bet = handToSplit->bet;
+            newHand->nextHand = handToSplit->nextHand;
+            handToSplit->cards->nextCard = NULL;
+            handToSplit->nextHand = newHand;
+
+            // hands before this one are finished, so only this one and those after it need the new split count
+            uint8_t splits = handToSplit->splits + 1;
+            for (Hand *hand = handToSplit; hand != NULL; hand = hand->nextHand)
+            {
+                hand->splits = splits;
+            }
+            deal_card(shoe, handToSplit);
+            deal_card(shoe, newHand);
+            *bank -= handToSplit->bet;
+            return true;
+        }
+        else
+        {
+            zinfo("Not enough money to split cards.");
+            return false;
+        }
+    }
+    
+    zinfo("Cards are not the same value!");
+    return false;
+}
+
+/***************
+ *  Summary: Settle the bet on a hand against the dealer
+ *
+ *  Description: Compare the hand against the dealer's count and pay out the bet into the bank. A player wins if the
+ *      dealer busts or the player has the higher count without busting. A tie returns the bet, a win pays 1:1 and a
+ *      blackjack pays what the rules say, even against a dealer's 21 in more cards. 21 in two cards after a split is a
+ *      win, not a blackjack. Dealer blackjack beats everything but a player blackjack, which pushes, so every caller
+ *      must pass dealerBlackjack through. A surrendered hand gets half its bet back, and a blackjack taken at even
+ *      money wins 1:1 whatever the dealer has.
+ *
+ *  Parameter(s):
+ *      hand: the player's Hand struct
+ *      dealerCount: the final count of the dealer's hand
+ *      dealerBlackjack: true if the dealer has blackjack
+ *      rules: the table's Rules
+ *      bank: the player's money, which the payout is added to
+ *      payout: set to the amount added to the bank
+ *
+ *  Returns:
+ *      HandResult: the outcome of the hand
+ */
+HandResult settle_hand(Hand *hand, uint8_t dealerCount, bool dealerBlackjack, const Rules *rules, uint32_t *bank,
+        uint32_t *payout)
+{
+    *payout = 0;
+    if (hand->surrendered)
+    {
+        *payout = hand->bet / 2;
+        *bank += *payout;
+        return HAND_SURRENDERED;
+    }
+    if (hand->evenMoney)
+    {
+        *payout = hand->bet * 2;
+        *bank += *payout;
+        return HAND_WON;
+    }
+    if (dealerBlackjack)
+    {
+        if (!is_blackjack(hand) || hand->splits > 0) return HAND_LOST;
+        *payout = hand->bet;
+        *bank += *payout;
+        return HAND_PUSH;
+    }
+
+    uint8_t playerCount = blackjack_count(*hand);
+    if (playerCount > 21 || (dealerCount <= 21 && playerCount < dealerCount))
+    {
+        return HAND_LOST;
+    }
+
+    HandResult result;
+    if (playerCount == 21 && hand->cards->nextCard->nextCard == NULL && hand->splits == 0)
+    {
+        // the dealer's 21 here took more than two cards, which a blackjack beats
+        *payout = hand->bet + (uint64_t) hand->bet * rules->payoutNum / rules->payoutDen;
+        result = HAND_BLACKJACK;
+    }
+    else if (playerCount == dealerCount)
+    {
+        *payout = hand->bet;
+        result = HAND_PUSH;
+    }
+    else
+    {
+        *payout = hand->bet * 2;
+        result = HAND_WON;
+    }
+
+    *bank += *payout;
+    return result;
+}
+
+/***************
+ *  Summary: Clear the hand of cards
+ *
+ *  Description: Clear the hand of cards, setting to NULL or freeing as needed.
+ *
+ *  Parameter(s):
+ *      hand: Hand struct of the hand to clear
+ *
+ *  Returns:
+ *      N/A
+ */
+void clear_hands(Hand *hand)
+{
+    Hand *currHand = hand;
+    Hand *tempHand = NULL;
+    
+    while (currHand != NULL)
+    {
+        CardList *currCard = currHand->cards;
+        CardList *tempCard = NULL;
+        
+        while (currCard != NULL)
+        {
+            tempCard = currCard->nextCard;
+            if (!DEALT_IN_HAND(currHand, currCard)) free(currCard);
+            currCard = tempCard;
+        }
+        
+        currHand->cards = NULL;
+        tempHand = currHand->nextHand;
+        if (currHand != hand)
+        {
+            free(currHand);
+        }
+        currHand = tempHand;
+    }
+    
+    hand->bet = 0;
+    hand->splits = 0;
+    hand->surrendered = false;
+    hand->evenMoney = false;
+    hand->insurance = 0;
+    hand->nextHand = NULL;
+    
+    return;
+}
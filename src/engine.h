@@ -0,0 +1,248 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  engine.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Description: The curses-free rules of a round of blackjack, shared by the ncurses game and the
+ *               game server.
+ */
+
+#ifndef ENGINE_H_
+#define ENGINE_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "deck_of_cards.h"
+#include "rules.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define RESHUFFLE_POINT 0.2     // re-shuffle once less than this fraction of the shoe is left
+#define DEALER_STANDS_ON 17
+
+typedef enum PlayerChoice
+{
+    STAND, HIT, DOUBLE, SPLIT, SURRENDER
+} PlayerChoice;
+
+typedef enum ChoiceResult
+{
+    HAND_CONTINUES, HAND_FINISHED, CHOICE_REFUSED
+} ChoiceResult;
+
+typedef enum HandResult
+{
+    HAND_LOST, HAND_PUSH, HAND_WON, HAND_BLACKJACK, HAND_SURRENDERED
+} HandResult;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+bool shoe_needs_shuffle(Deck *shoe);
+Card *dealer_upcard(Hand *dealerHand);
+bool dealer_has_blackjack(Hand *dealerHand);
+bool dealer_must_hit_s17(Hand *dealerHand);
+bool dealer_must_hit_h17(Hand *dealerHand);
+bool is_blackjack(Hand *hand);
+bool hand_is_soft(Hand *hand);
+int8_t hi_lo_value(Card *card);
+int16_t running_count(Deck *shoe);
+bool can_insure(Hand *hand, Hand *dealerHand, uint32_t bank);
+bool take_insurance(Hand *hand, uint32_t *bank);
+uint32_t settle_insurance(Hand *hand, bool dealerBlackjack, uint32_t *bank);
+void unseen_tens(Deck *shoe, Hand *dealerHand, uint16_t *tens, uint16_t *cards);
+bool double_bet(Hand *hand, uint32_t *bank, const Rules *rules);
+bool split_hand(Hand *handToSplit, uint32_t *bank, Deck *shoe, const Rules *rules);
+HandResult settle_hand(Hand *hand, uint8_t dealerCount, bool dealerBlackjack, const Rules *rules, uint32_t *bank,
+        uint32_t *payout);
+void clear_hands(Hand *hand);
+
+/********************
+ * INLINE FUNCTIONS *
+ ********************/
+// the checks that read the rules live here so a caller playing by constant rules, like the sim's specialized round
+// loops, has them inlined and folded away
+
+/***************
+ *  Summary: Check if the dealer has to take another card
+ *
+ *  Description: The dealer hits until reaching DEALER_STANDS_ON or more, and under H17 rules also hits a soft
+ *      DEALER_STANDS_ON. Loops that know their rules up front can call the S17 or H17 version directly.
+ *
+ *  Parameter(s):
+ *      dealerHand: the dealer's Hand struct
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      bool: true if the dealer hits
+ */
+static inline bool dealer_must_hit(Hand *dealerHand, const Rules *rules)
+{
+    return rules->hitSoft17 ? dealer_must_hit_h17(dealerHand) : dealer_must_hit_s17(dealerHand);
+}
+
+/***************
+ *  Summary: Check if a hand can be doubled down on
+ *
+ *  Description: Only the first two cards of a hand can be doubled on, and then only if the rules allow it for the
+ *      hand's count and, after a split, at all.
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct
+ *      bank: the player's money
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      bool: true if the hand can be doubled
+ */
+static inline bool can_double(Hand *hand, uint32_t bank, const Rules *rules)
+{
+    if (hand->cards == NULL || hand->cards->nextCard == NULL || hand->cards->nextCard->nextCard != NULL)
+    {
+        return false;
+    }
+    if (hand->splits > 0 && !rules->doubleAfterSplit)
+    {
+        return false;
+    }
+
+    switch (rules->doubleOn)
+    {
+        case DOUBLE_ANY_TWO:
+            break;
+        case DOUBLE_9_TO_11:
+            if (blackjack_count(*hand) < 9 || blackjack_count(*hand) > 11) return false;
+            break;
+        case DOUBLE_10_11:
+            if (blackjack_count(*hand) < 10 || blackjack_count(*hand) > 11) return false;
+            break;
+    }
+
+    return (hand->bet <= bank);
+}
+
+/***************
+ *  Summary: Check if a hand can be split
+ *
+ *  Description: Only a hand of exactly two cards of the same value can be split, the seat must have fewer hands than
+ *      the rules allow, and the player needs enough money to put the same bet on the new hand.
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct
+ *      bank: the player's money
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      bool: true if the hand can be split
+ */
+static inline bool can_split(Hand *hand, uint32_t bank, const Rules *rules)
+{
+    if (hand->cards == NULL || hand->cards->nextCard == NULL || hand->cards->nextCard->nextCard != NULL)
+    {
+        return false;
+    }
+
+    return (hand->cards->card->value == hand->cards->nextCard->card->value && hand->splits + 1 < rules->maxHands
+            && hand->bet < bank);
+}
+
+/***************
+ *  Summary: Check if a hand can be surrendered
+ *
+ *  Description: Late surrender: only the first two cards of a hand that hasn't been split, if the rules allow it.
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      bool: true if the hand can be surrendered
+ */
+static inline bool can_surrender(Hand *hand, const Rules *rules)
+{
+    if (!rules->surrender || hand->splits > 0)
+    {
+        return false;
+    }
+
+    return (hand->cards != NULL && hand->cards->nextCard != NULL && hand->cards->nextCard->nextCard == NULL);
+}
+
+/***************
+ *  Summary: Play a player's choice on a hand
+ *
+ *  Description: Stand ends the hand, hit deals a card and ends the hand on a bust, double down doubles the bet and
+ *      deals the one card allowed, split splits the hand in two, dealing a second card to each, and surrender gives
+ *      up the hand for half the bet back when it is settled.
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct being played
+ *      bank: the player's money
+ *      shoe: the shoe to deal from
+ *      choice: the PlayerChoice made
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      ChoiceResult: whether the hand goes on, is finished, or the choice wasn't allowed and nothing changed
+ */
+static inline ChoiceResult play_choice(Hand *hand, uint32_t *bank, Deck *shoe, PlayerChoice choice, const Rules *rules)
+{
+    switch (choice)
+    {
+        case STAND:
+            return HAND_FINISHED;
+        case HIT:
+            if (!deal_card(shoe, hand)) return CHOICE_REFUSED;
+            return (blackjack_count(*hand) > 21) ? HAND_FINISHED : HAND_CONTINUES;
+        case DOUBLE:
+            // the bet is doubled here, not by double_bet, so the rules are read inline
+            if (!can_deal(shoe, 1) || !can_double(hand, *bank, rules)) return CHOICE_REFUSED;
+            *bank -= hand->bet;
+            hand->bet *= 2;
+            deal_card(shoe, hand);
+            return HAND_FINISHED;
+        case SPLIT:
+            return split_hand(hand, bank, shoe, rules) ? HAND_CONTINUES : CHOICE_REFUSED;
+        case SURRENDER:
+            if (!can_surrender(hand, rules)) return CHOICE_REFUSED;
+            hand->surrendered = true;
+            return HAND_FINISHED;
+    }
+
+    return CHOICE_REFUSED;
+}
+
+#endif /* ENGINE_H_ */
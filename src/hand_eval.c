@@ -0,0 +1,395 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  hand_eval.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Batch hand evaluation. Each kernel works out, for a block of hands, the sum of the card values with
+ *               Aces as 11 and the number of Aces; counting every Ace as 1 gives the hard total, and the hand is soft
+ *               when it has an Ace and the hard total is 11 or less. The kernel is picked once from what the CPU
+ *               supports.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "hand_eval.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EVAL_X86 1
+#else
+#define EVAL_X86 0
+#endif
+
+/***********
+ * DEFINES *
+ ***********/
+typedef void (*EvalKernel)(HandEval *eval, uint32_t hands);
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static void eval_scalar(HandEval *eval, uint32_t hands);
+#if EVAL_X86
+static void eval_sse2(HandEval *eval, uint32_t hands) __attribute__((target("sse2")));
+static void eval_avx2(HandEval *eval, uint32_t hands) __attribute__((target("avx2")));
+#endif
+static EvalKernel pick_kernel(const char **name);
+
+/***************
+ *  Summary: Allocate a hand evaluator
+ *
+ *  Parameter(s):
+ *      capacity: the most hands evaluated at once
+ *
+ *  Returns:
+ *      eval: pointer to the HandEval struct or NULL if an error
+ */
+HandEval *hand_eval_new(uint32_t capacity)
+{
+    HandEval *eval = calloc(1, sizeof(HandEval));
+    if (eval == NULL)
+    {
+        zerror("Hand evaluator memory allocation failed.");
+        return NULL;
+    }
+
+    eval->capacity = capacity;
+    eval->stride = (capacity + EVAL_WIDTH - 1) / EVAL_WIDTH * EVAL_WIDTH;
+    eval->values = calloc((size_t) eval->stride * EVAL_MAX_CARDS, 1);
+    eval->numCards = calloc(eval->stride, 1);
+    eval->total = calloc(eval->stride, 1);
+    eval->soft = calloc(eval->stride, 1);
+    eval->bust = calloc(eval->stride, 1);
+    eval->blackjack = calloc(eval->stride, 1);
+    if (!eval->values || !eval->numCards || !eval->total || !eval->soft || !eval->bust || !eval->blackjack)
+    {
+        zerror("Hand evaluator arrays allocation failed for %u hands.", capacity);
+        hand_eval_free(eval);
+        return NULL;
+    }
+
+    return eval;
+}
+
+/***************
+ *  Summary: Free a hand evaluator
+ *
+ *  Parameter(s):
+ *      eval: the HandEval struct to free
+ *
+ *  Returns:
+ *      N/A
+ */
+void hand_eval_free(HandEval *eval)
+{
+    if (eval == NULL) return;
+
+    free(eval->values);
+    free(eval->numCards);
+    free(eval->total);
+    free(eval->soft);
+    free(eval->bust);
+    free(eval->blackjack);
+    free(eval);
+
+    return;
+}
+
+/***************
+ *  Summary: Empty the evaluator for the next batch of hands
+ *
+ *  Description: Only the rows and columns written since the last clear are zeroed.
+ *
+ *  Parameter(s):
+ *      eval: the HandEval struct
+ *
+ *  Returns:
+ *      N/A
+ */
+void hand_eval_clear(HandEval *eval)
+{
+    for (uint8_t card = 0; card < eval->maxCards; card++)
+    {
+        memset(&eval->values[(size_t) card * eval->stride], 0, eval->count);
+    }
+    eval->count = 0;
+    eval->maxCards = 0;
+
+    return;
+}
+
+/***************
+ *  Summary: Add a hand to be evaluated
+ *
+ *  Parameter(s):
+ *      eval: the HandEval struct
+ *      hand: the Hand, whose cards are copied in as values
+ *
+ *  Returns:
+ *      bool: false if the evaluator is full or the hand has more cards than a hand can hold
+ */
+bool hand_eval_add(HandEval *eval, Hand *hand)
+{
+    if (eval->count == eval->capacity)
+    {
+        zerror("Hand evaluator is full at %u hands.", eval->capacity);
+        return false;
+    }
+
+    uint32_t column = eval->count;
+    uint8_t cards = 0;
+    for (CardList *card = hand->cards; card != NULL; card = card->nextCard)
+    {
+        if (cards == EVAL_MAX_CARDS)
+        {
+            zerror("Hand has more than %d cards.", EVAL_MAX_CARDS);
+            for (uint8_t row = 0; row < cards; row++)
+            {
+                eval->values[(size_t) row * eval->stride + column] = 0;
+            }
+            return false;
+        }
+        eval->values[(size_t) cards++ * eval->stride + column] = card->card->value;
+    }
+
+    eval->numCards[column] = cards;
+    if (cards > eval->maxCards) eval->maxCards = cards;
+    eval->count++;
+
+    return true;
+}
+
+/***************
+ *  Summary: Evaluate every hand added since the last clear
+ *
+ *  Description: Fills in total, soft, bust and blackjack for each hand, the same as blackjack_count, hand_is_soft and
+ *      is_blackjack would one hand at a time.
+ *
+ *  Parameter(s):
+ *      eval: the HandEval struct
+ *
+ *  Returns:
+ *      N/A
+ */
+void evaluate_hands(HandEval *eval)
+{
+    static EvalKernel kernel = NULL;
+    if (kernel == NULL) kernel = pick_kernel(NULL);
+
+    // the padding columns are all zero, so whole blocks can be evaluated
+    kernel(eval, (eval->count + EVAL_WIDTH - 1) / EVAL_WIDTH * EVAL_WIDTH);
+
+    return;
+}
+
+/***************
+ *  Summary: Return the name of the kernel evaluate_hands uses
+ *
+ *  Returns:
+ *      name: "avx2", "sse2" or "scalar"
+ */
+const char *hand_eval_kernel(void)
+{
+    const char *name;
+    pick_kernel(&name);
+
+    return name;
+}
+
+/***************
+ *  Summary: Pick the widest kernel the CPU supports
+ *
+ *  Parameter(s):
+ *      name: set to the kernel's name, can be NULL
+ *
+ *  Returns:
+ *      kernel: the EvalKernel to use
+ */
+static EvalKernel pick_kernel(const char **name)
+{
+    const char *kernelName = "scalar";
+    EvalKernel kernel = eval_scalar;
+
+#if EVAL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernelName = "avx2";
+        kernel = eval_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        kernelName = "sse2";
+        kernel = eval_sse2;
+    }
+#endif
+
+    if (name) *name = kernelName;
+    return kernel;
+}
+
+/***************
+ *  Summary: Evaluate hands one at a time, for CPUs without a vector kernel
+ *
+ *  Parameter(s):
+ *      eval: the HandEval struct
+ *      hands: the number of columns to evaluate
+ *
+ *  Returns:
+ *      N/A
+ */
+static void eval_scalar(HandEval *eval, uint32_t hands)
+{
+    for (uint32_t hand = 0; hand < hands; hand++)
+    {
+        uint8_t sum = 0;
+        uint8_t aces = 0;
+        for (uint8_t card = 0; card < eval->maxCards; card++)
+        {
+            uint8_t value = eval->values[(size_t) card * eval->stride + hand];
+            sum += value;
+            aces += (value == 11);
+        }
+
+        uint8_t hard = sum - 10 * aces;
+        uint8_t soft = (aces > 0) & (hard <= 11);
+        uint8_t total = hard + 10 * soft;
+        eval->total[hand] = total;
+        eval->soft[hand] = soft;
+        eval->bust[hand] = (total > 21);
+        eval->blackjack[hand] = (eval->numCards[hand] == 2) & (total == 21);
+    }
+
+    return;
+}
+
+#if EVAL_X86
+/***************
+ *  Summary: Evaluate 16 hands at a time with SSE2
+ *
+ *  Description: All the arithmetic is on bytes; 21 Aces and a ten, the most a hand can hold, sum to 241 so nothing
+ *      wraps. There are no byte compares for greater or less than on unsigned values, so x <= limit is done as
+ *      min(x, limit) == x.
+ *
+ *  Parameter(s):
+ *      eval: the HandEval struct
+ *      hands: the number of columns to evaluate, a multiple of 16
+ *
+ *  Returns:
+ *      N/A
+ */
+__attribute__((target("sse2"))) static void eval_sse2(HandEval *eval, uint32_t hands)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+    const __m128i ten = _mm_set1_epi8(10);
+    const __m128i eleven = _mm_set1_epi8(11);
+    const __m128i twentyOne = _mm_set1_epi8(21);
+
+    for (uint32_t hand = 0; hand < hands; hand += 16)
+    {
+        __m128i sum = zero;
+        __m128i aces = zero;
+        for (uint8_t card = 0; card < eval->maxCards; card++)
+        {
+            __m128i value = _mm_loadu_si128((const __m128i *) &eval->values[(size_t) card * eval->stride + hand]);
+            sum = _mm_add_epi8(sum, value);
+            aces = _mm_sub_epi8(aces, _mm_cmpeq_epi8(value, eleven));   // a match is -1
+        }
+
+        __m128i aces2 = _mm_add_epi8(aces, aces);
+        __m128i aces8 = _mm_add_epi8(_mm_add_epi8(aces2, aces2), _mm_add_epi8(aces2, aces2));
+        __m128i hard = _mm_sub_epi8(sum, _mm_add_epi8(aces8, aces2));
+        __m128i soft = _mm_andnot_si128(_mm_cmpeq_epi8(aces, zero), _mm_cmpeq_epi8(_mm_min_epu8(hard, eleven), hard));
+        __m128i total = _mm_add_epi8(hard, _mm_and_si128(soft, ten));
+        __m128i notBust = _mm_cmpeq_epi8(_mm_min_epu8(total, twentyOne), total);
+        __m128i twoCards = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) &eval->numCards[hand]), two);
+        __m128i blackjack = _mm_and_si128(twoCards, _mm_cmpeq_epi8(total, twentyOne));
+
+        _mm_storeu_si128((__m128i *) &eval->total[hand], total);
+        _mm_storeu_si128((__m128i *) &eval->soft[hand], _mm_and_si128(soft, one));
+        _mm_storeu_si128((__m128i *) &eval->bust[hand], _mm_andnot_si128(notBust, one));
+        _mm_storeu_si128((__m128i *) &eval->blackjack[hand], _mm_and_si128(blackjack, one));
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Evaluate 32 hands at a time with AVX2
+ *
+ *  Description: The same steps as eval_sse2 on registers twice as wide.
+ *
+ *  Parameter(s):
+ *      eval: the HandEval struct
+ *      hands: the number of columns to evaluate, a multiple of 32
+ *
+ *  Returns:
+ *      N/A
+ */
+__attribute__((target("avx2"))) static void eval_avx2(HandEval *eval, uint32_t hands)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+    const __m256i ten = _mm256_set1_epi8(10);
+    const __m256i eleven = _mm256_set1_epi8(11);
+    const __m256i twentyOne = _mm256_set1_epi8(21);
+
+    for (uint32_t hand = 0; hand < hands; hand += 32)
+    {
+        __m256i sum = zero;
+        __m256i aces = zero;
+        for (uint8_t card = 0; card < eval->maxCards; card++)
+        {
+            __m256i value = _mm256_loadu_si256((const __m256i *) &eval->values[(size_t) card * eval->stride + hand]);
+            sum = _mm256_add_epi8(sum, value);
+            aces = _mm256_sub_epi8(aces, _mm256_cmpeq_epi8(value, eleven));
+        }
+
+        __m256i aces2 = _mm256_add_epi8(aces, aces);
+        __m256i aces8 = _mm256_add_epi8(_mm256_add_epi8(aces2, aces2), _mm256_add_epi8(aces2, aces2));
+        __m256i hard = _mm256_sub_epi8(sum, _mm256_add_epi8(aces8, aces2));
+        __m256i soft = _mm256_andnot_si256(_mm256_cmpeq_epi8(aces, zero),
+                _mm256_cmpeq_epi8(_mm256_min_epu8(hard, eleven), hard));
+        __m256i total = _mm256_add_epi8(hard, _mm256_and_si256(soft, ten));
+        __m256i notBust = _mm256_cmpeq_epi8(_mm256_min_epu8(total, twentyOne), total);
+        __m256i twoCards = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) &eval->numCards[hand]), two);
+        __m256i blackjack = _mm256_and_si256(twoCards, _mm256_cmpeq_epi8(total, twentyOne));
+
+        _mm256_storeu_si256((__m256i *) &eval->total[hand], total);
+        _mm256_storeu_si256((__m256i *) &eval->soft[hand], _mm256_and_si256(soft, one));
+        _mm256_storeu_si256((__m256i *) &eval->bust[hand], _mm256_andnot_si256(notBust, one));
+        _mm256_storeu_si256((__m256i *) &eval->blackjack[hand], _mm256_and_si256(blackjack, one));
+    }
+
+    return;
+}
+#endif
@@ -0,0 +1,80 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  hand_eval.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Evaluates the totals, soft flags, busts and blackjacks of many hands at once. The card values are
+ *               kept column by column, one row per card position, so a vector register holds the same card of 16 or
+ *               32 hands. Uses AVX2 or SSE2 when the CPU has them and plain C otherwise.
+ */
+
+#ifndef HAND_EVAL_H_
+#define HAND_EVAL_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "deck_of_cards.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define EVAL_MAX_CARDS MAX_HAND_CARDS   // from a multi-deck shoe, eight Aces and four 2s are still a hard 16
+#define EVAL_WIDTH 32           // hands per AVX2 register; the arrays are padded to a multiple of it
+
+typedef struct HandEval
+{
+    uint32_t capacity;
+    uint32_t count;             // hands added since the last clear
+    uint32_t stride;            // capacity rounded up to EVAL_WIDTH, the length of each row
+    uint8_t maxCards;           // cards in the longest hand added, the rows evaluated
+    uint8_t *values;            // values[card * stride + hand], Aces as 11 and 0 past the end of a hand
+    uint8_t *numCards;
+    uint8_t *total;             // filled in by evaluate_hands, as are the rest
+    uint8_t *soft;
+    uint8_t *bust;
+    uint8_t *blackjack;         // two card 21
+} HandEval;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+HandEval *hand_eval_new(uint32_t capacity);
+void hand_eval_free(HandEval *eval);
+void hand_eval_clear(HandEval *eval);
+bool hand_eval_add(HandEval *eval, Hand *hand);
+void evaluate_hands(HandEval *eval);
+const char *hand_eval_kernel(void);
+
+#endif /* HAND_EVAL_H_ */
@@ -0,0 +1,367 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  screen.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The screen layout behind layout.h. The geometry is kept in one Layout for the whole program, like
+ *               curses' own stdscr, since there is only ever one screen to lay out.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "layout.h"
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "curses_output.h"
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+static Layout screen;
+static bool opened = false;
+static volatile sig_atomic_t resizePending = 0;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static void apply_layout(int16_t lines, int16_t cols, uint8_t numSeats);
+static void place_pane(Pane *pane, int16_t y, int16_t x, int16_t lines, int16_t cols, int16_t maxLines,
+        int16_t maxCols);
+static void open_pane(Pane *pane);
+static void close_pane(Pane *pane);
+static void move_messages(WINDOW *win, const Pane *pane);
+static void request_resize(int sig);
+
+/***************
+ *  Summary: Lay out the screen for a table
+ *
+ *  Description: The first call catches SIGWINCH, in place of curses' own handler, and creates the panes' windows;
+ *      after that it only lays the seats out again. Call it after initscr.
+ *
+ *  Parameter(s):
+ *      numSeats: the seats at the table, 1 to LAYOUT_MAX_SEATS
+ *
+ *  Returns:
+ *      screen: the screen's Layout
+ */
+Layout *layout_open(uint8_t numSeats)
+{
+    if (opened)
+    {
+        layout_seats(numSeats);
+        return &screen;
+    }
+
+    struct sigaction action = {.sa_handler = request_resize};
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;    // no SA_RESTART, so a wgetch waiting for a key returns and the resize is seen at once
+    sigaction(SIGWINCH, &action, NULL);
+
+    int lines, cols;
+    getmaxyx(stdscr, lines, cols);
+    apply_layout(lines, cols, numSeats);
+    opened = true;
+
+    return &screen;
+}
+
+/***************
+ *  Summary: Lay the screen out for a different number of seats
+ *
+ *  Parameter(s):
+ *      numSeats: the seats at the table, 1 to LAYOUT_MAX_SEATS
+ *
+ *  Returns:
+ *      N/A
+ */
+void layout_seats(uint8_t numSeats)
+{
+    if (!opened || numSeats == screen.numSeats) return;
+
+    apply_layout(screen.lines, screen.cols, numSeats);
+
+    return;
+}
+
+/***************
+ *  Summary: Catch up with a terminal resize
+ *
+ *  Description: Does nothing unless a SIGWINCH has arrived since the last call, so it is cheap enough to call before
+ *      every redraw and after every key. Curses is told the new size and the geometry is worked out again; the
+ *      panes' windows are recreated with their contents lost, except the message window's, which keeps its latest
+ *      lines.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      bool: true if the layout changed and every pane has to be drawn again
+ */
+bool layout_resized(void)
+{
+    if (!resizePending || !opened) return false;
+    resizePending = 0;
+
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0)
+    {
+        resize_term(size.ws_row, size.ws_col);     // unlike resizeterm, doesn't queue a KEY_RESIZE for wgetch
+        clearok(curscr, TRUE);
+    }
+
+    int lines, cols;
+    getmaxyx(stdscr, lines, cols);
+    if (lines == screen.lines && cols == screen.cols) return false;
+
+    zinfo("Terminal resized to %d x %d.", cols, lines);
+    apply_layout(lines, cols, screen.numSeats);
+    return true;
+}
+
+/***************
+ *  Summary: Delete the panes' windows
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void layout_close(void)
+{
+    if (!opened) return;
+
+    close_pane(&screen.dealer);
+    for (uint8_t seat = 0; seat < LAYOUT_MAX_SEATS; seat++)
+    {
+        close_pane(&screen.seats[seat]);
+    }
+    close_pane(&screen.border);
+    close_pane(&screen.message);
+    opened = false;
+
+    return;
+}
+
+/***************
+ *  Summary: Work out the geometry for a terminal size
+ *
+ *  Description: The seats go in as few rows as the width allows, each row centred. The message window gets its usual
+ *      height if there's room below the seats, otherwise what room there is, down to a single line. Panes are cut
+ *      off at the edge of the screen, or left out if they start past it; the message window always has at least a
+ *      line and a column. No windows are touched.
+ *
+ *  Parameter(s):
+ *      layout: the Layout to fill in; its windows are left alone
+ *      lines: the terminal's height
+ *      cols: the terminal's width
+ *      numSeats: the seats at the table, clamped to 1 to LAYOUT_MAX_SEATS
+ *
+ *  Returns:
+ *      N/A
+ */
+void layout_compute(Layout *layout, int16_t lines, int16_t cols, uint8_t numSeats)
+{
+    if (numSeats < 1) numSeats = 1;
+    if (numSeats > LAYOUT_MAX_SEATS) numSeats = LAYOUT_MAX_SEATS;
+    layout->lines = lines;
+    layout->cols = cols;
+    layout->numSeats = numSeats;
+
+    place_pane(&layout->dealer, 0, (cols - PLAYER_WINDOW_COLS) / 2, PLAYER_WINDOW_LINE, PLAYER_WINDOW_COLS, lines,
+            cols);
+
+    int16_t perRow = (cols + LAYOUT_GAP) / (PLAYER_WINDOW_COLS + LAYOUT_GAP);
+    if (perRow < 1) perRow = 1;
+    if (perRow > numSeats) perRow = numSeats;
+    int16_t rows = (numSeats + perRow - 1) / perRow;
+    for (uint8_t seat = 0; seat < LAYOUT_MAX_SEATS; seat++)
+    {
+        if (seat >= numSeats)
+        {
+            place_pane(&layout->seats[seat], 0, 0, 0, 0, lines, cols);
+            continue;
+        }
+
+        int16_t row = seat / perRow;
+        int16_t inRow = (numSeats - row * perRow < perRow) ? numSeats - row * perRow : perRow;
+        int16_t rowX = (cols - (inRow * PLAYER_WINDOW_COLS + (inRow - 1) * LAYOUT_GAP)) / 2;
+        place_pane(&layout->seats[seat], PLAYER_WINDOW_LINE + 1 + row * PLAYER_WINDOW_LINE,
+                ((rowX > 0) ? rowX : 0) + (seat % perRow) * (PLAYER_WINDOW_COLS + LAYOUT_GAP), PLAYER_WINDOW_LINE,
+                PLAYER_WINDOW_COLS, lines, cols);
+    }
+
+    int16_t seatsEnd = PLAYER_WINDOW_LINE + 1 + rows * PLAYER_WINDOW_LINE;
+    int16_t msgLines = (lines < LAYOUT_TALL) ? LAYOUT_MSG_LINES : LAYOUT_MSG_LINES_TALL;
+    int16_t room = lines - seatsEnd - 2 * LAYOUT_MSG_MARGIN;
+    if (msgLines > room) msgLines = (room > 1) ? room : 1;
+    int16_t msgY = lines - LAYOUT_MSG_MARGIN - msgLines;
+    int16_t msgCols = cols - 2 * LAYOUT_MSG_MARGIN;
+    place_pane(&layout->border, msgY - LAYOUT_MSG_MARGIN, 0, msgLines + 2 * LAYOUT_MSG_MARGIN, cols, lines, cols);
+    place_pane(&layout->message, (msgY > 0) ? msgY : 0, LAYOUT_MSG_MARGIN, msgLines, (msgCols > 1) ? msgCols : 1,
+            lines, cols);
+    if (layout->message.lines == 0)
+    {
+        place_pane(&layout->message, (lines > 1) ? lines - 1 : 0, 0, 1, (cols > 1) ? cols : 1, lines, cols);
+        layout->message.lines = 1;
+        layout->message.cols = (cols > 1) ? cols : 1;
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Make the windows match freshly worked out geometry
+ *
+ *  Parameter(s):
+ *      lines: the terminal's height
+ *      cols: the terminal's width
+ *      numSeats: the seats at the table
+ *
+ *  Returns:
+ *      N/A
+ */
+static void apply_layout(int16_t lines, int16_t cols, uint8_t numSeats)
+{
+    Layout next = {0};
+    layout_compute(&next, lines, cols, numSeats);
+
+    close_pane(&screen.dealer);
+    screen.dealer = next.dealer;
+    open_pane(&screen.dealer);
+    for (uint8_t seat = 0; seat < LAYOUT_MAX_SEATS; seat++)
+    {
+        close_pane(&screen.seats[seat]);
+        screen.seats[seat] = next.seats[seat];
+        open_pane(&screen.seats[seat]);
+    }
+    close_pane(&screen.border);
+    screen.border = next.border;
+    open_pane(&screen.border);
+
+    WINDOW *messages = screen.message.win;
+    screen.message = next.message;
+    if (messages)
+    {
+        move_messages(messages, &screen.message);
+        screen.message.win = messages;
+    }
+    else
+    {
+        open_pane(&screen.message);
+    }
+
+    screen.lines = lines;
+    screen.cols = cols;
+    screen.numSeats = next.numSeats;
+    screen.borderDrawn = false;
+
+    return;
+}
+
+static void place_pane(Pane *pane, int16_t y, int16_t x, int16_t lines, int16_t cols, int16_t maxLines,
+        int16_t maxCols)
+{
+    if (y < 0)
+    {
+        lines += y;
+        y = 0;
+    }
+    if (x < 0)
+    {
+        cols += x;
+        x = 0;
+    }
+    if (lines > maxLines - y) lines = maxLines - y;
+    if (cols > maxCols - x) cols = maxCols - x;
+
+    *pane = (Pane) {.y = y, .x = x, .lines = (lines > 0 && cols > 0) ? lines : 0,
+            .cols = (lines > 0 && cols > 0) ? cols : 0, .win = NULL};
+
+    return;
+}
+
+static void open_pane(Pane *pane)
+{
+    pane->win = (pane->lines > 0) ? newwin(pane->lines, pane->cols, pane->y, pane->x) : NULL;
+    if (pane->win) leaveok(pane->win, TRUE);    // the cursor is hidden, so don't spend bytes putting it back
+
+    return;
+}
+
+static void close_pane(Pane *pane)
+{
+    if (pane->win) delwin(pane->win);
+    pane->win = NULL;
+
+    return;
+}
+
+/***************
+ *  Summary: Move and resize the message window, keeping its latest lines
+ *
+ *  Description: Messages scroll up from the bottom line, so lines are taken off or added at the top before the
+ *      window is resized.
+ *
+ *  Parameter(s):
+ *      win: the message window
+ *      pane: where it goes now
+ *
+ *  Returns:
+ *      N/A
+ */
+static void move_messages(WINDOW *win, const Pane *pane)
+{
+    int shift = getmaxy(win) - pane->lines;
+
+    if (shift > 0)
+    {
+        wmove(win, 0, 0);
+        winsdelln(win, -shift);
+    }
+    wresize(win, pane->lines, pane->cols);
+    if (shift < 0)
+    {
+        wmove(win, 0, 0);
+        winsdelln(win, -shift);
+    }
+    mvwin(win, pane->y, pane->x);
+
+    return;
+}
+
+static void request_resize(int sig)
+{
+    (void) sig;
+    resizePending = 1;
+}
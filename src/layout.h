@@ -0,0 +1,90 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  layout.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Where each pane of the table goes on the screen: the dealer centred at the top, up to seven seats in
+ *               rows under it, wrapping when the terminal is too narrow, and the message window with its border along
+ *               the bottom. The geometry is worked out once for a terminal size and the panes' windows are kept
+ *               between rounds; a SIGWINCH only sets a flag, and the next layout_resized works out the new geometry.
+ */
+
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <ncurses.h>
+
+/***********
+ * DEFINES *
+ ***********/
+#define LAYOUT_MAX_SEATS 7
+#define LAYOUT_GAP 1                // columns between the seats in a row
+#define LAYOUT_MSG_MARGIN 2         // from the message window to the outside of its border
+#define LAYOUT_MSG_LINES 5          // message lines on a short terminal
+#define LAYOUT_MSG_LINES_TALL 10    // and on one of LAYOUT_TALL lines or more
+#define LAYOUT_TALL 30
+
+typedef struct Pane
+{
+    int16_t y;
+    int16_t x;
+    int16_t lines;                  // 0 if the pane doesn't fit on the screen at all
+    int16_t cols;
+    WINDOW *win;                    // NULL while the pane doesn't fit
+} Pane;
+
+typedef struct Layout
+{
+    int16_t lines;                  // the terminal size the geometry was worked out for
+    int16_t cols;
+    uint8_t numSeats;
+    Pane dealer;
+    Pane seats[LAYOUT_MAX_SEATS];
+    Pane border;                    // the box around the messages
+    Pane message;                   // its window is moved and resized rather than replaced, so it can be held on to
+    bool borderDrawn;               // false until the border has been drawn since the geometry last changed
+} Layout;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+Layout *layout_open(uint8_t numSeats);
+void layout_seats(uint8_t numSeats);
+bool layout_resized(void);
+void layout_close(void);
+void layout_compute(Layout *layout, int16_t lines, int16_t cols, uint8_t numSeats);
+
+#endif /* LAYOUT_H_ */
@@ -0,0 +1,275 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  live_stats.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The shared memory segment behind live_stats.h. A writer opens it as /blackjack-<pid>, sized for its
+ *               slots, and unlinks it when it closes; readers map it read only.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "live_stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+
+/****************
+ * DECLARATIONS *
+ ****************/
+
+/***************
+ *  Summary: Create the segment for this process
+ *
+ *  Description: A segment left behind by an earlier process with the same pid is replaced. The magic number is
+ *      stored last, so a reader that attaches while the header is being filled in skips the segment.
+ *
+ *  Parameter(s):
+ *      program: short name of the program publishing, shown by blackjack_top
+ *      numSlots: the number of writer threads, each publishes to its own slot
+ *
+ *  Returns:
+ *      live: pointer to the LiveStats struct or NULL if an error
+ */
+LiveStats *live_stats_open(const char *program, uint16_t numSlots)
+{
+    LiveStats *live = calloc(1, sizeof(LiveStats));
+    LiveWriter *writers = calloc(numSlots, sizeof(LiveWriter));
+    if (live == NULL || writers == NULL || numSlots == 0)
+    {
+        zerror("Couldn't allocate memory for live stats.");
+        free(live);
+        free(writers);
+        return NULL;
+    }
+
+    snprintf(live->name, sizeof(live->name), "/" LIVE_STATS_PREFIX "%ld", (long) getpid());
+    int fd = shm_open(live->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST)
+    {
+        shm_unlink(live->name);
+        fd = shm_open(live->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0)
+    {
+        zerror("Couldn't create live stats segment %s: %s", live->name, strerror(errno));
+        free(live);
+        free(writers);
+        return NULL;
+    }
+
+    // ftruncate zero fills, so every slot starts with an even sequence count and an empty sample
+    live->size = offsetof(LiveSegment, slots) + numSlots * sizeof(LiveSlot);
+    void *base = MAP_FAILED;
+    if (ftruncate(fd, live->size) == 0)
+    {
+        base = mmap(NULL, live->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        zerror("Couldn't map live stats segment %s: %s", live->name, strerror(errno));
+        shm_unlink(live->name);
+        free(live);
+        free(writers);
+        return NULL;
+    }
+
+    live->segment = base;
+    live->writers = writers;
+    clock_gettime(CLOCK_MONOTONIC, &live->opened);
+    live->segment->version = LIVE_STATS_VERSION;
+    live->segment->size = live->size;
+    live->segment->numSlots = numSlots;
+    live->segment->pid = getpid();
+    live->segment->started = time(NULL);
+    strncpy(live->segment->program, program, sizeof(live->segment->program) - 1);
+    __atomic_store_n(&live->segment->magic, LIVE_STATS_MAGIC, __ATOMIC_RELEASE);
+    zinfo("Publishing live stats in %s with %u slots.", live->name, numSlots);
+
+    return live;
+}
+
+/***************
+ *  Summary: Publish a writer's counts to its slot
+ *
+ *  Description: Only the slot's own writer thread may call this. Calls closer than LIVE_STATS_INTERVAL_NS to the
+ *      slot's last publish return straight away, so a worker can call it as often as it likes. The sequence count is
+ *      made odd before the sample is written and even again after, with the fences a reader's retry relies on.
+ *
+ *  Parameter(s):
+ *      live: the LiveStats struct, or NULL to publish nothing
+ *      slot: the writer's slot
+ *      sample: the writer's counts; seconds and handsPerSecond are filled in here
+ *
+ *  Returns:
+ *      N/A
+ */
+void live_stats_publish(LiveStats *live, uint16_t slot, const LiveSample *sample)
+{
+    if (live == NULL || slot >= live->segment->numSlots) return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double seconds = (now.tv_sec - live->opened.tv_sec) + (now.tv_nsec - live->opened.tv_nsec) / 1e9;
+    LiveWriter *writer = &live->writers[slot];
+    if (seconds - writer->seconds < LIVE_STATS_INTERVAL_NS / 1e9) return;
+
+    LiveSlot *target = &live->segment->slots[slot];
+    uint32_t seq = target->seq;
+    __atomic_store_n(&target->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    target->sample = *sample;
+    target->sample.seconds = seconds;
+    target->sample.handsPerSecond = (sample->hands - writer->hands) / (seconds - writer->seconds);
+    __atomic_store_n(&target->seq, seq + 2, __ATOMIC_RELEASE);
+
+    writer->hands = sample->hands;
+    writer->seconds = seconds;
+
+    return;
+}
+
+/***************
+ *  Summary: Remove the segment and free the LiveStats struct
+ *
+ *  Parameter(s):
+ *      live: the LiveStats struct, may be NULL
+ *
+ *  Returns:
+ *      N/A
+ */
+void live_stats_close(LiveStats *live)
+{
+    if (live == NULL) return;
+
+    munmap(live->segment, live->size);
+    shm_unlink(live->name);
+    free(live->writers);
+    free(live);
+
+    return;
+}
+
+/***************
+ *  Summary: Map another process's segment to read it
+ *
+ *  Parameter(s):
+ *      name: the segment's name, starting with /
+ *      size: set to the size mapped, for live_stats_detach
+ *
+ *  Returns:
+ *      segment: the mapped LiveSegment, read only, or NULL if it can't be opened or isn't a finished segment
+ */
+const LiveSegment *live_stats_attach(const char *name, size_t *size)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(LiveSegment))
+    {
+        base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    const LiveSegment *segment = base;
+    if (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != LIVE_STATS_MAGIC
+            || segment->version != LIVE_STATS_VERSION || segment->size != (uint32_t) st.st_size
+            || offsetof(LiveSegment, slots) + segment->numSlots * sizeof(LiveSlot) != (size_t) st.st_size)
+    {
+        munmap(base, st.st_size);
+        return NULL;
+    }
+
+    *size = st.st_size;
+    return segment;
+}
+
+/***************
+ *  Summary: Copy a consistent sample out of a slot
+ *
+ *  Description: Retries while the writer is part way through an update. The copy is only kept if the sequence
+ *      count was even before it and unchanged after.
+ *
+ *  Parameter(s):
+ *      segment: the attached LiveSegment
+ *      slot: the slot to read
+ *      sample: filled with the slot's sample
+ *
+ *  Returns:
+ *      bool: false if no consistent copy was made in LIVE_STATS_RETRIES tries
+ */
+bool live_stats_read(const LiveSegment *segment, uint16_t slot, LiveSample *sample)
+{
+    if (slot >= segment->numSlots) return false;
+
+    const LiveSlot *source = &segment->slots[slot];
+    for (uint16_t attempt = 0; attempt < LIVE_STATS_RETRIES; attempt++)
+    {
+        uint32_t before = __atomic_load_n(&source->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) continue;
+
+        memcpy(sample, &source->sample, sizeof(LiveSample));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&source->seq, __ATOMIC_RELAXED) == before) return true;
+    }
+
+    return false;
+}
+
+/***************
+ *  Summary: Unmap a segment mapped by live_stats_attach
+ *
+ *  Parameter(s):
+ *      segment: the LiveSegment
+ *      size: the size live_stats_attach mapped
+ *
+ *  Returns:
+ *      N/A
+ */
+void live_stats_detach(const LiveSegment *segment, size_t size)
+{
+    munmap((void *) segment, size);
+
+    return;
+}
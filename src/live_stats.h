@@ -0,0 +1,118 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  live_stats.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Live counters for a running sim or server, published in a POSIX shared memory segment that
+ *               blackjack_top reads. Each writer thread has its own slot guarded by a sequence count: the count is odd
+ *               while the writer is updating the slot, and a reader copies the slot and retries if the count was odd
+ *               or changed under it. Readers never write to the segment, so watching a run doesn't slow its workers.
+ */
+
+#ifndef LIVE_STATS_H_
+#define LIVE_STATS_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include "phase_timer.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define LIVE_STATS_PREFIX "blackjack-"      // segments are named /blackjack-<pid>, i.e. /dev/shm/blackjack-<pid>
+#define LIVE_STATS_MAGIC 0x534c4a42         // "BJLS"
+#define LIVE_STATS_VERSION 1
+#define LIVE_STATS_INTERVAL_NS 250000000    // a slot is published at most this often
+#define LIVE_STATS_RETRIES 1000             // reads of a slot before giving up on a writer that never settles
+#define LIVE_STATS_CACHE_LINE 64
+
+typedef struct LiveSample           // a writer's counts since it started
+{
+    uint64_t rounds;
+    uint64_t hands;
+    uint64_t wagered;
+    int64_t net;
+    double seconds;                 // since the segment was opened, set when published
+    double handsPerSecond;          // since the slot was last published, set when published
+    PhaseLatency phases[PHASE_COUNT];   // all zero unless built with TIMERS=1
+} LiveSample;
+
+typedef struct LiveSlot
+{
+    uint32_t seq;                   // odd while the writer is updating sample
+    LiveSample sample;
+} __attribute__((aligned(LIVE_STATS_CACHE_LINE))) LiveSlot;
+
+typedef struct LiveSegment          // the shared memory layout; everything before slots is written once
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                  // of the whole segment
+    uint16_t numSlots;
+    pid_t pid;
+    int64_t started;                // wall clock seconds
+    char program[16];
+    LiveSlot slots[];
+} LiveSegment;
+
+typedef struct LiveWriter           // a slot's last publish, private to its writer
+{
+    uint64_t hands;
+    double seconds;
+} LiveWriter;
+
+typedef struct LiveStats
+{
+    LiveSegment *segment;
+    size_t size;
+    char name[32];
+    struct timespec opened;
+    LiveWriter *writers;
+} LiveStats;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+LiveStats *live_stats_open(const char *program, uint16_t numSlots);
+void live_stats_publish(LiveStats *live, uint16_t slot, const LiveSample *sample);
+void live_stats_close(LiveStats *live);
+const LiveSegment *live_stats_attach(const char *name, size_t *size);
+bool live_stats_read(const LiveSegment *segment, uint16_t slot, LiveSample *sample);
+void live_stats_detach(const LiveSegment *segment, size_t size);
+
+#endif /* LIVE_STATS_H_ */
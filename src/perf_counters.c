@@ -0,0 +1,240 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  perf_counters.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Hardware performance counters through perf_event_open. Only user space is counted, which is what
+ *               the default perf_event_paranoid allows and all the game code does anyway.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#define _GNU_SOURCE
+
+#include "perf_counters.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+static const uint64_t eventConfigs[PERF_EVENTS] =
+{
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static const char *eventNames[PERF_EVENTS] = {"cycles", "instructions", "cache misses", "branch misses"};
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static int open_event(uint64_t config, int groupFd);
+
+/***************
+ *  Summary: Open and start the counters for the calling thread
+ *
+ *  Description: The first event that opens leads the group and the rest join it. Events that fail are logged and
+ *      left out, so a machine without a cache miss counter still reports cycles and instructions.
+ *
+ *  Parameter(s):
+ *      counters: the PerfCounters struct to fill in
+ *
+ *  Returns:
+ *      bool: true if at least one counter is running
+ */
+bool perf_counters_open(PerfCounters *counters)
+{
+    int leader = -1;
+    counters->numOpen = 0;
+
+    for (uint8_t event = 0; event < PERF_EVENTS; event++)
+    {
+        counters->fds[event] = open_event(eventConfigs[event], leader);
+        counters->slots[event] = -1;
+        if (counters->fds[event] == -1)
+        {
+            zinfo("Counter for %s not available: %s.", eventNames[event], strerror(errno));
+            continue;
+        }
+
+        if (leader == -1) leader = counters->fds[event];
+        counters->slots[event] = counters->numOpen++;
+    }
+
+    if (leader == -1) return false;
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    return true;
+}
+
+/***************
+ *  Summary: Read the current value of every counter
+ *
+ *  Description: Values are scaled up by enabled over running time in case the kernel had to multiplex the group
+ *      with other users of the PMU.
+ *
+ *  Parameter(s):
+ *      counters: the opened PerfCounters struct
+ *      values: filled with a count per PerfEvent, PERF_UNAVAILABLE for those not opened
+ *
+ *  Returns:
+ *      N/A
+ */
+void perf_counters_read(PerfCounters *counters, uint64_t values[PERF_EVENTS])
+{
+    // read_format with PERF_FORMAT_GROUP: nr, time enabled, time running, then a value per open event
+    uint64_t buffer[3 + PERF_EVENTS];
+    bool valid = false;
+
+    for (uint8_t event = 0; event < PERF_EVENTS; event++)
+    {
+        if (counters->slots[event] == 0)
+        {
+            valid = read(counters->fds[event], buffer, sizeof(buffer)) >= (ssize_t) (3 * sizeof(uint64_t));
+            break;
+        }
+    }
+
+    for (uint8_t event = 0; event < PERF_EVENTS; event++)
+    {
+        values[event] = PERF_UNAVAILABLE;
+        if (!valid || counters->slots[event] < 0) continue;
+
+        uint64_t value = buffer[3 + counters->slots[event]];
+        if (buffer[2] && buffer[2] < buffer[1])
+        {
+            value = (uint64_t) ((double) value * buffer[1] / buffer[2]);
+        }
+        values[event] = value;
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Close the counters
+ *
+ *  Parameter(s):
+ *      counters: the PerfCounters struct
+ *
+ *  Returns:
+ *      N/A
+ */
+void perf_counters_close(PerfCounters *counters)
+{
+    for (uint8_t event = 0; event < PERF_EVENTS; event++)
+    {
+        if (counters->fds[event] != -1) close(counters->fds[event]);
+        counters->fds[event] = -1;
+        counters->slots[event] = -1;
+    }
+    counters->numOpen = 0;
+
+    return;
+}
+
+/***************
+ *  Summary: Print the column headings for perf_counters_report
+ *
+ *  Parameter(s):
+ *      out: the stream to print to
+ *      title: heading for the label column
+ *
+ *  Returns:
+ *      N/A
+ */
+void perf_counters_header(FILE *out, const char *title)
+{
+    fprintf(out, "%-18s", title);
+    for (uint8_t event = 0; event < PERF_EVENTS; event++)
+    {
+        fprintf(out, " %14s", eventNames[event]);
+    }
+    fprintf(out, " %6s\n", "IPC");
+
+    return;
+}
+
+/***************
+ *  Summary: Print counter totals divided by a number of hands, rounds or passes
+ *
+ *  Parameter(s):
+ *      out: the stream to print to
+ *      label: what the line is for
+ *      values: counts per PerfEvent
+ *      per: what to divide the counts by
+ *
+ *  Returns:
+ *      N/A
+ */
+void perf_counters_report(FILE *out, const char *label, const uint64_t values[PERF_EVENTS], uint64_t per)
+{
+    fprintf(out, "%-18s", label);
+    for (uint8_t event = 0; event < PERF_EVENTS; event++)
+    {
+        if (values[event] == PERF_UNAVAILABLE || per == 0) fprintf(out, " %14s", "n/a");
+        else fprintf(out, " %14.1f", (double) values[event] / per);
+    }
+    if (values[PERF_CYCLES] != PERF_UNAVAILABLE && values[PERF_INSTRUCTIONS] != PERF_UNAVAILABLE
+            && values[PERF_CYCLES])
+    {
+        fprintf(out, " %6.2f", (double) values[PERF_INSTRUCTIONS] / values[PERF_CYCLES]);
+    }
+    else
+    {
+        fprintf(out, " %6s", "n/a");
+    }
+    fprintf(out, "\n");
+
+    return;
+}
+
+static int open_event(uint64_t config, int groupFd)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = groupFd == -1;  // the leader starts the whole group once it is complete
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
@@ -0,0 +1,71 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  perf_counters.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Hardware performance counters for the calling thread through perf_event_open. Cycles, instructions,
+ *               cache misses and branch misses are opened as one group so they are read together. Any of them can
+ *               be missing, e.g. in a VM or with perf_event_paranoid too high, and reads as PERF_UNAVAILABLE.
+ */
+
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/***********
+ * DEFINES *
+ ***********/
+#define PERF_UNAVAILABLE UINT64_MAX
+
+typedef enum PerfEvent
+{
+    PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_BRANCH_MISSES, PERF_EVENTS
+} PerfEvent;
+
+typedef struct PerfCounters
+{
+    int fds[PERF_EVENTS];       // -1 for an event that couldn't be opened
+    int8_t slots[PERF_EVENTS];  // position of each event in a group read, -1 if not opened
+    uint8_t numOpen;
+} PerfCounters;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+bool perf_counters_open(PerfCounters *counters);
+void perf_counters_read(PerfCounters *counters, uint64_t values[PERF_EVENTS]);
+void perf_counters_close(PerfCounters *counters);
+void perf_counters_header(FILE *out, const char *title);
+void perf_counters_report(FILE *out, const char *label, const uint64_t values[PERF_EVENTS], uint64_t per);
+
+#endif /* PERF_COUNTERS_H_ */
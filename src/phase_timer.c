@@ -0,0 +1,359 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  phase_timer.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Latency histograms for the phases of a round. Each phase has log-linear buckets of nanoseconds,
+ *               PHASE_SUB_BUCKETS per power of two, updated with relaxed atomics so any thread can record.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "phase_timer.h"
+
+static const char *phaseNames[PHASE_COUNT] =
+{
+    "shuffle", "get_bets", "deal_hands", "check_dealer_hand", "play_hands", "play_dealer_hand", "check_table",
+    "render", "input"
+};
+
+/***************
+ *  Summary: Name a phase
+ *
+ *  Description: Compiled with or without the timers, so a reader of published latencies can label them.
+ *
+ *  Parameter(s):
+ *      phase: the Phase
+ *
+ *  Returns:
+ *      name: the phase's name as the report shows it
+ */
+const char *phase_name(Phase phase)
+{
+    return (phase < PHASE_COUNT) ? phaseNames[phase] : "unknown";
+}
+
+#if PHASE_TIMERS
+
+#include <signal.h>
+#include <time.h>
+#include <stdbool.h>
+
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+typedef struct PhaseHistogram
+{
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+    uint64_t buckets[PHASE_BUCKETS];
+    uint64_t events[PERF_EVENTS];
+} PhaseHistogram;
+
+static PhaseHistogram histograms[PHASE_COUNT];
+static PerfCounters *phaseCounters = NULL;
+static volatile sig_atomic_t dumpRequested = 0;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static uint64_t phase_clock(void);
+static uint16_t bucket_index(uint64_t ns);
+static uint64_t bucket_limit(uint16_t bucket);
+static uint64_t percentile(PhaseHistogram *histogram, uint64_t count, double fraction);
+static void request_dump(int sig);
+
+/***************
+ *  Summary: Mark the start of a phase
+ *
+ *  Description: The counters are read before the clock so the read itself isn't in the phase's time.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      PhaseMark: the time and counter values at the start
+ */
+PhaseMark phase_mark(void)
+{
+    PhaseMark mark;
+    if (phaseCounters) perf_counters_read(phaseCounters, mark.events);
+    mark.ns = phase_clock();
+
+    return mark;
+}
+
+/***************
+ *  Summary: Record the time taken by one pass through a phase
+ *
+ *  Description: With counters attached the difference in each since the start is added to the phase's totals.
+ *
+ *  Parameter(s):
+ *      phase: the Phase timed
+ *      start: the PhaseMark from the start of the pass
+ *
+ *  Returns:
+ *      N/A
+ */
+void phase_record(Phase phase, const PhaseMark *start)
+{
+    uint64_t ns = phase_clock() - start->ns;
+    PhaseHistogram *histogram = &histograms[phase];
+
+    if (phaseCounters)
+    {
+        uint64_t events[PERF_EVENTS];
+        perf_counters_read(phaseCounters, events);
+        for (uint8_t event = 0; event < PERF_EVENTS; event++)
+        {
+            if (events[event] == PERF_UNAVAILABLE || start->events[event] == PERF_UNAVAILABLE) continue;
+            __atomic_fetch_add(&histogram->events[event], events[event] - start->events[event], __ATOMIC_RELAXED);
+        }
+    }
+
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->total, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->buckets[bucket_index(ns)], 1, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&histogram->max, &max, ns, true, __ATOMIC_RELAXED,
+            __ATOMIC_RELAXED));
+
+    return;
+}
+
+/***************
+ *  Summary: Write the latency of every phase
+ *
+ *  Description: One line per phase timed at least once, with the count, mean, p50, p90, p99 and max. Percentiles are
+ *      the upper limit of the bucket they fall in. With out NULL the report goes to the log instead.
+ *
+ *  Parameter(s):
+ *      out: the stream to write to, or NULL for the log
+ *
+ *  Returns:
+ *      N/A
+ */
+void phase_report(FILE *out)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%-18s %10s %10s %10s %10s %10s %10s", "phase (us)", "count", "mean", "p50", "p90",
+            "p99", "max");
+    if (out) fprintf(out, "%s\n", line);
+    else zinfo("%s", line);
+
+    for (uint8_t phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        PhaseHistogram *histogram = &histograms[phase];
+        uint64_t count = __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+        if (count == 0) continue;
+
+        snprintf(line, sizeof(line), "%-18s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f", phaseNames[phase],
+                (unsigned long long) count, histogram->total / 1e3 / count,
+                percentile(histogram, count, 0.50) / 1e3, percentile(histogram, count, 0.90) / 1e3,
+                percentile(histogram, count, 0.99) / 1e3, histogram->max / 1e3);
+        if (out) fprintf(out, "%s\n", line);
+        else zinfo("%s", line);
+    }
+
+    if (phaseCounters && out)
+    {
+        perf_counters_header(out, "phase (per pass)");
+        for (uint8_t phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            uint64_t count = __atomic_load_n(&histograms[phase].count, __ATOMIC_RELAXED);
+            if (count == 0) continue;
+
+            uint64_t events[PERF_EVENTS];
+            for (uint8_t event = 0; event < PERF_EVENTS; event++)
+            {
+                events[event] = phaseCounters->slots[event] < 0 ? PERF_UNAVAILABLE
+                        : __atomic_load_n(&histograms[phase].events[event], __ATOMIC_RELAXED);
+            }
+            perf_counters_report(out, phaseNames[phase], events, count);
+        }
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Count hardware events in every phase
+ *
+ *  Description: The counters belong to the thread that opened them, so only phases run on that thread should be
+ *      timed while they're attached. Reading them costs a system call at each end of a phase.
+ *
+ *  Parameter(s):
+ *      counters: opened PerfCounters, or NULL to stop counting
+ *
+ *  Returns:
+ *      N/A
+ */
+void phase_count_events(PerfCounters *counters)
+{
+    phaseCounters = counters;
+
+    return;
+}
+
+/***************
+ *  Summary: Dump the report when a signal arrives
+ *
+ *  Description: The handler only sets a flag; the report is written by the next phase_poll, outside the handler.
+ *
+ *  Parameter(s):
+ *      sig: the signal to dump on, e.g. SIGUSR1
+ *
+ *  Returns:
+ *      N/A
+ */
+void phase_dump_on(int sig)
+{
+    struct sigaction action = {.sa_handler = request_dump};
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(sig, &action, NULL);
+
+    return;
+}
+
+/***************
+ *  Summary: Write the report if a signal asked for it
+ *
+ *  Parameter(s):
+ *      out: the stream to write to, or NULL for the log
+ *
+ *  Returns:
+ *      N/A
+ */
+void phase_poll(FILE *out)
+{
+    if (dumpRequested)
+    {
+        dumpRequested = 0;
+        phase_report(out);
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Take the latency of every phase so far
+ *
+ *  Description: Read with relaxed atomics like phase_report, so the numbers are close but not a consistent cut if
+ *      another thread is recording at the same time.
+ *
+ *  Parameter(s):
+ *      latencies: filled with one PhaseLatency per Phase, all zero for a phase never timed
+ *
+ *  Returns:
+ *      N/A
+ */
+void phase_latencies(PhaseLatency latencies[PHASE_COUNT])
+{
+    for (uint8_t phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        PhaseHistogram *histogram = &histograms[phase];
+        uint64_t count = __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+
+        latencies[phase] = (PhaseLatency) {.count = count};
+        if (count == 0) continue;
+        latencies[phase].meanNs = __atomic_load_n(&histogram->total, __ATOMIC_RELAXED) / count;
+        latencies[phase].p50Ns = percentile(histogram, count, 0.50);
+        latencies[phase].p99Ns = percentile(histogram, count, 0.99);
+    }
+
+    return;
+}
+
+static uint64_t phase_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void request_dump(int sig)
+{
+    (void) sig;
+    dumpRequested = 1;
+}
+
+/***************
+ *  Summary: Find the bucket for a time
+ *
+ *  Description: Times below PHASE_SUB_BUCKETS ns get a bucket each; above that the top bits give the power of two
+ *      and the next bits the sub-bucket within it.
+ *
+ *  Parameter(s):
+ *      ns: the time in nanoseconds
+ *
+ *  Returns:
+ *      bucket: index into the histogram's buckets
+ */
+static uint16_t bucket_index(uint64_t ns)
+{
+    if (ns < PHASE_SUB_BUCKETS) return ns;
+
+    uint8_t power = 63 - __builtin_clzll(ns);
+    uint8_t sub = (ns >> (power - 2)) & (PHASE_SUB_BUCKETS - 1);
+    return power * PHASE_SUB_BUCKETS + sub;
+}
+
+static uint64_t bucket_limit(uint16_t bucket)
+{
+    if (bucket < PHASE_SUB_BUCKETS) return bucket;
+
+    uint8_t power = bucket / PHASE_SUB_BUCKETS;
+    uint64_t sub = bucket % PHASE_SUB_BUCKETS;
+    return ((PHASE_SUB_BUCKETS + sub + 1) << (power - 2)) - 1;
+}
+
+static uint64_t percentile(PhaseHistogram *histogram, uint64_t count, double fraction)
+{
+    uint64_t target = (uint64_t) (count * fraction);
+    uint64_t seen = 0;
+
+    for (uint16_t bucket = 0; bucket < PHASE_BUCKETS; bucket++)
+    {
+        seen += __atomic_load_n(&histogram->buckets[bucket], __ATOMIC_RELAXED);
+        if (seen > target) return bucket_limit(bucket);
+    }
+
+    return histogram->max;
+}
+
+#endif /* PHASE_TIMERS */
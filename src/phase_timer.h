@@ -0,0 +1,109 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  phase_timer.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Timers around the phases of a round, feeding a latency histogram per phase. Build with
+ *               TIMERS=1 (-DPHASE_TIMERS=1) to turn them on; otherwise the macros below expand to nothing and none
+ *               of the timer code is compiled. Given hardware counters with PHASE_COUNT_EVENTS, each phase also
+ *               totals the counter deltas across it.
+ */
+
+#ifndef PHASE_TIMER_H_
+#define PHASE_TIMER_H_
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdio.h>
+
+/***********
+ * DEFINES *
+ ***********/
+#ifndef PHASE_TIMERS
+#define PHASE_TIMERS 0
+#endif
+
+#define PHASE_SUB_BUCKETS 4     // buckets per power of two, so percentiles are within 19%
+#define PHASE_BUCKETS (64 * PHASE_SUB_BUCKETS)
+
+typedef enum Phase
+{
+    PHASE_SHUFFLE, PHASE_BETS, PHASE_DEAL, PHASE_DEALER_CHECK, PHASE_PLAY_HANDS, PHASE_DEALER_HAND, PHASE_SETTLE,
+    PHASE_RENDER, PHASE_INPUT, PHASE_COUNT
+} Phase;
+
+typedef struct PhaseLatency         // a phase's latency so far, as published for live monitoring
+{
+    uint64_t count;
+    uint64_t meanNs;
+    uint64_t p50Ns;
+    uint64_t p99Ns;
+} PhaseLatency;
+
+#if PHASE_TIMERS
+#include "perf_counters.h"
+
+typedef struct PhaseMark
+{
+    uint64_t ns;
+    uint64_t events[PERF_EVENTS];
+} PhaseMark;
+
+#define PHASE_START(timer) PhaseMark timer = phase_mark()
+#define PHASE_END(phase, timer) phase_record((phase), &(timer))
+#define PHASE_POLL(out) phase_poll(out)
+#define PHASE_REPORT(out) phase_report(out)
+#define PHASE_DUMP_ON(sig) phase_dump_on(sig)
+#define PHASE_COUNT_EVENTS(counters) phase_count_events(counters)
+#define PHASE_LATENCIES(latencies) phase_latencies(latencies)
+#else
+#define PHASE_START(timer) do {} while (0)
+#define PHASE_END(phase, timer) do {} while (0)
+#define PHASE_POLL(out) do {} while (0)
+#define PHASE_REPORT(out) do {} while (0)
+#define PHASE_DUMP_ON(sig) do {} while (0)
+#define PHASE_COUNT_EVENTS(counters) do {} while (0)
+#define PHASE_LATENCIES(latencies) do {} while (0)
+#endif
+
+/****************
+ * DECLARATIONS *
+ ****************/
+const char *phase_name(Phase phase);
+#if PHASE_TIMERS
+PhaseMark phase_mark(void);
+void phase_record(Phase phase, const PhaseMark *start);
+void phase_count_events(PerfCounters *counters);
+void phase_report(FILE *out);
+void phase_dump_on(int sig);
+void phase_poll(FILE *out);
+void phase_latencies(PhaseLatency latencies[PHASE_COUNT]);
+#endif
+
+#endif /* PHASE_TIMER_H_ */
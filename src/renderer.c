@@ -0,0 +1,161 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  renderer.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The null renderer, and what the renderers share.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "renderer.h"
+
+#include <string.h>
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static void null_idle(void);
+static void null_table(Table *table);
+static void null_dealer(Dealer *dealer);
+static void null_player(Player *player);
+static void null_message(const char *msg);
+static uint8_t null_num_players(uint8_t max);
+static bool null_name(uint8_t seat, char *name, int size);
+static bool null_read_line(const char *prompt, char *line, int size);
+static PlayerChoice null_choice(Player *player, bool surrender);
+static bool null_yes_no(const char *question);
+
+const Renderer NULL_RENDERER = {.name = "null", .open = null_idle, .close = null_idle, .seat = null_table,
+        .table = null_table, .dealer = null_dealer, .player = null_player, .message = null_message,
+        .pause = null_idle, .num_players = null_num_players, .player_name = null_name, .read_line = null_read_line,
+        .choice = null_choice, .yes_no = null_yes_no};
+
+/***************
+ *  Summary: Write the cards in a hand into a string
+ *
+ *  Description: Copies each card's face, made once when the deck was filled, straight to the end of the string
+ *      with no searching for it and no memory allocated. A string of HAND_STRING_SIZE holds the longest hand there
+ *      can be; in a shorter one the cards that don't fit are left off.
+ *
+ *  Parameter(s):
+ *      hand: the Hand to show
+ *      handString: where the cards go, replacing whatever was there
+ *      size: the size of handString
+ *      showCard: false to show the first card face down
+ *
+ *  Returns:
+ *      size_t: the length of the string written
+ */
+size_t hand_to_string(Hand *hand, char *handString, size_t size, bool showCard)
+{
+    size_t length = 0;
+
+    if (size == 0) return 0;
+
+    for (CardList *printCard = hand->cards; printCard != NULL && printCard->card != NULL;
+            printCard = printCard->nextCard)
+    {
+        if (length + CARD_GLYPH_SIZE >= size) break;
+
+        if (printCard == hand->cards && !showCard)
+        {
+            memcpy(handString + length, HOLE_GLYPH, sizeof(HOLE_GLYPH) - 1);
+            length += sizeof(HOLE_GLYPH) - 1;
+        }
+        else
+        {
+            memcpy(handString + length, printCard->card->face, FACE_LENGTH);
+            handString[length + FACE_LENGTH] = ' ';
+            length += CARD_GLYPH_SIZE;
+        }
+    }
+    handString[length] = '\0';
+
+    return length;
+}
+
+static void null_idle(void)
+{
+    return;
+}
+
+static void null_table(Table *table)
+{
+    (void) table;
+}
+
+static void null_dealer(Dealer *dealer)
+{
+    (void) dealer;
+}
+
+static void null_player(Player *player)
+{
+    (void) player;
+}
+
+static void null_message(const char *msg)
+{
+    (void) msg;
+}
+
+static uint8_t null_num_players(uint8_t max)
+{
+    (void) max;
+    return 0;
+}
+
+static bool null_name(uint8_t seat, char *name, int size)
+{
+    (void) seat;
+    (void) name;
+    (void) size;
+    return false;
+}
+
+static bool null_read_line(const char *prompt, char *line, int size)
+{
+    (void) prompt;
+    if (size > 0) line[0] = '\0';
+    return false;
+}
+
+static PlayerChoice null_choice(Player *player, bool surrender)
+{
+    (void) player;
+    (void) surrender;
+    return STAND;
+}
+
+static bool null_yes_no(const char *question)
+{
+    (void) question;
+    return false;
+}
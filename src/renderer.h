@@ -0,0 +1,87 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  renderer.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The interface between the game and whatever shows it. The game draws and asks through the Renderer
+ *               its Table was given, never a curses call of its own, so the same game runs on the ncurses screen
+ *               (curses_output.h), as plain lines of text on any terminal or pipe (text_output.h), or on the null
+ *               renderer here, which draws nothing, never waits and has no input to give.
+ *
+ *               Input callbacks return FALSE, or 0 players, when there is no more input to be had, at the end of a
+ *               text renderer's input or always for the null renderer; the game then takes the cautious answer.
+ */
+
+#ifndef RENDERER_H_
+#define RENDERER_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "blackjack.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define HOLE_GLYPH "XXX "
+#define CARD_GLYPH_SIZE (FACE_LENGTH + 1)  // a card's face and the space after it
+#define HAND_STRING_SIZE (MAX_HAND_CARDS * CARD_GLYPH_SIZE + 1)
+
+typedef struct Renderer
+{
+    const char *name;
+    void (*open)(void);                         // take over the terminal and welcome the players
+    void (*close)(void);                        // game over; give the terminal back
+    void (*seat)(Table *table);                 // the table is set: lay it out
+    void (*table)(Table *table);                // show the dealer and every player, between rounds
+    void (*dealer)(Dealer *dealer);
+    void (*player)(Player *player);
+    void (*message)(const char *msg);
+    void (*pause)(void);                        // between cards, so a person can follow the play
+    uint8_t (*num_players)(uint8_t max);        // 1 to max, or 0 to quit
+    bool (*player_name)(uint8_t seat, char *name, int size);
+    bool (*read_line)(const char *prompt, char *line, int size);    // line is left empty if the read was cut short
+    PlayerChoice (*choice)(Player *player, bool surrender);         // no input stands
+    bool (*yes_no)(const char *question);
+} Renderer;
+
+extern const Renderer NULL_RENDERER;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+size_t hand_to_string(Hand *hand, char *handString, size_t size, bool showCard);
+
+#endif /* RENDERER_H_ */
@@ -0,0 +1,202 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  rules.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Read the house rules from a rules file of "key = value" lines. Blank lines and lines starting with #
+ *               are skipped, and keys left out keep the value from RULES_S17. See rules.conf for the keys.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "rules.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define RULES_LINE_MAX 128
+
+const Rules RULES_S17 = RULES_S17_INIT;
+const Rules RULES_H17 = RULES_H17_INIT;
+const Rules RULES_H17_6TO5 = RULES_H17_6TO5_INIT;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static bool parse_yes_no(const char *value, bool *flag);
+static bool parse_rule(Rules *rules, const char *key, const char *value);
+static char *trim(char *text);
+
+/***************
+ *  Summary: Read a rules file
+ *
+ *  Parameter(s):
+ *      path: the rules file
+ *      rules: filled in from the file, starting from RULES_S17
+ *
+ *  Returns:
+ *      bool: true if the file was read, false if it couldn't be opened or has a bad line, which is logged
+ */
+bool load_rules(const char *path, Rules *rules)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        zerror("Couldn't open rules file %s.", path);
+        return false;
+    }
+
+    *rules = RULES_S17;
+    char line[RULES_LINE_MAX];
+    uint16_t lineNum = 0;
+    bool valid = true;
+
+    while (valid && fgets(line, sizeof(line), file))
+    {
+        lineNum++;
+        char *key = trim(line);
+        if (*key == '\0' || *key == '#') continue;
+
+        char *value = strchr(key, '=');
+        if (value == NULL)
+        {
+            zerror("%s:%u: expected key = value.", path, lineNum);
+            valid = false;
+            continue;
+        }
+        *value++ = '\0';
+        key = trim(key);
+        value = trim(value);
+
+        if (!parse_rule(rules, key, value))
+        {
+            zerror("%s:%u: bad value '%s' for %s.", path, lineNum, value, key);
+            valid = false;
+        }
+    }
+    fclose(file);
+
+    if (valid)
+    {
+        zinfo("Rules from %s: %s, blackjack pays %u:%u, DAS %s, double on %u, split to %u hands, surrender %s, "
+                "continuous shuffler %s.", path, rules->hitSoft17 ? "H17" : "S17", rules->payoutNum, rules->payoutDen,
+                rules->doubleAfterSplit ? "yes" : "no", rules->doubleOn, rules->maxHands,
+                rules->surrender ? "yes" : "no", rules->continuousShuffle ? "yes" : "no");
+    }
+
+    return valid;
+}
+
+/***************
+ *  Summary: Check if two sets of rules are the same
+ *
+ *  Description: Compared field by field as Rules has padding.
+ *
+ *  Parameter(s):
+ *      a, b: the Rules to compare
+ *
+ *  Returns:
+ *      bool: true if every rule matches
+ */
+bool rules_equal(const Rules *a, const Rules *b)
+{
+    return (a->hitSoft17 == b->hitSoft17 && a->payoutNum == b->payoutNum && a->payoutDen == b->payoutDen
+            && a->doubleAfterSplit == b->doubleAfterSplit && a->doubleOn == b->doubleOn
+            && a->maxHands == b->maxHands && a->surrender == b->surrender
+            && a->continuousShuffle == b->continuousShuffle);
+}
+
+static bool parse_rule(Rules *rules, const char *key, const char *value)
+{
+    if (!strcmp(key, "dealer_hits_soft_17")) return parse_yes_no(value, &rules->hitSoft17);
+    if (!strcmp(key, "double_after_split")) return parse_yes_no(value, &rules->doubleAfterSplit);
+    if (!strcmp(key, "surrender")) return parse_yes_no(value, &rules->surrender);
+    if (!strcmp(key, "continuous_shuffler")) return parse_yes_no(value, &rules->continuousShuffle);
+
+    if (!strcmp(key, "blackjack_pays"))
+    {
+        unsigned num, den;
+        char extra;
+        if (sscanf(value, "%u:%u%c", &num, &den, &extra) != 2 || num == 0 || den == 0 || num > 255 || den > 255)
+        {
+            return false;
+        }
+        rules->payoutNum = num;
+        rules->payoutDen = den;
+        return true;
+    }
+
+    if (!strcmp(key, "double_on"))
+    {
+        if (!strcmp(value, "any")) rules->doubleOn = DOUBLE_ANY_TWO;
+        else if (!strcmp(value, "9-11")) rules->doubleOn = DOUBLE_9_TO_11;
+        else if (!strcmp(value, "10-11")) rules->doubleOn = DOUBLE_10_11;
+        else return false;
+        return true;
+    }
+
+    if (!strcmp(key, "max_split_hands"))
+    {
+        char *end;
+        long hands = strtol(value, &end, 10);
+        if (*end != '\0' || hands < 1 || hands > 8) return false;
+        rules->maxHands = hands;
+        return true;
+    }
+
+    zerror("Unknown rule %s.", key);
+    return false;
+}
+
+static bool parse_yes_no(const char *value, bool *flag)
+{
+    if (!strcmp(value, "yes")) *flag = true;
+    else if (!strcmp(value, "no")) *flag = false;
+    else return false;
+
+    return true;
+}
+
+static char *trim(char *text)
+{
+    while (isspace((unsigned char) *text)) text++;
+
+    char *end = text + strlen(text);
+    while (end > text && isspace((unsigned char) end[-1])) end--;
+    *end = '\0';
+
+    return text;
+}
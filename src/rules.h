@@ -0,0 +1,84 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  rules.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The house rules a table plays by, read from a rules file. The presets are the combinations the
+ *               simulator has specialized round loops for; anything else is played by the generic loop. Their
+ *               initializers are macros so code specializing on a preset sees its values at compile time.
+ */
+
+#ifndef RULES_H_
+#define RULES_H_
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/***********
+ * DEFINES *
+ ***********/
+typedef enum DoubleOn
+{
+    DOUBLE_ANY_TWO, DOUBLE_9_TO_11, DOUBLE_10_11
+} DoubleOn;
+
+typedef struct Rules
+{
+    bool hitSoft17;             // H17: dealer hits soft 17, otherwise stands on all 17s (S17)
+    uint8_t payoutNum;          // blackjack pays payoutNum:payoutDen
+    uint8_t payoutDen;
+    bool doubleAfterSplit;      // DAS
+    DoubleOn doubleOn;          // first two cards a player may double down on
+    uint8_t maxHands;           // most hands a seat can split into, 1 for no splitting
+    bool surrender;             // late surrender of the first two cards, after the dealer checks for blackjack
+    bool continuousShuffle;     // CSM: the discards go back in the shoe after every round instead of at the cut card
+} Rules;
+
+// S17, 3:2, DAS, double any two, split to 4, no surrender
+#define RULES_S17_INIT {.hitSoft17 = false, .payoutNum = 3, .payoutDen = 2, .doubleAfterSplit = true, \
+        .doubleOn = DOUBLE_ANY_TWO, .maxHands = 4, .surrender = false, .continuousShuffle = false}
+// as RULES_S17 but the dealer hits soft 17
+#define RULES_H17_INIT {.hitSoft17 = true, .payoutNum = 3, .payoutDen = 2, .doubleAfterSplit = true, \
+        .doubleOn = DOUBLE_ANY_TWO, .maxHands = 4, .surrender = false, .continuousShuffle = false}
+// as RULES_H17 but blackjack pays 6:5
+#define RULES_H17_6TO5_INIT {.hitSoft17 = true, .payoutNum = 6, .payoutDen = 5, .doubleAfterSplit = true, \
+        .doubleOn = DOUBLE_ANY_TWO, .maxHands = 4, .surrender = false, .continuousShuffle = false}
+
+extern const Rules RULES_S17;
+extern const Rules RULES_H17;
+extern const Rules RULES_H17_6TO5;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+bool load_rules(const char *path, Rules *rules);
+bool rules_equal(const Rules *a, const Rules *b);
+
+#endif /* RULES_H_ */
@@ -0,0 +1,243 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  seat_batch.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Settling a whole round of hands at once. The hands are gathered from the seats into parallel
+ *               arrays, settled with the same outcomes as settle_hand, and the payouts credited back to the
+ *               bankrolls.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "seat_batch.h"
+
+/****************
+ * DECLARATIONS *
+ ****************/
+
+/***************
+ *  Summary: Allocate a batch
+ *
+ *  Parameter(s):
+ *      capacity: the most hands a round can have, seats times the rules' maxHands
+ *
+ *  Returns:
+ *      batch: pointer to the SeatBatch struct or NULL if an error
+ */
+SeatBatch *seat_batch_new(uint32_t capacity)
+{
+    SeatBatch *batch = calloc(1, sizeof(SeatBatch));
+    if (batch == NULL)
+    {
+        zerror("Seat batch memory allocation failed.");
+        return NULL;
+    }
+
+    batch->capacity = capacity;
+    batch->seat = calloc(capacity, sizeof(*batch->seat));
+    batch->eval = hand_eval_new(capacity);
+    batch->flags = calloc(capacity, sizeof(*batch->flags));
+    batch->bet = calloc(capacity, sizeof(*batch->bet));
+    batch->payout = calloc(capacity, sizeof(*batch->payout));
+    batch->result = calloc(capacity, sizeof(*batch->result));
+    if (!batch->seat || !batch->eval || !batch->flags || !batch->bet || !batch->payout || !batch->result)
+    {
+        zerror("Seat batch arrays allocation failed for %u hands.", capacity);
+        seat_batch_free(batch);
+        return NULL;
+    }
+
+    return batch;
+}
+
+/***************
+ *  Summary: Free a batch
+ *
+ *  Parameter(s):
+ *      batch: the SeatBatch struct to free
+ *
+ *  Returns:
+ *      N/A
+ */
+void seat_batch_free(SeatBatch *batch)
+{
+    if (batch == NULL) return;
+
+    free(batch->seat);
+    hand_eval_free(batch->eval);
+    free(batch->flags);
+    free(batch->bet);
+    free(batch->payout);
+    free(batch->result);
+    free(batch);
+
+    return;
+}
+
+/***************
+ *  Summary: Empty the batch for the next round
+ *
+ *  Parameter(s):
+ *      batch: the SeatBatch struct
+ *
+ *  Returns:
+ *      N/A
+ */
+void seat_batch_clear(SeatBatch *batch)
+{
+    batch->count = 0;
+    hand_eval_clear(batch->eval);
+
+    return;
+}
+
+/***************
+ *  Summary: Add a finished hand to the batch
+ *
+ *  Description: Copies the hand's card values into the evaluator and keeps its flags and bet, so the Hand can be
+ *      cleared before the batch is settled.
+ *
+ *  Parameter(s):
+ *      batch: the SeatBatch struct
+ *      seat: the seat the hand belongs to
+ *      hand: the finished Hand
+ *
+ *  Returns:
+ *      bool: false if the batch is full or the hand can't be evaluated
+ */
+bool seat_batch_add(SeatBatch *batch, uint16_t seat, Hand *hand)
+{
+    if (batch->count == batch->capacity)
+    {
+        zerror("Seat batch is full at %u hands.", batch->capacity);
+        return false;
+    }
+
+    if (!hand_eval_add(batch->eval, hand)) return false;
+
+    uint32_t ii = batch->count++;
+    batch->seat[ii] = seat;
+    batch->flags[ii] = ((hand->splits > 0) ? BATCH_SPLIT : 0) | (hand->surrendered ? BATCH_SURRENDERED : 0)
+            | (hand->evenMoney ? BATCH_EVEN_MONEY : 0);
+    batch->bet[ii] = hand->bet;
+
+    return true;
+}
+
+/***************
+ *  Summary: Settle every hand in the batch against the dealer
+ *
+ *  Description: Evaluates the hands, then works out each hand's result and payout exactly as settle_hand would.
+ *      The main loop has no branches: every outcome is computed as a 0 or 1 and combined arithmetically, and the
+ *      payout is a number of half bets worked out in 32 bits, so it vectorizes even without 64 bit multiplies. The
+ *      blackjack bonus needs a division by the payout ratio and is added in a second pass over just the blackjacks.
+ *
+ *  Parameter(s):
+ *      batch: the SeatBatch struct
+ *      dealerCount: the dealer's final count
+ *      dealerBlackjack: true if the dealer has blackjack
+ *      rules: the Rules with the blackjack payout
+ *
+ *  Returns:
+ *      N/A
+ */
+void settle_batch(SeatBatch *batch, uint8_t dealerCount, bool dealerBlackjack, const Rules *rules)
+{
+    evaluate_hands(batch->eval);
+
+    const uint8_t *restrict total = batch->eval->total;
+    const uint8_t *restrict twoCard21 = batch->eval->blackjack;
+    const uint8_t *restrict flags = batch->flags;
+    const uint32_t *restrict bet = batch->bet;
+    uint32_t *restrict payout = batch->payout;
+    uint8_t *restrict result = batch->result;
+    const uint32_t dealer = dealerCount;
+    const uint32_t dealerLive = dealerCount <= 21;
+    const uint32_t peeked = dealerBlackjack;
+    const uint32_t count = batch->count;
+
+    for (uint32_t ii = 0; ii < count; ii++)
+    {
+        uint32_t playerCount = total[ii];
+        // flags are single bits, so dividing by one moves it down to bit 0 without a compare
+        uint32_t blackjack = twoCard21[ii] & (((flags[ii] / BATCH_SPLIT) & 1) ^ 1);
+        uint32_t surrendered = (flags[ii] / BATCH_SURRENDERED) & 1;
+        uint32_t evenMoney = (flags[ii] / BATCH_EVEN_MONEY) & 1;
+
+        // against a dealer blackjack only a player blackjack pushes, otherwise a blackjack beats any 21 and the rest
+        // compares counts
+        uint32_t lost = (blackjack ^ 1) & ((playerCount > 21) | (dealerLive & (playerCount < dealer)));
+        uint32_t push = (blackjack ^ 1) & (lost ^ 1) & (playerCount == dealer);
+        uint32_t natural = blackjack;
+        uint32_t won = (blackjack ^ 1) & (lost ^ 1) & (push ^ 1);
+        push = (peeked & blackjack) | ((peeked ^ 1) & push);
+        natural &= peeked ^ 1;
+        won &= peeked ^ 1;
+
+        // surrender and even money were settled before the dealer played and override the rest
+        uint32_t open = (surrendered ^ 1) & (evenMoney ^ 1);
+        uint32_t outcome = surrendered * HAND_SURRENDERED + evenMoney * HAND_WON
+                + open * (push * HAND_PUSH + natural * HAND_BLACKJACK + won * HAND_WON);
+        uint32_t halves = surrendered + evenMoney * 4 + open * (push * 2 + natural * 2 + won * 4);
+
+        result[ii] = outcome;
+        payout[ii] = bet[ii] * (halves >> 1) + ((bet[ii] >> 1) & -(halves & 1));
+    }
+
+    for (uint32_t ii = 0; ii < count; ii++)
+    {
+        if (result[ii] == HAND_BLACKJACK)
+        {
+            payout[ii] += (uint64_t) bet[ii] * rules->payoutNum / rules->payoutDen;
+        }
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Credit the payouts of a settled batch to the bankrolls
+ *
+ *  Parameter(s):
+ *      batch: the settled SeatBatch struct
+ *      banks: the bankrolls, indexed by seat
+ *
+ *  Returns:
+ *      N/A
+ */
+void credit_batch(SeatBatch *batch, uint32_t *banks)
+{
+    for (uint32_t ii = 0; ii < batch->count; ii++)
+    {
+        banks[batch->seat[ii]] += batch->payout[ii];
+    }
+
+    return;
+}
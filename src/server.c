@@ -0,0 +1,504 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  server.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Description: Host tables of blackjack over a Unix domain socket. Each connection plays its own table using the
+ *               line protocol in session.h. One worker thread per core runs its own epoll loop; all workers wait on
+ *               the listening socket and the kernel hands each new connection to one of them. With -b the same
+ *               sessions are played over stdin and stdout instead, see bot.c.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#define _GNU_SOURCE
+
+#include "session.h"
+#include "bot.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "logger.h"
+#include "live_stats.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define DEFAULT_SOCKET "blackjack.sock"
+#define MAX_EVENTS 256
+#define READ_SIZE 4096
+#define PUBLISH_WAIT_MS 1000        // an idle worker still publishes this often, so its hands/s drops to 0
+#define OUTPUT_CAP (64 * 1024)      // replies waiting past which a connection isn't read until the client catches up
+
+typedef struct Connection
+{
+    int fd;
+    Session *session;
+    uint32_t events;                // epoll events the connection is registered for
+    struct Connection *prev;        // the worker's open connections, so they can be freed when it stops
+    struct Connection *next;
+} Connection;
+
+typedef struct Worker
+{
+    pthread_t thread;
+    int listenFd;
+    int stopFd;
+    const Rules *rules;
+    uint32_t connections;
+    Connection *open;               // first of the connections open on this worker
+    LiveStats *live;
+    uint16_t slot;
+    LiveSample sample;              // counts of every session the worker has served
+} Worker;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+int open_socket(const char *path);
+void *worker_loop(void *arg);
+void accept_connections(Worker *worker, int epfd);
+void service_connection(Worker *worker, int epfd, Connection *conn, uint32_t events);
+bool flush_connection(int epfd, Connection *conn);
+void close_connection(Worker *worker, Connection *conn);
+
+int main(int argc, char *argv[])
+{
+    const char *path = DEFAULT_SOCKET;
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    long botTables = 0;
+    const char *rulesPath = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:s:w:R:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                botTables = strtol(optarg, NULL, 10);
+                break;
+            case 's':
+                path = optarg;
+                break;
+            case 'w':
+                workers = strtol(optarg, NULL, 10);
+                break;
+            case 'R':
+                rulesPath = optarg;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-R rules.conf] [-s socket] [-w workers] | [-R rules.conf] -b tables\n",
+                        argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (workers < 1) workers = 1;
+
+    // seed random number generator
+#if DEBUG
+    srandom(1968);
+#else
+    srandom(time(NULL));
+#endif
+
+    if (init_zlog("server.conf", "log")) return EXIT_FAILURE;
+
+    Rules rules = RULES_S17;
+    if (rulesPath && !load_rules(rulesPath, &rules))
+    {
+        fprintf(stderr, "Couldn't read rules file %s, see the log.\n", rulesPath);
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    // bot mode plays over stdin and stdout instead of the socket
+    if (botTables > 0)
+    {
+        int result = run_bot((botTables > UINT16_MAX) ? UINT16_MAX : botTables, &rules);
+        end_zlog();
+        return result;
+    }
+
+    int listenFd = open_socket(path);
+    int stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    Worker *pool = calloc(workers, sizeof(Worker));
+    if (listenFd < 0 || stopFd < 0 || pool == NULL)
+    {
+        zerror("Server set-up failed.");
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    // workers inherit the blocked signals, so only the main thread sees them in sigwait
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // each worker publishes to its own slot; without shared memory the server runs unwatched
+    LiveStats *live = live_stats_open("server", (workers > UINT16_MAX) ? UINT16_MAX : workers);
+    for (long ii = 0; ii < workers; ii++)
+    {
+        pool[ii].listenFd = listenFd;
+        pool[ii].stopFd = stopFd;
+        pool[ii].rules = &rules;
+        pool[ii].live = live;
+        pool[ii].slot = (ii < UINT16_MAX) ? ii : UINT16_MAX;   // past the last slot, so not published
+        pthread_create(&pool[ii].thread, NULL, worker_loop, &pool[ii]);
+    }
+    printf("Serving blackjack on %s with %ld workers.\n", path, workers);
+    zinfo("Serving on %s with %ld workers.", path, workers);
+
+    int sig;
+    sigwait(&signals, &sig);
+    zinfo("Got signal %d, stopping workers.", sig);
+
+    uint64_t stop = 1;
+    if (write(stopFd, &stop, sizeof(stop)) < 0)
+    {
+        zerror("Couldn't signal workers to stop.");
+    }
+    for (long ii = 0; ii < workers; ii++)
+    {
+        pthread_join(pool[ii].thread, NULL);
+    }
+
+    live_stats_close(live);
+    close(stopFd);
+    close(listenFd);
+    unlink(path);
+    free(pool);
+    end_zlog();
+
+    return EXIT_SUCCESS;
+}
+
+/***************
+ *  Summary: Open the listening socket
+ *
+ *  Description: Create a non-blocking Unix domain stream socket bound to path, replacing a stale socket file left
+ *      behind by a previous run.
+ *
+ *  Parameter(s):
+ *      path: file system path of the socket
+ *
+ *  Returns:
+ *      fd: the listening socket or -1 if an error
+ */
+int open_socket(const char *path)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        zerror("Socket path %s is too long.", path);
+        return -1;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        zerror("socket() failed: %s", strerror(errno));
+        return -1;
+    }
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0)
+    {
+        zerror("Couldn't listen on %s: %s", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/***************
+ *  Summary: Event loop of a worker thread
+ *
+ *  Description: Waits on the shared listening socket, the stop eventfd and the worker's own connections. The
+ *      listening socket is added with EPOLLEXCLUSIVE so a new connection wakes only one worker. After each batch of
+ *      events the worker publishes its sessions' counts to its live stats slot.
+ *
+ *  Parameter(s):
+ *      arg: the Worker struct
+ *
+ *  Returns:
+ *      NULL
+ */
+void *worker_loop(void *arg)
+{
+    Worker *worker = arg;
+    struct epoll_event events[MAX_EVENTS];
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0)
+    {
+        zerror("epoll_create1() failed: %s", strerror(errno));
+        return NULL;
+    }
+
+    // the listening socket is marked with a NULL pointer and the stop eventfd with the worker itself
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = NULL};
+    epoll_ctl(epfd, EPOLL_CTL_ADD, worker->listenFd, &ev);
+    ev.events = EPOLLIN;
+    ev.data.ptr = worker;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, worker->stopFd, &ev);
+
+    bool running = true;
+    while (running)
+    {
+        int ready = epoll_wait(epfd, events, MAX_EVENTS, worker->live ? PUBLISH_WAIT_MS : -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR) continue;
+            zerror("epoll_wait() failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int ii = 0; ii < ready; ii++)
+        {
+            if (events[ii].data.ptr == NULL)
+            {
+                accept_connections(worker, epfd);
+            }
+            else if (events[ii].data.ptr == worker)
+            {
+                running = false;
+            }
+            else
+            {
+                service_connection(worker, epfd, events[ii].data.ptr, events[ii].events);
+            }
+        }
+        live_stats_publish(worker->live, worker->slot, &worker->sample);
+    }
+
+    // connections still open are closed and their sessions freed, then the epoll set
+    zinfo("Worker stopping with %u connections open.", worker->connections);
+    while (worker->open != NULL)
+    {
+        close_connection(worker, worker->open);
+    }
+    close(epfd);
+    return NULL;
+}
+
+/***************
+ *  Summary: Accept every pending connection
+ *
+ *  Description: Give each new connection its own session and add it to this worker's epoll set, then send the
+ *      session greeting.
+ *
+ *  Parameter(s):
+ *      worker: the Worker struct
+ *      epfd: the worker's epoll fd
+ *
+ *  Returns:
+ *      N/A
+ */
+void accept_connections(Worker *worker, int epfd)
+{
+    while (true)
+    {
+        int fd = accept4(worker->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                zerror("accept4() failed: %s", strerror(errno));
+            }
+            return;
+        }
+
+        Connection *conn = calloc(1, sizeof(Connection));
+        Session *session = session_new(worker->rules);
+        if (conn == NULL || session == NULL)
+        {
+            zerror("Couldn't allocate a session.");
+            free(conn);
+            session_free(session);
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->session = session;
+        conn->events = EPOLLIN | EPOLLRDHUP;
+        session->live = &worker->sample;
+        conn->next = worker->open;
+        if (worker->open) worker->open->prev = conn;
+        worker->open = conn;
+        worker->connections++;
+
+        struct epoll_event ev = {.events = conn->events, .data.ptr = conn};
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            zerror("epoll_ctl() failed: %s", strerror(errno));
+            close_connection(worker, conn);
+            continue;
+        }
+        flush_connection(epfd, conn);
+    }
+}
+
+/***************
+ *  Summary: Handle events on a connection
+ *
+ *  Description: Feed what's readable into the session, then write out as much of the replies as the socket takes.
+ *      Reading stops once more than OUTPUT_CAP of replies are waiting, so a client that sends without reading can't
+ *      make the session buffer grow without end; it goes on once the client has read them. The connection is closed
+ *      on hang up, on error or once a finished session has written all its output.
+ *
+ *  Parameter(s):
+ *      worker: the Worker struct
+ *      epfd: the worker's epoll fd
+ *      conn: the Connection struct
+ *      events: the epoll events reported
+ *
+ *  Returns:
+ *      N/A
+ */
+void service_connection(Worker *worker, int epfd, Connection *conn, uint32_t events)
+{
+    char buffer[READ_SIZE];
+    bool open = (conn->session->state != SESSION_CLOSED);
+
+    if (open && (events & EPOLLIN))
+    {
+        while (open && conn->session->outLen <= OUTPUT_CAP)
+        {
+            ssize_t bytes = read(conn->fd, buffer, sizeof(buffer));
+            if (bytes > 0)
+            {
+                open = session_feed(conn->session, buffer, bytes);
+            }
+            else if (bytes < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            else
+            {
+                close_connection(worker, conn);     // hung up or failed
+                return;
+            }
+        }
+    }
+    else if (events & (EPOLLERR | EPOLLHUP))
+    {
+        close_connection(worker, conn);
+        return;
+    }
+
+    if (!flush_connection(epfd, conn) || (!open && conn->session->outLen == 0))
+    {
+        close_connection(worker, conn);
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Write the session's replies to the connection
+ *
+ *  Description: Writes until the output is empty or the socket is full. A full socket registers for EPOLLOUT so the
+ *      rest is written when there is room again. While more than OUTPUT_CAP is left the connection isn't registered
+ *      for input, so epoll doesn't keep reporting the input service_connection has left unread.
+ *
+ *  Parameter(s):
+ *      epfd: the worker's epoll fd
+ *      conn: the Connection struct
+ *
+ *  Returns:
+ *      bool: false if the write failed and the connection should be closed
+ */
+bool flush_connection(int epfd, Connection *conn)
+{
+    Session *session = conn->session;
+    while (session->outLen > 0)
+    {
+        ssize_t bytes = write(conn->fd, session->out, session->outLen);
+        if (bytes < 0)
+        {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            break;
+        }
+        session_consume(session, bytes);
+    }
+
+    uint32_t events = (session->outLen > OUTPUT_CAP) ? 0 : EPOLLIN | EPOLLRDHUP;
+    if (session->outLen > 0) events |= EPOLLOUT;
+    if (events != conn->events)
+    {
+        struct epoll_event ev = {.events = events, .data.ptr = conn};
+        epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+        conn->events = events;
+    }
+
+    return true;
+}
+
+/***************
+ *  Summary: Close a connection and free its session
+ *
+ *  Parameter(s):
+ *      worker: the Worker struct
+ *      conn: the Connection struct
+ *
+ *  Returns:
+ *      N/A
+ */
+void close_connection(Worker *worker, Connection *conn)
+{
+    close(conn->fd);    // closing the fd also removes it from the epoll set
+    if (conn->prev) conn->prev->next = conn->next;
+    else worker->open = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+    session_free(conn->session);
+    free(conn);
+    worker->connections--;
+
+    return;
+}
@@ -0,0 +1,944 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  session.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Description: Play a table of blackjack over the line protocol described in session.h. Used by the
+ *               game server, one session per connection.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "session.h"
+
+#include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include "engine.h"
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define SEATED(session, s) ((session)->seated & (1u << (s)))
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static void emit(Session *session, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void card_code(Card *card, char *code);
+static void hand_codes(Hand *hand, char *codes, size_t size);
+static void emit_hand(Session *session, Hand *hand, uint8_t handNum);
+static void emit_bet(Session *session);
+static void emit_turn(Session *session);
+static int16_t seen_count(Session *session);
+static uint8_t next_seat(Session *session, int seat);
+static void handle_line(Session *session, char *line);
+static void take_seats(Session *session, char *names);
+static void start_betting(Session *session);
+static void take_bet(Session *session, char *arg);
+static void leave_seat(Session *session, uint8_t seat);
+static void start_round(Session *session);
+static uint8_t next_insurable(Session *session, int seat);
+static void emit_insure(Session *session);
+static void take_insurance_answer(Session *session, bool insure);
+static void check_dealer(Session *session);
+static void take_choice(Session *session, PlayerChoice choice);
+static void next_hand(Session *session);
+static void finish_round(Session *session, bool dealerBlackjack);
+
+/***************
+ *  Summary: Create a new session
+ *
+ *  Description: Allocate a session waiting for the client to take their seats, and queue the greeting.
+ *
+ *  Parameter(s):
+ *      rules: the house Rules the table plays by, which must outlive the session
+ *
+ *  Returns:
+ *      session: pointer to the Session struct or NULL if an error
+ */
+Session *session_new(const Rules *rules)
+{
+    Session *session = calloc(1, sizeof(Session));
+    if (session == NULL)
+    {
+        zerror("Session memory allocation failed.");
+        return NULL;
+    }
+
+    session->table.players = session->players;
+    session->table.dealer = &session->dealer;
+    session->table.rules = rules;
+    strncpy(session->dealer.name, "Dealer", 7);
+    session->state = SESSION_SEATING;
+    emit(session, "HELLO %d\n", SESSION_VERSION);
+
+    return session;
+}
+
+/***************
+ *  Summary: Free a session
+ *
+ *  Description: Free the hands, the shoe and the output buffer of a session.
+ *
+ *  Parameter(s):
+ *      session: the Session struct to free
+ *
+ *  Returns:
+ *      N/A
+ */
+void session_free(Session *session)
+{
+    if (session == NULL) return;
+
+    for (uint8_t seat = 0; seat < SESSION_MAX_SEATS; seat++)
+    {
+        clear_hands(&session->players[seat].hand);
+    }
+    clear_hands(&session->dealer.hand);
+
+    if (session->table.shoe)
+    {
+        free(session->table.shoe->shoe);
+        free(session->table.shoe);
+    }
+    free(session->out);
+    free(session);
+
+    return;
+}
+
+/***************
+ *  Summary: Feed input from the client into the session
+ *
+ *  Description: Split the input into lines and play each complete line. A partial line is kept until the rest of it
+ *      arrives. Replies are appended to the output buffer.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      data: bytes received from the client
+ *      len: number of bytes in data
+ *
+ *  Returns:
+ *      bool: false once the session is over and the connection should be closed after the output is written
+ */
+bool session_feed(Session *session, const char *data, size_t len)
+{
+    for (size_t ii = 0; ii < len && session->state != SESSION_CLOSED; ii++)
+    {
+        if (data[ii] == '\n')
+        {
+            if (!session->discard)
+            {
+                session->line[session->lineLen] = '\0';
+                handle_line(session, session->line);
+                if (session->broken) session->state = SESSION_CLOSED;   // the line may have moved the state on
+            }
+            session->lineLen = 0;
+            session->discard = false;
+        }
+        else if (session->lineLen < SESSION_LINE_MAX - 1)
+        {
+            session->line[session->lineLen++] = data[ii];
+        }
+        else if (!session->discard)
+        {
+            emit(session, "ERR line too long\n");
+            session->discard = true;
+        }
+    }
+
+    return (session->state != SESSION_CLOSED);
+}
+
+/***************
+ *  Summary: Remove written bytes from the output buffer
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      bytes: number of bytes written from the front of the buffer
+ *
+ *  Returns:
+ *      N/A
+ */
+void session_consume(Session *session, size_t bytes)
+{
+    if (bytes >= session->outLen)
+    {
+        session->outLen = 0;
+        return;
+    }
+
+    memmove(session->out, session->out + bytes, session->outLen - bytes);
+    session->outLen -= bytes;
+
+    return;
+}
+
+/***************
+ *  Summary: Append a reply to the output buffer
+ *
+ *  Description: Format the reply with printf style arguments, growing the buffer as needed. If the buffer can't grow
+ *      the reply is lost, so the session is marked broken, closes and emits nothing more.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      fmt: printf style format string
+ *
+ *  Returns:
+ *      N/A
+ */
+static void emit(Session *session, const char *fmt, ...)
+{
+    if (session->broken) return;
+
+    va_list args;
+    va_start(args, fmt);
+    int needed = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (needed < 0) return;
+
+    if (session->outLen + needed + 1 > session->outCap)
+    {
+        size_t cap = session->outCap ? session->outCap : 256;
+        while (cap < session->outLen + needed + 1)
+        {
+            cap *= 2;
+        }
+
+        char *out = realloc(session->out, cap);
+        if (out == NULL)
+        {
+            zerror("Session output buffer allocation failed, closing the session.");
+            session->broken = true;
+            session->state = SESSION_CLOSED;
+            return;
+        }
+        session->out = out;
+        session->outCap = cap;
+    }
+
+    va_start(args, fmt);
+    vsnprintf(session->out + session->outLen, session->outCap - session->outLen, fmt, args);
+    va_end(args);
+    session->outLen += needed;
+
+    return;
+}
+
+/***************
+ *  Summary: Convert a card to its two letter protocol code
+ *
+ *  Parameter(s):
+ *      card: the Card struct
+ *      code: buffer of at least three chars for the code
+ *
+ *  Returns:
+ *      N/A
+ */
+static void card_code(Card *card, char *code)
+{
+    code[0] = (card->rank[0] == '1') ? 'T' : card->rank[1];
+
+    if (!strcmp(card->suit, SPADE)) code[1] = 'S';
+    else if (!strcmp(card->suit, CLUB)) code[1] = 'C';
+    else if (!strcmp(card->suit, HEART)) code[1] = 'H';
+    else code[1] = 'D';
+
+    code[2] = '\0';
+    return;
+}
+
+/***************
+ *  Summary: Convert the cards of a hand to a space separated list of codes
+ *
+ *  Parameter(s):
+ *      hand: the Hand struct
+ *      codes: buffer for the list
+ *      size: size of the buffer
+ *
+ *  Returns:
+ *      N/A
+ */
+static void hand_codes(Hand *hand, char *codes, size_t size)
+{
+    size_t len = 0;
+    codes[0] = '\0';
+
+    for (CardList *cards = hand->cards; cards != NULL && len + 4 <= size; cards = cards->nextCard)
+    {
+        if (len > 0)
+        {
+            codes[len++] = ' ';
+        }
+        card_code(cards->card, &codes[len]);
+        len += 2;
+    }
+
+    return;
+}
+
+static void emit_hand(Session *session, Hand *hand, uint8_t handNum)
+{
+    char codes[SESSION_LINE_MAX];
+    hand_codes(hand, codes, sizeof(codes));
+    emit(session, "HAND %u %u %u %s\n", session->seat + 1, handNum, blackjack_count(*hand), codes);
+
+    return;
+}
+
+/***************
+ *  Summary: Ask the seat whose turn it is for a bet
+ *
+ *  Description: Along with the player's money, sends the cards left in the shoe and the running count so a bot can
+ *      size its bet.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *
+ *  Returns:
+ *      N/A
+ */
+static void emit_bet(Session *session)
+{
+    Player *player = &session->players[session->seat];
+    Deck *shoe = session->table.shoe;
+    emit(session, "BET %u %s %u %u %d\n", session->seat + 1, player->name, player->money, shoe->cards - shoe->deal,
+            seen_count(session));
+
+    return;
+}
+
+/***************
+ *  Summary: Ask the hand whose turn it is for a decision
+ *
+ *  Description: Sends everything needed to make the decision on one line: the count and whether it is soft, the
+ *      dealer's upcard, the cards left and running count, the choices allowed and the cards in the hand.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *
+ *  Returns:
+ *      N/A
+ */
+static void emit_turn(Session *session)
+{
+    Player *player = &session->players[session->seat];
+    Hand *hand = session->hand;
+    Deck *shoe = session->table.shoe;
+    char upcard[3];
+    char codes[SESSION_LINE_MAX];
+    char actions[6] = "SH";
+
+    if (can_double(hand, player->money, session->table.rules)) strcat(actions, "D");
+    if (can_split(hand, player->money, session->table.rules)) strcat(actions, "P");
+    if (can_surrender(hand, session->table.rules)) strcat(actions, "R");
+    card_code(dealer_upcard(&session->dealer.hand), upcard);
+    hand_codes(hand, codes, sizeof(codes));
+
+    emit(session, "TURN %u %u %u %d %s %u %d %s %s\n", session->seat + 1, session->handNum, blackjack_count(*hand),
+            hand_is_soft(hand), upcard, shoe->cards - shoe->deal, seen_count(session), actions, codes);
+
+    return;
+}
+
+/***************
+ *  Summary: Return the running count of the cards the players have seen
+ *
+ *  Description: The shoe's running count includes the dealer's hole card, so it is taken back out while the hole card
+ *      is face down.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *
+ *  Returns:
+ *      int16_t: the Hi-Lo running count
+ */
+static int16_t seen_count(Session *session)
+{
+    int16_t count = running_count(session->table.shoe);
+    if (!session->dealer.faceup && session->dealer.hand.cards != NULL)
+    {
+        count -= hi_lo_value(session->dealer.hand.cards->card);
+    }
+
+    return count;
+}
+
+/***************
+ *  Summary: Find the next seat still at the table
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      seat: the seat to start looking after, -1 to start from the first seat
+ *
+ *  Returns:
+ *      seat: the next seat or SESSION_MAX_SEATS if there are no more seats
+ */
+static uint8_t next_seat(Session *session, int seat)
+{
+    for (seat++; seat < session->table.numPlayers; seat++)
+    {
+        if (SEATED(session, seat)) return seat;
+    }
+
+    return SESSION_MAX_SEATS;
+}
+
+/***************
+ *  Summary: Play one line of input from the client
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      line: the line without its newline
+ *
+ *  Returns:
+ *      N/A
+ */
+static void handle_line(Session *session, char *line)
+{
+    // strip a trailing carriage return so telnet style clients work as well
+    size_t len = strlen(line);
+    if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+
+    char *args = line;
+    while (*args && !isspace((unsigned char) *args)) args++;
+    if (*args) *args++ = '\0';
+    for (char *ch = line; *ch; ch++) *ch = toupper((unsigned char) *ch);
+
+    if (!strcmp(line, "QUIT"))
+    {
+        emit(session, "BYE\n");
+        session->state = SESSION_CLOSED;
+        return;
+    }
+
+    switch (session->state)
+    {
+        case SESSION_SEATING:
+            if (!strcmp(line, "SIT")) take_seats(session, args);
+            else emit(session, "ERR expected SIT\n");
+            break;
+        case SESSION_BETTING:
+            if (!strcmp(line, "BET")) take_bet(session, args);
+            else if (!strcmp(line, "Q")) leave_seat(session, session->seat);
+            else emit(session, "ERR expected BET or Q\n");
+            break;
+        case SESSION_INSURING:
+            if (!strcmp(line, "Y")) take_insurance_answer(session, true);
+            else if (!strcmp(line, "N")) take_insurance_answer(session, false);
+            else emit(session, "ERR expected Y or N\n");
+            break;
+        case SESSION_PLAYING:
+            if (!strcmp(line, "S")) take_choice(session, STAND);
+            else if (!strcmp(line, "H")) take_choice(session, HIT);
+            else if (!strcmp(line, "D")) take_choice(session, DOUBLE);
+            else if (!strcmp(line, "P")) take_choice(session, SPLIT);
+            else if (!strcmp(line, "R")) take_choice(session, SURRENDER);
+            else emit(session, "ERR expected S, H, D, P or R\n");
+            break;
+        case SESSION_CLOSED:
+            break;
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Seat the players at the table
+ *
+ *  Description: Give each named player a seat and the initial bank of $1,000, then set up and shuffle the shoe.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      names: space separated names of the players, 1 to 5 of them
+ *
+ *  Returns:
+ *      N/A
+ */
+static void take_seats(Session *session, char *names)
+{
+    uint8_t seats = 0;
+    char *save;
+    for (char *name = strtok_r(names, " \t", &save); name != NULL && seats < SESSION_MAX_SEATS;
+            name = strtok_r(NULL, " \t", &save))
+    {
+        Player *player = &session->players[seats];
+        snprintf(player->name, sizeof(player->name), "%s", name);
+        player->money = 1000;
+        player->hand.cards = NULL;
+        player->hand.bet = 0;
+        player->hand.nextHand = NULL;
+        session->seated |= 1u << seats++;
+    }
+
+    if (seats == 0)
+    {
+        emit(session, "ERR SIT needs 1 to %d names\n", SESSION_MAX_SEATS);
+        return;
+    }
+
+    session->table.shoe = init_deck(SESSION_DECKS);
+    if (session->table.shoe == NULL)
+    {
+        emit(session, "ERR no shoe\nBYE\n");
+        session->state = SESSION_CLOSED;
+        return;
+    }
+    shuffle_cards(session->table.shoe);
+
+    session->table.numPlayers = seats;
+    emit(session, "SEATED %u\n", seats);
+    start_betting(session);
+
+    return;
+}
+
+/***************
+ *  Summary: Clear the table and ask the first seat for a bet
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *
+ *  Returns:
+ *      N/A
+ */
+static void start_betting(Session *session)
+{
+    for (uint8_t seat = 0; seat < session->table.numPlayers; seat++)
+    {
+        clear_hands(&session->players[seat].hand);
+    }
+    clear_hands(&session->dealer.hand);
+    session->dealer.faceup = false;
+
+    session->state = SESSION_BETTING;
+    session->seat = next_seat(session, -1);
+    emit_bet(session);
+
+    return;
+}
+
+/***************
+ *  Summary: Take the bet of the seat being asked
+ *
+ *  Description: The bet must be between 0 and the player's money. Once every seat has bet the cards are dealt.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      arg: the amount bet
+ *
+ *  Returns:
+ *      N/A
+ */
+static void take_bet(Session *session, char *arg)
+{
+    Player *player = &session->players[session->seat];
+    char *endptr = NULL;
+
+    errno = 0;
+    long bet = strtol(arg, &endptr, 10);
+    if (errno != 0 || endptr == arg || bet < 0 || bet > player->money)
+    {
+        emit(session, "ERR bet must be between 0 and %u\n", player->money);
+        return;
+    }
+
+    player->hand.bet = (uint32_t) bet;
+    player->money -= (uint32_t) bet;
+
+    session->seat = next_seat(session, session->seat);
+    if (session->seat == SESSION_MAX_SEATS)
+    {
+        start_round(session);
+        return;
+    }
+
+    emit_bet(session);
+
+    return;
+}
+
+/***************
+ *  Summary: Remove a seat from the table
+ *
+ *  Description: Called when a player quits while betting or has no money left. The session closes once the last seat
+ *      leaves.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      seat: the seat leaving the table
+ *
+ *  Returns:
+ *      N/A
+ */
+static void leave_seat(Session *session, uint8_t seat)
+{
+    Player *player = &session->players[seat];
+    emit(session, "LEFT %u %s %u\n", seat + 1, player->name, player->money);
+    clear_hands(&player->hand);
+    session->seated &= ~(1u << seat);
+
+    if (session->seated == 0)
+    {
+        emit(session, "BYE\n");
+        session->state = SESSION_CLOSED;
+        return;
+    }
+
+    // a player quitting while betting passes the bet on to the next seat
+    if (session->state == SESSION_BETTING && seat == session->seat)
+    {
+        session->seat = next_seat(session, seat);
+        if (session->seat == SESSION_MAX_SEATS)
+        {
+            start_round(session);
+            return;
+        }
+        emit_bet(session);
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Deal the initial hands and start the first seat's turn
+ *
+ *  Description: Re-shuffles if needed and deals two cards to every seat and the dealer, shuffling the discards back
+ *      in if the shoe runs short. With an Ace showing each seat that can is offered insurance first, otherwise the
+ *      dealer is checked for blackjack straight away.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *
+ *  Returns:
+ *      N/A
+ */
+static void start_round(Session *session)
+{
+    Deck *shoe = session->table.shoe;
+    Hand *hands[SESSION_MAX_SEATS + 1];
+    uint8_t numHands = 0;
+
+    for (uint8_t seat = next_seat(session, -1); seat < SESSION_MAX_SEATS; seat = next_seat(session, seat))
+    {
+        hands[numHands++] = &session->players[seat].hand;
+    }
+    hands[numHands++] = &session->dealer.hand;
+
+    // a continuous shuffler takes the discards back every round, which isn't worth telling the client about
+    if (session->table.rules->continuousShuffle)
+    {
+        shuffle_discards(shoe);
+    }
+    else if (shoe_needs_shuffle(shoe) || !can_deal(shoe, SESSION_ROUND_CARDS))
+    {
+        shuffle_discards(shoe);
+        emit(session, "SHUFFLE\n");
+    }
+
+    if (!deal_round(shoe, hands, numHands))
+    {
+        shuffle_discards(shoe);
+        emit(session, "SHUFFLE\n");
+        if (!deal_round(shoe, hands, numHands))
+        {
+            emit(session, "ERR shoe too small\nBYE\n");
+            session->state = SESSION_CLOSED;
+            return;
+        }
+    }
+
+    char code[3];
+    card_code(dealer_upcard(&session->dealer.hand), code);
+    emit(session, "DEALER %s\n", code);
+    for (session->seat = next_seat(session, -1); session->seat < SESSION_MAX_SEATS;
+            session->seat = next_seat(session, session->seat))
+    {
+        emit_hand(session, &session->players[session->seat].hand, 1);
+    }
+
+    session->seat = next_insurable(session, -1);
+    if (session->seat < SESSION_MAX_SEATS)
+    {
+        session->state = SESSION_INSURING;
+        emit_insure(session);
+        return;
+    }
+
+    check_dealer(session);
+
+    return;
+}
+
+/***************
+ *  Summary: Find the next seat that can take insurance
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      seat: the seat to start looking after, -1 to start from the first seat
+ *
+ *  Returns:
+ *      seat: the next seat or SESSION_MAX_SEATS if there are no more seats
+ */
+static uint8_t next_insurable(Session *session, int seat)
+{
+    for (seat = next_seat(session, seat); seat < SESSION_MAX_SEATS; seat = next_seat(session, seat))
+    {
+        Player *player = &session->players[seat];
+        if (can_insure(&player->hand, &session->dealer.hand, player->money)) return seat;
+    }
+
+    return SESSION_MAX_SEATS;
+}
+
+/***************
+ *  Summary: Ask the seat being asked whether it wants insurance
+ *
+ *  Description: Sends the ten density of the cards the players haven't seen so a bot can decide exactly.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *
+ *  Returns:
+ *      N/A
+ */
+static void emit_insure(Session *session)
+{
+    uint16_t tens, cards;
+    unseen_tens(session->table.shoe, &session->dealer.hand, &tens, &cards);
+    emit(session, "INSURE %u %u %u\n", session->seat + 1, tens, cards);
+
+    return;
+}
+
+/***************
+ *  Summary: Take the insurance answer of the seat being asked
+ *
+ *  Description: Once every seat that can insure has answered the dealer checks for blackjack.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      insure: true if the seat takes insurance or even money
+ *
+ *  Returns:
+ *      N/A
+ */
+static void take_insurance_answer(Session *session, bool insure)
+{
+    Player *player = &session->players[session->seat];
+    if (insure) take_insurance(&player->hand, &player->money);
+
+    session->seat = next_insurable(session, session->seat);
+    if (session->seat < SESSION_MAX_SEATS)
+    {
+        emit_insure(session);
+        return;
+    }
+
+    check_dealer(session);
+
+    return;
+}
+
+/***************
+ *  Summary: Check the dealer for blackjack and start the first seat's turn
+ *
+ *  Description: Settles the insurance bets, then a dealer blackjack ends the round without the players taking a turn.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *
+ *  Returns:
+ *      N/A
+ */
+static void check_dealer(Session *session)
+{
+    bool dealerBlackjack = dealer_has_blackjack(&session->dealer.hand);
+
+    for (uint8_t seat = next_seat(session, -1); seat < SESSION_MAX_SEATS; seat = next_seat(session, seat))
+    {
+        Player *player = &session->players[seat];
+        if (player->hand.insurance == 0) continue;
+
+        uint32_t payout = settle_insurance(&player->hand, dealerBlackjack, &player->money);
+        emit(session, "INSURANCE %u %s %u %u\n", seat + 1, payout ? "WON" : "LOST", payout, player->money);
+    }
+
+    if (dealerBlackjack)
+    {
+        finish_round(session, true);
+        return;
+    }
+
+    session->state = SESSION_PLAYING;
+    session->seat = next_seat(session, -1);
+    session->hand = &session->players[session->seat].hand;
+    session->handNum = 1;
+    emit_turn(session);
+
+    return;
+}
+
+/***************
+ *  Summary: Play the choice made for the hand whose turn it is
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      choice: the PlayerChoice made
+ *
+ *  Returns:
+ *      N/A
+ */
+static void take_choice(Session *session, PlayerChoice choice)
+{
+    Player *player = &session->players[session->seat];
+    Hand *hand = session->hand;
+
+    ChoiceResult result = play_choice(hand, &player->money, session->table.shoe, choice, session->table.rules);
+    if (result == CHOICE_REFUSED)
+    {
+        emit(session, (choice == HIT) ? "ERR the shoe is out of cards\n"
+                : (choice == DOUBLE) ? "ERR can't double down on this hand\n"
+                : (choice == SPLIT) ? "ERR can't split this hand\n" : "ERR can't surrender this hand\n");
+    }
+    else if (choice != STAND && choice != SURRENDER)
+    {
+        emit_hand(session, hand, session->handNum);
+        if (choice == SPLIT) emit_hand(session, hand->nextHand, session->handNum + 1);
+    }
+
+    if (result == HAND_FINISHED)
+    {
+        next_hand(session);
+        return;
+    }
+
+    emit_turn(session);
+    return;
+}
+
+/***************
+ *  Summary: Move the turn on to the next hand
+ *
+ *  Description: Moves to the next split hand of the seat, then to the next seat. Once every hand has been played
+ *      the dealer plays and the round is settled.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *
+ *  Returns:
+ *      N/A
+ */
+static void next_hand(Session *session)
+{
+    session->hand = session->hand->nextHand;
+    session->handNum++;
+
+    if (session->hand == NULL)
+    {
+        session->seat = next_seat(session, session->seat);
+        if (session->seat == SESSION_MAX_SEATS)
+        {
+            finish_round(session, false);
+            return;
+        }
+        session->hand = &session->players[session->seat].hand;
+        session->handNum = 1;
+    }
+
+    emit_turn(session);
+    return;
+}
+
+/***************
+ *  Summary: Play the dealer's hand and settle every bet
+ *
+ *  Description: The dealer plays unless they have blackjack, then each hand is settled against the dealer's count
+ *      the same way check_table does. Seats with no money left leave the table before the next round of betting.
+ *
+ *  Parameter(s):
+ *      session: the Session struct
+ *      dealerBlackjack: true if the round ended on dealer blackjack
+ *
+ *  Returns:
+ *      N/A
+ */
+static void finish_round(Session *session, bool dealerBlackjack)
+{
+    static const char *results[] = {"LOST", "PUSH", "WON", "BLACKJACK", "SURRENDER"};
+    Hand *dealerHand = &session->dealer.hand;
+
+    if (!dealerBlackjack)
+    {
+        while (dealer_must_hit(dealerHand, session->table.rules))
+        {
+            if (!deal_card(session->table.shoe, dealerHand)) break;
+        }
+    }
+    session->dealer.faceup = true;
+
+    char codes[SESSION_LINE_MAX];
+    uint8_t dealerCount = blackjack_count(*dealerHand);
+    hand_codes(dealerHand, codes, sizeof(codes));
+    emit(session, "REVEAL %u %s\n", dealerCount, codes);
+
+    session->state = SESSION_BETTING;
+    if (session->live) session->live->rounds++;
+    for (uint8_t seat = next_seat(session, -1); seat < SESSION_MAX_SEATS; seat = next_seat(session, seat))
+    {
+        Player *player = &session->players[seat];
+        uint8_t handNum = 1;
+        for (Hand *hand = &player->hand; hand != NULL; hand = hand->nextHand, handNum++)
+        {
+            uint32_t payout;
+            HandResult result = settle_hand(hand, dealerCount, dealerBlackjack, session->table.rules, &player->money,
+                    &payout);
+            emit(session, "RESULT %u %u %s %u %u\n", seat + 1, handNum, results[result], payout, player->money);
+            if (session->live)
+            {
+                session->live->hands++;
+                session->live->wagered += hand->bet;
+                session->live->net += (int64_t) payout - hand->bet;
+            }
+        }
+
+        if (player->money == 0)
+        {
+            session->seat = SESSION_MAX_SEATS;
+            leave_seat(session, seat);
+            if (session->state == SESSION_CLOSED) return;
+        }
+    }
+
+    start_betting(session);
+    return;
+}
@@ -0,0 +1,119 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  session.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Description: A table of blackjack driven by a line based text protocol instead of the keyboard. The
+ *               session never blocks; input is fed in as it arrives and replies are collected in an
+ *               output buffer for the caller to write out.
+ *
+ *      client -> server                    server -> client
+ *      SIT <name> [<name> ...]             HELLO <version>
+ *      BET <amount> | Q                    SEATED <seats>
+ *      S | H | D | P | R                   BET <seat> <name> <money> <left> <count>
+ *      Y | N                               SHUFFLE
+ *      QUIT                                DEALER <upcard>
+ *                                          HAND <seat> <hand> <count> <cards>
+ *                                          INSURE <seat> <tens> <unseen>
+ *                                          INSURANCE <seat> WON|LOST <payout> <money>
+ *                                          TURN <seat> <hand> <count> <soft> <upcard> <left> <count> <choices> <cards>
+ *                                          REVEAL <count> <cards>
+ *                                          RESULT <seat> <hand> LOST|PUSH|WON|BLACKJACK|SURRENDER <payout> <money>
+ *                                          LEFT <seat> <name> <money>
+ *                                          ERR <reason>
+ *                                          BYE
+ *
+ *      Cards are sent as a rank and suit letter, e.g. AS, TD, 7H. <left> is the number of cards left in the shoe
+ *      and the <count> after it the Hi-Lo running count of the cards seen so far. <choices> lists the letters
+ *      allowed for the hand, e.g. SHD; R is surrender, offered only when the table's rules allow it.
+ *      INSURE asks a seat for insurance, or even money when it has blackjack, while the dealer shows an Ace.
+ *      <tens> and <unseen> are the ten valued cards and all cards the players haven't seen, hole card included;
+ *      insurance is worth taking when more than a third of them are tens. Y takes it and N declines.
+ */
+
+#ifndef SESSION_H_
+#define SESSION_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "blackjack.h"
+#include "deck_of_cards.h"
+#include "live_stats.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define SESSION_VERSION 4
+#define SESSION_MAX_SEATS 5
+#define SESSION_DECKS 6
+// cards left that start a round: every seat and the dealer drawing a full hand; a split the shoe can't cover is refused
+#define SESSION_ROUND_CARDS ((SESSION_MAX_SEATS + 1) * MAX_HAND_CARDS)
+#define SESSION_LINE_MAX 128
+
+typedef enum SessionState
+{
+    SESSION_SEATING, SESSION_BETTING, SESSION_INSURING, SESSION_PLAYING, SESSION_CLOSED
+} SessionState;
+
+typedef struct Session
+{
+    Table table;
+    Player players[SESSION_MAX_SEATS];
+    Dealer dealer;
+    uint8_t seated;                 // bit mask of the seats still at the table
+    SessionState state;
+    uint8_t seat;                   // seat being asked for a bet, insurance or a decision
+    Hand *hand;                     // hand of that seat being played
+    uint8_t handNum;
+    char line[SESSION_LINE_MAX];    // partial input line
+    uint16_t lineLen;
+    bool discard;                   // input line is too long and is being skipped
+    char *out;                      // replies waiting to be written
+    size_t outLen;
+    size_t outCap;
+    bool broken;                    // a reply couldn't be buffered, so the client can't follow the game any more
+    LiveSample *live;               // the worker's counts to add the session's hands to, may be NULL
+} Session;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+Session *session_new(const Rules *rules);
+void session_free(Session *session);
+bool session_feed(Session *session, const char *data, size_t len);
+void session_consume(Session *session, size_t bytes);
+
+#endif /* SESSION_H_ */
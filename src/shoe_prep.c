@@ -0,0 +1,267 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  shoe_prep.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The background shoe. random() keeps one state for the whole process, so the thread shuffles with its
+ *               own splitmix64 generator; the seeds come from random() on the dealing thread, at the swap that starts
+ *               each preparation. The spare cards are filled in order before every shuffle, so what a shoe deals
+ *               depends only on its seed.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "shoe_prep.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static void *prepare_shoes(void *arg);
+static uint64_t splitmix64(uint64_t *state);
+
+/***************
+ *  Summary: Draw a seed for a shoe from random()
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      seed: 62 random bits
+ */
+uint64_t shoe_prep_seed(void)
+{
+    return ((uint64_t) random() << 31) ^ (uint64_t) random();
+}
+
+/***************
+ *  Summary: Start preparing shoes for an ordered shoe
+ *
+ *  Description: Allocates the spare cards and starts the thread shuffling the first of them. The shoe keeps dealing
+ *      its current cards until shoe_prep_swap.
+ *
+ *  Parameter(s):
+ *      shoe: pointer to an ordered shoe of cards
+ *      seed: the seed for the first prepared shoe, normally from shoe_prep_seed
+ *
+ *  Returns:
+ *      prep: pointer to the ShoePrep struct or NULL if an error
+ */
+ShoePrep *shoe_prep_start(Deck *shoe, uint64_t seed)
+{
+    if (shoe->kind != SHOE_ORDERED)
+    {
+        zerror("Only an ordered shoe has cards to prepare.");
+        return NULL;
+    }
+
+    ShoePrep *prep = calloc(1, sizeof(ShoePrep));
+    Card *spare = malloc(shoe->cards * sizeof(Card));
+    if (prep == NULL || spare == NULL)
+    {
+        zerror("Couldn't allocate memory for the spare shoe.");
+        free(prep);
+        free(spare);
+        return NULL;
+    }
+    prep->shoe = shoe;
+    prep->spare = prep->owned = spare;
+    prep->seed = seed;
+
+    pthread_mutex_init(&prep->lock, NULL);
+    pthread_cond_init(&prep->wake, NULL);
+    pthread_cond_init(&prep->done, NULL);
+    if (pthread_create(&prep->thread, NULL, prepare_shoes, prep) != 0)
+    {
+        zerror("Couldn't start the shoe preparation thread.");
+        pthread_cond_destroy(&prep->done);
+        pthread_cond_destroy(&prep->wake);
+        pthread_mutex_destroy(&prep->lock);
+        free(spare);
+        free(prep);
+        return NULL;
+    }
+
+    return prep;
+}
+
+/***************
+ *  Summary: Swap the prepared shoe in
+ *
+ *  Description: Called where the shoe would be shuffled, with no hand holding a card. The shoe takes the spare cards
+ *      and the old ones go back to the thread to become the shoe after next, with a new seed from random(). Only
+ *      waits if the whole shoe was dealt faster than the thread could shuffle it.
+ *
+ *  Parameter(s):
+ *      prep: the ShoePrep struct
+ *
+ *  Returns:
+ *      N/A
+ */
+void shoe_prep_swap(ShoePrep *prep)
+{
+    pthread_mutex_lock(&prep->lock);
+    if (!prep->ready)
+    {
+        prep->waits++;
+        zdebug("Waiting for the next shoe, %llu waits so far.", (unsigned long long) prep->waits);
+        while (!prep->ready) pthread_cond_wait(&prep->done, &prep->lock);
+    }
+    prep->spare = replace_cards(prep->shoe, prep->spare);
+    prep->seed = shoe_prep_seed();
+    prep->ready = false;
+    pthread_cond_signal(&prep->wake);
+    pthread_mutex_unlock(&prep->lock);
+
+    return;
+}
+
+/***************
+ *  Summary: Stop preparing shoes
+ *
+ *  Description: Stops the thread and gives the shoe back its own cards, with the cards it is dealing and its deal
+ *      position as they are, so whoever allocated the shoe frees it as usual.
+ *
+ *  Parameter(s):
+ *      prep: the ShoePrep struct, can be NULL
+ *
+ *  Returns:
+ *      N/A
+ */
+void shoe_prep_stop(ShoePrep *prep)
+{
+    if (prep == NULL) return;
+
+    pthread_mutex_lock(&prep->lock);
+    prep->stopping = true;
+    pthread_cond_signal(&prep->wake);
+    pthread_mutex_unlock(&prep->lock);
+    pthread_join(prep->thread, NULL);
+
+    Deck *shoe = prep->shoe;
+    if (shoe->shoe == prep->owned)
+    {
+        memcpy(prep->spare, shoe->shoe, shoe->cards * sizeof(Card));
+        shoe->shoe = prep->spare;
+    }
+    zinfo("Shoe preparation stopped, %llu swaps waited for a shuffle.", (unsigned long long) prep->waits);
+
+    pthread_cond_destroy(&prep->done);
+    pthread_cond_destroy(&prep->wake);
+    pthread_mutex_destroy(&prep->lock);
+    free(prep->owned);
+    free(prep);
+
+    return;
+}
+
+/***************
+ *  Summary: Fisher-Yates shuffle driven by splitmix64 instead of random()
+ *
+ *  Description: What the thread shuffles each shoe with. Touches no shared state, so any thread can call it.
+ *
+ *  Parameter(s):
+ *      cards: the cards to shuffle
+ *      numCards: the number of cards
+ *      seed: seed for the shuffle's own generator
+ *
+ *  Returns:
+ *      N/A
+ */
+void shoe_prep_shuffle(Card *cards, uint16_t numCards, uint64_t seed)
+{
+    uint64_t state = seed;
+
+    for (int card = numCards - 1; card > 0; card--)
+    {
+        uint16_t swap = splitmix64(&state) % (card + 1);
+
+        Card cardTmp = cards[swap];
+        cards[swap] = cards[card];
+        cards[card] = cardTmp;
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: The preparation thread, shuffling the spare cards whenever they aren't ready
+ *
+ *  Parameter(s):
+ *      arg: the ShoePrep struct
+ *
+ *  Returns:
+ *      NULL
+ */
+static void *prepare_shoes(void *arg)
+{
+    ShoePrep *prep = arg;
+
+    pthread_mutex_lock(&prep->lock);
+    while (!prep->stopping)
+    {
+        if (prep->ready)
+        {
+            pthread_cond_wait(&prep->wake, &prep->lock);
+            continue;
+        }
+
+        // the dealer doesn't touch the spare cards or seed until they're ready
+        Card *cards = prep->spare;
+        uint64_t seed = prep->seed;
+        pthread_mutex_unlock(&prep->lock);
+
+        fill_cards(cards, prep->shoe->cards);
+        shoe_prep_shuffle(cards, prep->shoe->cards, seed);
+
+        pthread_mutex_lock(&prep->lock);
+        prep->ready = true;
+        pthread_cond_signal(&prep->done);
+    }
+    pthread_mutex_unlock(&prep->lock);
+
+    return NULL;
+}
+
+static uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+    return z ^ (z >> 31);
+}
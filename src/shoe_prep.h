@@ -0,0 +1,79 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  shoe_prep.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Shuffles the next shoe on a background thread while the current one is dealt, so reaching the cut card
+ *               swaps in the ready cards instead of stopping the round to shuffle. Each prepared shoe is dealt from
+ *               a fresh ordering shuffled with a seed the caller's thread draws from random(), so a seeded game or
+ *               simulation deals the same cards every run.
+ */
+
+#ifndef SHOE_PREP_H_
+#define SHOE_PREP_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "deck_of_cards.h"
+
+/***********
+ * DEFINES *
+ ***********/
+typedef struct ShoePrep
+{
+    Deck *shoe;
+    Card *spare;            // the next shoe's cards, being shuffled or ready
+    Card *owned;            // the cards allocated here, the shoe's own are given back to it when stopped
+    uint64_t seed;          // the seed the spare cards are shuffled with
+    bool ready;             // the spare cards are shuffled
+    bool stopping;
+    uint64_t waits;         // swaps that had to wait for the shuffle to finish
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;    // tells the thread there are cards to shuffle or to stop
+    pthread_cond_t done;    // tells the dealer the spare cards are ready
+} ShoePrep;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+uint64_t shoe_prep_seed(void);
+ShoePrep *shoe_prep_start(Deck *shoe, uint64_t seed);
+void shoe_prep_swap(ShoePrep *prep);
+void shoe_prep_stop(ShoePrep *prep);
+void shoe_prep_shuffle(Card *cards, uint16_t numCards, uint64_t seed);
+
+#endif /* SHOE_PREP_H_ */
@@ -0,0 +1,797 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  sim.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Headless blackjack simulator. Plays rounds as fast as it can with every seat using a strategy
+ *               plugin, or drawing to 17 like the dealer when there isn't one, and reports the results. Up to
+ *               hundreds of seats can play against one dealer hand; the round is settled as a SeatBatch. The shoe
+ *               can be a counted one, see init_counted_deck, for shoes of any size or an infinite shoe.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "blackjack.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "deck_of_cards.h"
+#include "engine.h"
+#include "seat_batch.h"
+#include "shoe_prep.h"
+#include "snapshot.h"
+#include "stream.h"
+#include "live_stats.h"
+#include "strategy.h"
+#include "phase_timer.h"
+#include "perf_counters.h"
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define SIM_ROUNDS 100000
+#define SIM_SEATS 5
+#define SIM_MAX_SEATS 512
+#define SIM_DECKS 6
+#define SIM_MAX_DECKS 255
+#define SIM_CARDS_PER_SEAT 4        // cards kept in the shoe past the cut card for each seat and the dealer
+#define SIM_BET 10
+#define SIM_BANKROLL 1000000000u   // large enough that no seat runs out of money
+#define SIM_CHECKPOINT_SECONDS 5    // how often a run with a checkpoint file saves to it
+#define SIM_CHECKPOINT_ROUNDS 1024  // rounds between looking at the clock
+
+typedef struct SimStats
+{
+    uint64_t rounds;
+    uint64_t shoes;
+    uint64_t hands;
+    uint64_t results[HAND_RESULTS]; // hands by HandResult
+    uint64_t insured;               // insurance bets and even money taken
+    int64_t insuranceNet;           // won less lost on the insurance bets
+    uint64_t wagered;
+    int64_t net;
+} SimStats;
+
+typedef struct Sim
+{
+    Deck *shoe;
+    Hand dealer;
+    Hand seats[SIM_MAX_SEATS];
+    Hand *round[SIM_MAX_SEATS + 1]; // the seats then the dealer, in the order deal_round deals to them
+    uint32_t money[SIM_MAX_SEATS];
+    uint16_t numSeats;
+    SeatBatch *batch;               // the round's hands, gathered to be settled together
+    ShoePrep *prep;                 // shuffles the next ordered shoe in the background
+    const Strategy *strategy;
+    const Rules *rules;
+    SimStats stats;
+    bool shortShoe;                 // a round couldn't be dealt even from a full shoe, which ends the run
+} Sim;
+
+typedef struct SimCheckpoint        // the state saved with the shoe and rules, to carry a run on from
+{
+    uint64_t rounds;                // rounds played
+    double seconds;                 // time spent playing them
+    uint64_t shoeSeed;              // seed of the shoe being prepared
+    SimStats stats;
+    uint16_t numSeats;
+    uint32_t money[SIM_MAX_SEATS];
+} SimCheckpoint;
+
+typedef void (*RoundLoop)(Sim *sim);
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static inline void play_round(Sim *sim, const Rules *rules) __attribute__((always_inline));
+RoundLoop pick_round_loop(const Rules *rules, const char **name);
+PlayerChoice sim_choice(Sim *sim, Hand *hand, uint32_t money, const Rules *rules);
+bool save_checkpoint(const char *path, Sim *sim, uint64_t rounds, double seconds);
+Snapshot *load_checkpoint(const char *path, Sim *sim, Rules *rules, uint64_t *rounds, double *seconds,
+        uint64_t *shoeSeed);
+int64_t sim_net(Sim *sim);
+void stream_stats(Stream *stream, Sim *sim, StreamKind kind, double seconds);
+void publish_stats(LiveStats *live, Sim *sim);
+void print_stats(FILE *out, SimStats *stats, double seconds);
+
+/***************
+ *  Summary: Round loops specialized for the common rule sets
+ *
+ *  Description: Each one inlines play_round with its preset as a compile-time constant, so the compiler folds the
+ *      rule checks in the round away, those in engine.h's inline play_choice and dealer_must_hit included. Other rules
+ *      use play_round_generic, which reads them from the Sim.
+ */
+#define SPECIALIZED_ROUND(name, preset) \
+    static void play_round_##name(Sim *sim) \
+    { \
+        static const Rules rules = preset; \
+        play_round(sim, &rules); \
+    }
+
+SPECIALIZED_ROUND(s17, RULES_S17_INIT)
+SPECIALIZED_ROUND(h17, RULES_H17_INIT)
+SPECIALIZED_ROUND(h17_6to5, RULES_H17_6TO5_INIT)
+
+static void play_round_generic(Sim *sim)
+{
+    play_round(sim, sim->rules);
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t rounds = SIM_ROUNDS;
+    long seats = SIM_SEATS;
+    long decks = SIM_DECKS;
+    const char *strategyPath = NULL;
+    const char *rulesPath = NULL;
+    const char *checkpointPath = NULL;
+    const char *streamPath = NULL;
+    uint64_t streamHands = 0;
+    ShoeKind kind = SHOE_ORDERED;
+    bool countEvents = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:p:d:s:R:S:C:J:N:c")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r':
+                rounds = strtoull(optarg, NULL, 10);
+                break;
+            case 'p':
+                seats = strtol(optarg, NULL, 10);
+                break;
+            case 'd':
+                decks = strtol(optarg, NULL, 10);
+                break;
+            case 's':
+                strategyPath = optarg;
+                break;
+            case 'R':
+                rulesPath = optarg;
+                break;
+            case 'S':
+                if (!strcmp(optarg, "ordered")) kind = SHOE_ORDERED;
+                else if (!strcmp(optarg, "counted")) kind = SHOE_COUNTED;
+                else if (!strcmp(optarg, "infinite")) kind = SHOE_INFINITE;
+                else
+                {
+                    fprintf(stderr, "Shoe must be ordered, counted or infinite.\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'C':
+                checkpointPath = optarg;
+                break;
+            case 'J':
+                streamPath = optarg;
+                break;
+            case 'N':
+                streamHands = strtoull(optarg, NULL, 10);
+                break;
+            case 'c':
+                countEvents = true;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-r rounds] [-p seats] [-d decks] [-S ordered|counted|infinite] "
+                        "[-s strategy.so] [-R rules.conf] [-C checkpoint] [-J results.jsonl|-] [-N hands] [-c]\n",
+                        argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    long maxDecks = (kind == SHOE_ORDERED) ? SIM_MAX_DECKS : MAX_COUNTED_DECKS;
+    if (seats < 1 || seats > SIM_MAX_SEATS || decks < 1 || decks > maxDecks)
+    {
+        fprintf(stderr, "Seats must be 1 to %d and decks 1 to %ld.\n", SIM_MAX_SEATS, maxDecks);
+        return EXIT_FAILURE;
+    }
+    // the cards left at the cut card have to cover a round, or the last round of a shoe would deal past its end
+    long minDecks = (long) ((seats + 1) * SIM_CARDS_PER_SEAT / (CARDS_IN_DECK * RESHUFFLE_POINT)) + 1;
+    if (kind != SHOE_INFINITE && decks < minDecks)
+    {
+        fprintf(stderr, "%ld seats need at least %ld decks.\n", seats, minDecks);
+        return EXIT_FAILURE;
+    }
+
+#if DEBUG
+    seed_random(1968);
+#else
+    seed_random(time(NULL));
+#endif
+
+    if (init_zlog("sim.conf", "log")) return EXIT_FAILURE;
+
+    Rules rules = RULES_S17;
+    if (rulesPath && !load_rules(rulesPath, &rules))
+    {
+        fprintf(stderr, "Couldn't read rules file %s, see the log.\n", rulesPath);
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    Sim sim = {.numSeats = seats, .rules = &rules};
+    if (strategyPath && !(sim.strategy = load_strategy(strategyPath)))
+    {
+        fprintf(stderr, "Couldn't load strategy plugin %s.\n", strategyPath);
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    // an existing checkpoint carries its run on: the shoe, rules, seats and stats all come from it
+    uint64_t roundsDone = 0;
+    double secondsDone = 0;
+    uint64_t shoeSeed = 0;
+    Snapshot *snapshot = NULL;
+    if (checkpointPath && access(checkpointPath, F_OK) == 0)
+    {
+        snapshot = load_checkpoint(checkpointPath, &sim, &rules, &roundsDone, &secondsDone, &shoeSeed);
+        if (snapshot == NULL)
+        {
+            fprintf(stderr, "Couldn't restore checkpoint %s, see the log.\n", checkpointPath);
+            unload_strategy();
+            end_zlog();
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        if (kind == SHOE_ORDERED) sim.shoe = init_deck(decks);
+        else sim.shoe = init_counted_deck((kind == SHOE_INFINITE) ? INFINITE_DECKS : decks);
+        if (sim.shoe == NULL)
+        {
+            end_zlog();
+            return EXIT_FAILURE;
+        }
+        shuffle_cards(sim.shoe);
+        sim.stats.shoes = 1;
+        shoeSeed = shoe_prep_seed();
+        for (uint16_t seat = 0; seat < sim.numSeats; seat++)
+        {
+            sim.money[seat] = SIM_BANKROLL;
+        }
+    }
+    if (streamPath && !streamHands && rules.continuousShuffle)
+    {
+        fprintf(stderr, "A continuous shuffler has no shoes to stream summaries by, give -N hands.\n");
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+    const char *loopName;
+    RoundLoop play = pick_round_loop(&rules, &loopName);
+
+    for (uint16_t seat = 0; seat < sim.numSeats; seat++)
+    {
+        sim.round[seat] = &sim.seats[seat];
+    }
+    sim.round[sim.numSeats] = &sim.dealer;
+    sim.batch = seat_batch_new(sim.numSeats * rules.maxHands);
+    bool prepare = (sim.shoe->kind == SHOE_ORDERED && !rules.continuousShuffle);
+    if (prepare) sim.prep = shoe_prep_start(sim.shoe, shoeSeed);
+    if (sim.batch == NULL || (prepare && sim.prep == NULL))
+    {
+        end_zlog();
+        return EXIT_FAILURE;
+    }
+
+    // hardware counters are optional; without them the run goes ahead and just doesn't report them
+    PerfCounters counters;
+    uint64_t eventsStart[PERF_EVENTS], eventsEnd[PERF_EVENTS];
+    if (countEvents && !(countEvents = perf_counters_open(&counters)))
+    {
+        fprintf(stderr, "Hardware counters not available, see the log. Continuing without them.\n");
+    }
+    if (countEvents)
+    {
+        PHASE_COUNT_EVENTS(&counters);
+        perf_counters_read(&counters, eventsStart);
+    }
+
+    // streamed JSON lines take stdout over, so the report goes to stderr instead
+    Stream *stream = NULL;
+    FILE *report = stdout;
+    if (streamPath)
+    {
+        if (!(stream = stream_open(streamPath, 1)))
+        {
+            fprintf(stderr, "Couldn't open stream %s, see the log.\n", streamPath);
+            end_zlog();
+            return EXIT_FAILURE;
+        }
+        if (!strcmp(streamPath, STREAM_STDOUT)) report = stderr;
+    }
+
+    // without shared memory the run goes ahead, it just can't be watched with blackjack_top
+    LiveStats *live = live_stats_open("sim", 1);
+
+    PHASE_DUMP_ON(SIGUSR1);
+    struct timespec start, end, saved;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    saved = start;
+    uint64_t nextStream = sim.stats.hands + streamHands;
+    for (uint64_t round = roundsDone; round < rounds; round++)
+    {
+        // a summary per shoe goes out just before the round that shuffles, or every streamHands hands
+        if (stream && (streamHands ? sim.stats.hands >= nextStream : shoe_needs_shuffle(sim.shoe) && sim.stats.hands))
+        {
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            stream_stats(stream, &sim, streamHands ? STREAM_HANDS : STREAM_SHOE,
+                    secondsDone + (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+            nextStream = sim.stats.hands + streamHands;
+        }
+        play(&sim);
+        if (sim.shortShoe)
+        {
+            fprintf(stderr, "The shoe is too small to deal a round to %u seats, stopping.\n", sim.numSeats);
+            break;
+        }
+        PHASE_POLL(stderr);
+        if ((round + 1) % SIM_CHECKPOINT_ROUNDS == 0)
+        {
+            publish_stats(live, &sim);
+            if (checkpointPath)
+            {
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                if (end.tv_sec - saved.tv_sec >= SIM_CHECKPOINT_SECONDS)
+                {
+                    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+                    save_checkpoint(checkpointPath, &sim, round + 1, secondsDone + seconds);
+                    saved = end;
+                }
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (countEvents) perf_counters_read(&counters, eventsEnd);
+    double seconds = secondsDone + (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    if (checkpointPath) save_checkpoint(checkpointPath, &sim, (rounds > roundsDone) ? rounds : roundsDone, seconds);
+    if (stream)
+    {
+        stream_stats(stream, &sim, STREAM_FINAL, seconds);
+        stream_close(stream);
+    }
+    live_stats_close(live);
+
+    sim.stats.net += sim_net(&sim);
+    fprintf(report, "Round loop:  %s\n", loopName);
+    fprintf(report, "Hand eval:   %s\n", hand_eval_kernel());
+    print_stats(report, &sim.stats, seconds);
+    if (countEvents)
+    {
+        for (uint8_t event = 0; event < PERF_EVENTS; event++)
+        {
+            if (eventsEnd[event] != PERF_UNAVAILABLE) eventsEnd[event] -= eventsStart[event];
+        }
+        perf_counters_header(report, "");
+        perf_counters_report(report, "per hand", eventsEnd, sim.stats.hands);
+    }
+    PHASE_REPORT(report);
+    if (countEvents)
+    {
+        PHASE_COUNT_EVENTS(NULL);
+        perf_counters_close(&counters);
+    }
+
+    shoe_prep_stop(sim.prep);
+    seat_batch_free(sim.batch);
+    if (snapshot)
+    {
+        snapshot_close(snapshot);   // the shoe lives in the mapped checkpoint
+    }
+    else
+    {
+        free(sim.shoe->shoe);
+        free(sim.shoe);
+    }
+    unload_strategy();
+    end_zlog();
+
+    return sim.shortShoe ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/***************
+ *  Summary: Play one round at every seat
+ *
+ *  Description: The same steps as play_game: bets, the initial deal, insurance, the dealer peek, the players' hands,
+ *      the dealer's hand and settling up, then clearing the table for the next round. Always inlined into a round
+ *      loop, see SPECIALIZED_ROUND. A round the shoe can't deal even after the discards go back in sets shortShoe
+ *      instead.
+ *
+ *  Parameter(s):
+ *      sim: the Sim struct
+ *      rules: the Rules to play by
+ *
+ *  Returns:
+ *      N/A
+ */
+static inline void play_round(Sim *sim, const Rules *rules)
+{
+    Deck *shoe = sim->shoe;
+    if (rules->continuousShuffle)
+    {
+        PHASE_START(shuffleStart);
+        shuffle_discards(shoe);
+        PHASE_END(PHASE_SHUFFLE, shuffleStart);
+    }
+    else if (shoe_needs_shuffle(shoe) || (shoe->cards - shoe->deal) < (sim->numSeats + 1) * INITIAL_CARDS)
+    {
+        PHASE_START(shuffleStart);
+        if (sim->prep) shoe_prep_swap(sim->prep);
+        else shuffle_discards(shoe);
+        PHASE_END(PHASE_SHUFFLE, shuffleStart);
+        sim->stats.shoes++;
+    }
+
+    PHASE_START(betsStart);
+    for (uint16_t seat = 0; seat < sim->numSeats; seat++)
+    {
+        uint32_t bet = sim->strategy ? strategy_bet(sim->strategy, shoe, sim->money[seat], rules) : SIM_BET;
+        sim->seats[seat].bet = bet;
+        sim->money[seat] -= bet;
+    }
+    PHASE_END(PHASE_BETS, betsStart);
+
+    PHASE_START(dealStart);
+    if (!deal_round(shoe, sim->round, sim->numSeats + 1))
+    {
+        // the shoe ran short, so take the discards back and try again; if even that can't go round, the bets are
+        // handed back and the run ends
+        shuffle_discards(shoe);
+        sim->stats.shoes++;
+        if (!deal_round(shoe, sim->round, sim->numSeats + 1))
+        {
+            for (uint16_t seat = 0; seat < sim->numSeats; seat++)
+            {
+                sim->money[seat] += sim->seats[seat].bet;
+                sim->seats[seat].bet = 0;
+            }
+            sim->shortShoe = true;
+            PHASE_END(PHASE_DEAL, dealStart);
+            return;
+        }
+    }
+    PHASE_END(PHASE_DEAL, dealStart);
+
+    PHASE_START(checkStart);
+    if (sim->strategy && dealer_upcard(&sim->dealer)->value == 11)
+    {
+        for (uint16_t seat = 0; seat < sim->numSeats; seat++)
+        {
+            Hand *hand = &sim->seats[seat];
+            if (can_insure(hand, &sim->dealer, sim->money[seat])
+                    && strategy_insure(sim->strategy, hand, &sim->dealer, shoe, sim->money[seat], rules))
+            {
+                take_insurance(hand, &sim->money[seat]);
+                sim->stats.insured++;
+            }
+        }
+    }
+    bool dealerBlackjack = dealer_has_blackjack(&sim->dealer);
+    for (uint16_t seat = 0; seat < sim->numSeats; seat++)
+    {
+        Hand *hand = &sim->seats[seat];
+        if (hand->insurance == 0) continue;
+
+        uint32_t insurance = hand->insurance;
+        sim->stats.insuranceNet += (int64_t) settle_insurance(hand, dealerBlackjack, &sim->money[seat]) - insurance;
+    }
+    PHASE_END(PHASE_DEALER_CHECK, checkStart);
+    if (!dealerBlackjack)
+    {
+        PHASE_START(handsStart);
+        for (uint16_t seat = 0; seat < sim->numSeats; seat++)
+        {
+            for (Hand *hand = &sim->seats[seat]; hand != NULL; hand = hand->nextHand)
+            {
+                while (play_choice(hand, &sim->money[seat], shoe, sim_choice(sim, hand, sim->money[seat], rules), rules)
+                        == HAND_CONTINUES);
+            }
+        }
+        PHASE_END(PHASE_PLAY_HANDS, handsStart);
+
+        PHASE_START(dealerStart);
+        while (dealer_must_hit(&sim->dealer, rules))
+        {
+            if (!deal_card(shoe, &sim->dealer)) break;
+        }
+        PHASE_END(PHASE_DEALER_HAND, dealerStart);
+    }
+
+    PHASE_START(settleStart);
+    SeatBatch *batch = sim->batch;
+    uint8_t dealerCount = blackjack_count(sim->dealer);
+    seat_batch_clear(batch);
+    for (uint16_t seat = 0; seat < sim->numSeats; seat++)
+    {
+        for (Hand *hand = &sim->seats[seat]; hand != NULL; hand = hand->nextHand)
+        {
+            if (!seat_batch_add(batch, seat, hand))
+            {
+                // settle a hand the batch can't take on its own, so its bet still counts
+                uint32_t payout;
+                HandResult result = settle_hand(hand, dealerCount, dealerBlackjack, rules, &sim->money[seat], &payout);
+                sim->stats.results[result]++;
+                sim->stats.wagered += hand->bet;
+                sim->stats.hands++;
+            }
+        }
+        clear_hands(&sim->seats[seat]);
+    }
+    settle_batch(batch, dealerCount, dealerBlackjack, rules);
+    credit_batch(batch, sim->money);
+    for (uint32_t ii = 0; ii < batch->count; ii++)
+    {
+        sim->stats.wagered += batch->bet[ii];
+        sim->stats.results[batch->result[ii]]++;
+    }
+    sim->stats.hands += batch->count;
+    clear_hands(&sim->dealer);
+    PHASE_END(PHASE_SETTLE, settleStart);
+    sim->stats.rounds++;
+
+    return;
+}
+
+/***************
+ *  Summary: Choose what to do with a hand
+ *
+ *  Description: Asks the strategy plugin, or without one hits below 17 and stands otherwise. A refused choice from
+ *      the plugin has already been turned into a stand by strategy_decide.
+ *
+ *  Parameter(s):
+ *      sim: the Sim struct
+ *      hand: the Hand struct to decide on
+ *      money: the seat's money
+ *      rules: the Rules being played
+ *
+ *  Returns:
+ *      PlayerChoice: the choice made
+ */
+PlayerChoice sim_choice(Sim *sim, Hand *hand, uint32_t money, const Rules *rules)
+{
+    if (sim->strategy)
+    {
+        return strategy_decide(sim->strategy, hand, &sim->dealer, sim->shoe, money, rules);
+    }
+
+    return dealer_must_hit_s17(hand) ? HIT : STAND;
+}
+
+/***************
+ *  Summary: Pick the round loop for a set of rules
+ *
+ *  Parameter(s):
+ *      rules: the Rules to play by
+ *      name: set to a description of the loop picked
+ *
+ *  Returns:
+ *      RoundLoop: a specialized loop if the rules match a preset, otherwise the generic one
+ */
+RoundLoop pick_round_loop(const Rules *rules, const char **name)
+{
+    static const struct
+    {
+        const Rules *rules;
+        RoundLoop loop;
+        const char *name;
+    } loops[] =
+    {
+        {&RULES_S17, play_round_s17, "S17 (specialized)"},
+        {&RULES_H17, play_round_h17, "H17 (specialized)"},
+        {&RULES_H17_6TO5, play_round_h17_6to5, "H17 6:5 (specialized)"},
+    };
+
+    for (uint8_t loop = 0; loop < sizeof(loops) / sizeof(loops[0]); loop++)
+    {
+        if (rules_equal(rules, loops[loop].rules))
+        {
+            *name = loops[loop].name;
+            return loops[loop].loop;
+        }
+    }
+
+    *name = "generic";
+    return play_round_generic;
+}
+
+/***************
+ *  Summary: Save the run to its checkpoint file
+ *
+ *  Description: The shoe and rules go in the snapshot's table, with no players and an empty dealer since the sim
+ *      keeps its own hands; the seats' money and the stats go in as the snapshot's extra block.
+ *
+ *  Parameter(s):
+ *      path: the checkpoint file
+ *      sim: the Sim struct, between rounds
+ *      rounds: rounds played so far
+ *      seconds: time spent playing them
+ *
+ *  Returns:
+ *      bool: false if the checkpoint couldn't be saved
+ */
+bool save_checkpoint(const char *path, Sim *sim, uint64_t rounds, double seconds)
+{
+    static SimCheckpoint checkpoint;
+    Dealer dealer = {0};
+    Table table = {.numPlayers = 0, .dealer = &dealer, .shoe = sim->shoe, .rules = sim->rules};
+
+    checkpoint.rounds = rounds;
+    checkpoint.seconds = seconds;
+    checkpoint.shoeSeed = sim->prep ? sim->prep->seed : 0;
+    checkpoint.stats = sim->stats;
+    checkpoint.numSeats = sim->numSeats;
+    memcpy(checkpoint.money, sim->money, sizeof(uint32_t) * sim->numSeats);
+
+    return snapshot_save(path, &table, &checkpoint, offsetof(SimCheckpoint, money) + sizeof(uint32_t) * sim->numSeats);
+}
+
+/***************
+ *  Summary: Carry a run on from its checkpoint file
+ *
+ *  Parameter(s):
+ *      path: the checkpoint file
+ *      sim: the Sim struct to restore the shoe, seats and stats into
+ *      rules: the Rules to restore the run's rules into
+ *      rounds: set to the rounds already played
+ *      seconds: set to the time spent playing them
+ *      shoeSeed: set to the seed of the shoe that was being prepared
+ *
+ *  Returns:
+ *      snapshot: the mapped checkpoint the shoe lives in, NULL if an error
+ */
+Snapshot *load_checkpoint(const char *path, Sim *sim, Rules *rules, uint64_t *rounds, double *seconds,
+        uint64_t *shoeSeed)
+{
+    Table table = {0};
+    Snapshot *snapshot = snapshot_restore(path, &table, rules);
+    if (snapshot == NULL) return NULL;
+
+    const SimCheckpoint *checkpoint = snapshot->extra;
+    if (snapshot->extraSize < offsetof(SimCheckpoint, money) || checkpoint->numSeats < 1
+            || checkpoint->numSeats > SIM_MAX_SEATS
+            || snapshot->extraSize != offsetof(SimCheckpoint, money) + sizeof(uint32_t) * checkpoint->numSeats)
+    {
+        zerror("Checkpoint %s doesn't hold a sim run.", path);
+        snapshot_close(snapshot);
+        return NULL;
+    }
+
+    sim->shoe = table.shoe;
+    sim->numSeats = checkpoint->numSeats;
+    sim->stats = checkpoint->stats;
+    memcpy(sim->money, checkpoint->money, sizeof(uint32_t) * checkpoint->numSeats);
+    *rounds = checkpoint->rounds;
+    *seconds = checkpoint->seconds;
+    *shoeSeed = checkpoint->shoeSeed;
+    zinfo("Carrying on from round %llu with %u seats.", (unsigned long long) *rounds, sim->numSeats);
+
+    return snapshot;
+}
+
+/***************
+ *  Summary: Stream a summary of the run so far
+ *
+ *  Parameter(s):
+ *      stream: the Stream to push it to
+ *      sim: the Sim struct, between rounds
+ *      kind: what the summary marks, the end of a shoe, so many hands or the end of the run
+ *      seconds: elapsed time of the run
+ *
+ *  Returns:
+ *      N/A
+ */
+void stream_stats(Stream *stream, Sim *sim, StreamKind kind, double seconds)
+{
+    StreamSummary summary = {.kind = kind, .worker = 0, .rounds = sim->stats.rounds, .shoes = sim->stats.shoes,
+            .hands = sim->stats.hands, .insured = sim->stats.insured, .wagered = sim->stats.wagered,
+            .seconds = seconds};
+    memcpy(summary.results, sim->stats.results, sizeof(summary.results));
+    summary.net = sim_net(sim);
+    stream_push(stream, &summary);
+
+    return;
+}
+
+/***************
+ *  Summary: Publish the run so far for blackjack_top
+ *
+ *  Parameter(s):
+ *      live: the LiveStats struct, or NULL if the run isn't published
+ *      sim: the Sim struct, between rounds
+ *
+ *  Returns:
+ *      N/A
+ */
+void publish_stats(LiveStats *live, Sim *sim)
+{
+    if (live == NULL) return;
+
+    LiveSample sample = {.rounds = sim->stats.rounds, .hands = sim->stats.hands, .wagered = sim->stats.wagered,
+            .net = sim_net(sim)};
+    PHASE_LATENCIES(sample.phases);
+    live_stats_publish(live, 0, &sample);
+
+    return;
+}
+
+/***************
+ *  Summary: Add up what the seats have won or lost
+ *
+ *  Parameter(s):
+ *      sim: the Sim struct, between rounds
+ *
+ *  Returns:
+ *      net: the seats' money less what they started with
+ */
+int64_t sim_net(Sim *sim)
+{
+    int64_t net = 0;
+    for (uint16_t seat = 0; seat < sim->numSeats; seat++)
+    {
+        net += (int64_t) sim->money[seat] - SIM_BANKROLL;
+    }
+
+    return net;
+}
+
+/***************
+ *  Summary: Print the results of the run
+ *
+ *  Parameter(s):
+ *      out: the stream to print to
+ *      stats: the SimStats struct
+ *      seconds: elapsed time of the run
+ *
+ *  Returns:
+ *      N/A
+ */
+void print_stats(FILE *out, SimStats *stats, double seconds)
+{
+    fprintf(out, "Rounds:      %llu\n", (unsigned long long) stats->rounds);
+    fprintf(out, "Hands:       %llu\n", (unsigned long long) stats->hands);
+    fprintf(out, "Won:         %llu\n", (unsigned long long) stats->results[HAND_WON]);
+    fprintf(out, "Blackjacks:  %llu\n", (unsigned long long) stats->results[HAND_BLACKJACK]);
+    fprintf(out, "Surrendered: %llu\n", (unsigned long long) stats->results[HAND_SURRENDERED]);
+    fprintf(out, "Insured:     %llu (net %lld)\n", (unsigned long long) stats->insured,
+            (long long) stats->insuranceNet);
+    fprintf(out, "Pushed:      %llu\n", (unsigned long long) stats->results[HAND_PUSH]);
+    fprintf(out, "Lost:        %llu\n", (unsigned long long) stats->results[HAND_LOST]);
+    fprintf(out, "Wagered:     %llu\n", (unsigned long long) stats->wagered);
+    fprintf(out, "Net:         %lld\n", (long long) stats->net);
+    fprintf(out, "EV:          %+.3f%%\n", stats->wagered ? 100.0 * stats->net / stats->wagered : 0.0);
+    fprintf(out, "Time:        %.3f s (%.0f hands/s)\n", seconds, seconds > 0 ? stats->hands / seconds : 0.0);
+
+    return;
+}
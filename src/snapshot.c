@@ -0,0 +1,341 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  snapshot.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Saving and restoring Table snapshots. A snapshot is written to a temporary file and renamed over the
+ *               old one, so a crash while saving leaves the previous snapshot in place. Restoring maps the file
+ *               privately: the table plays on from the mapping, and changes are never written back to the file.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "snapshot.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define SNAPSHOT_ALIGN 16
+#define ALIGN_UP(size) (((size) + SNAPSHOT_ALIGN - 1) & ~(uint64_t) (SNAPSHOT_ALIGN - 1))
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static uint16_t shoe_cards(const Deck *shoe);
+static bool hand_is_empty(const Hand *hand);
+static bool section_fits(const SnapshotHeader *header, uint64_t offset, uint64_t size);
+static bool restore_counts(Deck *shoe);
+
+/***************
+ *  Summary: Save a snapshot of the table
+ *
+ *  Description: Snapshots are taken between rounds, so the hands must have no cards in them; the linked lists of cards
+ *      are the only part of a Table that can't be written out as is. The sections are copied into one buffer with
+ *      the Deck's pointer to its cards replaced by the cards' offset, and written with a single write.
+ *
+ *  Parameter(s):
+ *      path: the snapshot file
+ *      table: the Table to save, its players, dealer, shoe and rules
+ *      extra: a block of the caller's own state to save with the table, can be NULL
+ *      extraSize: the size of extra
+ *
+ *  Returns:
+ *      bool: false if the table is mid round or the file couldn't be written
+ */
+bool snapshot_save(const char *path, const Table *table, const void *extra, size_t extraSize)
+{
+    for (uint8_t player = 0; player < table->numPlayers; player++)
+    {
+        if (!hand_is_empty(&table->players[player].hand))
+        {
+            zerror("Snapshot not saved, %s still has cards.", table->players[player].name);
+            return false;
+        }
+    }
+    if (!hand_is_empty(&table->dealer->hand))
+    {
+        zerror("Snapshot not saved, the dealer still has cards.");
+        return false;
+    }
+
+    SnapshotHeader header = {.magic = SNAPSHOT_MAGIC, .version = SNAPSHOT_VERSION};
+    if (!save_random(header.random)) return false;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.playerSize = sizeof(Player);
+    header.dealerSize = sizeof(Dealer);
+    header.deckSize = sizeof(Deck);
+    header.cardSize = sizeof(Card);
+    header.rulesSize = sizeof(Rules);
+    header.numPlayers = table->numPlayers;
+    header.numCards = shoe_cards(table->shoe);
+
+    header.rules = ALIGN_UP(sizeof(SnapshotHeader));
+    header.players = ALIGN_UP(header.rules + sizeof(Rules));
+    header.dealer = ALIGN_UP(header.players + sizeof(Player) * header.numPlayers);
+    header.shoe = ALIGN_UP(header.dealer + sizeof(Dealer));
+    header.cards = ALIGN_UP(header.shoe + sizeof(Deck));
+    header.extra = ALIGN_UP(header.cards + sizeof(Card) * header.numCards);
+    header.extraSize = extra ? extraSize : 0;
+    header.fileSize = header.extra + header.extraSize;
+
+    char *image = calloc(1, header.fileSize);
+    if (image == NULL)
+    {
+        zerror("Snapshot memory allocation failed.");
+        return false;
+    }
+    memcpy(image, &header, sizeof(header));
+    memcpy(image + header.rules, table->rules, sizeof(Rules));
+    if (header.numPlayers) memcpy(image + header.players, table->players, sizeof(Player) * header.numPlayers);
+    memcpy(image + header.dealer, table->dealer, sizeof(Dealer));
+    memcpy(image + header.cards, table->shoe->shoe, sizeof(Card) * header.numCards);
+    if (header.extraSize) memcpy(image + header.extra, extra, header.extraSize);
+
+    Deck *shoe = (Deck *) (image + header.shoe);
+    *shoe = *table->shoe;
+    shoe->shoe = (Card *) (uintptr_t) header.cards;
+
+    // write next to the old snapshot and rename over it, so there is always a whole snapshot on disk
+    char tempPath[PATH_MAX];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool saved = (fd >= 0);
+    if (saved)
+    {
+        saved = (write(fd, image, header.fileSize) == (ssize_t) header.fileSize);
+        saved = (close(fd) == 0) && saved;
+        saved = saved && (rename(tempPath, path) == 0);
+        if (!saved) unlink(tempPath);
+    }
+    free(image);
+
+    if (!saved)
+    {
+        zerror("Couldn't write snapshot %s.", path);
+        return false;
+    }
+    zdebug("Snapshot %s saved, %llu bytes.", path, (unsigned long long) header.fileSize);
+
+    return true;
+}
+
+/***************
+ *  Summary: Restore a snapshot of a table
+ *
+ *  Description: Maps the snapshot file, checks it was written by a build with the same struct layout, that its
+ *      sections are inside the file and that the seats, shoe and cards in them make sense, then points the table's
+ *      players, dealer and shoe into the mapping. The counts of the cards left are worked out again, see
+ *      restore_counts. The rules are copied out and the random number generator is put back where it was. Nothing is
+ *      allocated for the table, so the players, dealer and shoe must not be freed; snapshot_close unmaps them.
+ *
+ *  Parameter(s):
+ *      path: the snapshot file
+ *      table: the Table to restore into; only numPlayers, players, dealer and shoe are set
+ *      rules: the Rules to copy the snapshot's rules into
+ *
+ *  Returns:
+ *      snapshot: pointer to the Snapshot struct or NULL if an error
+ */
+Snapshot *snapshot_restore(const char *path, Table *table, Rules *rules)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        zerror("Couldn't open snapshot %s.", path);
+        return NULL;
+    }
+
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(SnapshotHeader))
+    {
+        base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        zerror("Couldn't map snapshot %s.", path);
+        return NULL;
+    }
+
+    SnapshotHeader *header = base;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) || header->version != SNAPSHOT_VERSION
+            || header->headerSize != sizeof(SnapshotHeader) || header->playerSize != sizeof(Player)
+            || header->dealerSize != sizeof(Dealer) || header->deckSize != sizeof(Deck)
+            || header->cardSize != sizeof(Card) || header->rulesSize != sizeof(Rules)
+            || header->fileSize != (uint64_t) st.st_size)
+    {
+        zerror("Snapshot %s isn't a version %d snapshot from this build.", path, SNAPSHOT_VERSION);
+        munmap(base, st.st_size);
+        return NULL;
+    }
+
+    char *image = base;
+    Deck *shoe = (Deck *) (image + header->shoe);
+    if (!section_fits(header, header->rules, sizeof(Rules))
+            || !section_fits(header, header->players, (uint64_t) sizeof(Player) * header->numPlayers)
+            || !section_fits(header, header->dealer, sizeof(Dealer))
+            || !section_fits(header, header->shoe, sizeof(Deck))
+            || !section_fits(header, header->cards, (uint64_t) sizeof(Card) * header->numCards)
+            || !section_fits(header, header->extra, header->extraSize)
+            || header->numPlayers > MAX_PLAYERS || (uint32_t) shoe->kind > SHOE_INFINITE || shoe->deal > shoe->cards
+            || (uintptr_t) shoe->shoe != header->cards || shoe_cards(shoe) != header->numCards)
+    {
+        zerror("Snapshot %s is damaged.", path);
+        munmap(base, st.st_size);
+        return NULL;
+    }
+
+    // the pointer fix-up; the hands were saved empty so the only pointer inside the sections is the shoe's
+    shoe->shoe = (Card *) (image + header->cards);
+    if (!restore_counts(shoe))
+    {
+        zerror("Snapshot %s has damaged cards.", path);
+        munmap(base, st.st_size);
+        return NULL;
+    }
+
+    Snapshot *snapshot = calloc(1, sizeof(Snapshot));
+    if (snapshot == NULL)
+    {
+        zerror("Snapshot memory allocation failed.");
+        munmap(base, st.st_size);
+        return NULL;
+    }
+    snapshot->base = base;
+    snapshot->size = st.st_size;
+    snapshot->extra = header->extraSize ? image + header->extra : NULL;
+    snapshot->extraSize = header->extraSize;
+
+    table->numPlayers = header->numPlayers;
+    table->players = (Player *) (image + header->players);
+    table->dealer = (Dealer *) (image + header->dealer);
+    table->shoe = shoe;
+    memcpy(rules, image + header->rules, sizeof(Rules));
+    restore_random(header->random);
+    zinfo("Snapshot %s restored: %u players, %u of %u cards dealt.", path, table->numPlayers, shoe->deal, shoe->cards);
+
+    return snapshot;
+}
+
+/***************
+ *  Summary: Unmap a restored snapshot
+ *
+ *  Description: The players, dealer and shoe restored from the snapshot go with it.
+ *
+ *  Parameter(s):
+ *      snapshot: the Snapshot struct
+ *
+ *  Returns:
+ *      N/A
+ */
+void snapshot_close(Snapshot *snapshot)
+{
+    if (snapshot == NULL) return;
+
+    munmap(snapshot->base, snapshot->size);
+    free(snapshot);
+
+    return;
+}
+
+/***************
+ *  Summary: Return the number of cards the shoe keeps, all of them or the single deck of a counted shoe
+ */
+static uint16_t shoe_cards(const Deck *shoe)
+{
+    return (shoe->kind == SHOE_ORDERED) ? shoe->cards : CARDS_IN_DECK;
+}
+
+static bool hand_is_empty(const Hand *hand)
+{
+    return (hand->cards == NULL && hand->nextHand == NULL);
+}
+
+/***************
+ *  Summary: Check a section of the snapshot is aligned and inside the file
+ */
+static bool section_fits(const SnapshotHeader *header, uint64_t offset, uint64_t size)
+{
+    return (offset % SNAPSHOT_ALIGN == 0 && offset >= sizeof(SnapshotHeader) && offset <= header->fileSize
+            && size <= header->fileSize - offset);
+}
+
+/***************
+ *  Summary: Check the restored cards and count the ones left to deal
+ *
+ *  Description: Every card must have a value of 2 to 11 and names that end inside the Card, since the values index
+ *      the counts and the names are printed. An ordered shoe's counts are worked out again from the cards after the
+ *      deal rather than trusted. A counted shoe's counts are its only record of what has been dealt, so they're
+ *      checked against the cards left and what the decks hold instead.
+ */
+static bool restore_counts(Deck *shoe)
+{
+    for (uint16_t card = 0; card < shoe_cards(shoe); card++)
+    {
+        const Card *restored = &shoe->shoe[card];
+        if (restored->value < 2 || restored->value > 11 || !memchr(restored->rank, '\0', sizeof(restored->rank))
+                || !memchr(restored->suit, '\0', sizeof(restored->suit))
+                || !memchr(restored->face, '\0', sizeof(restored->face)))
+        {
+            return false;
+        }
+    }
+
+    if (shoe->kind == SHOE_ORDERED)
+    {
+        memset(shoe->remaining, 0, sizeof(shoe->remaining));
+        for (uint16_t card = shoe->deal; card < shoe->cards; card++)
+        {
+            shoe->remaining[VALUE_INDEX(shoe->shoe[card].value)]++;
+        }
+        return true;
+    }
+
+    uint32_t left = 0;
+    uint16_t decks = shoe->cards / CARDS_IN_DECK;
+    for (uint8_t value = 2; value <= 11; value++)
+    {
+        if (shoe->remaining[VALUE_INDEX(value)] > decks * ((value == 10) ? 16 : 4)) return false;
+        left += shoe->remaining[VALUE_INDEX(value)];
+    }
+
+    return (left == (uint32_t) (shoe->cards - shoe->deal));
+}
@@ -0,0 +1,99 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  snapshot.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Binary snapshots of a Table between rounds: the players and their money, the dealer, the shoe in its
+ *               current order and deal position, the rules and the random number generator. The file is laid out
+ *               the way the structs are in memory, with offsets in place of pointers, so a snapshot is restored by
+ *               mapping the file and turning the offsets back into pointers. A caller can add a block of its own
+ *               state to the snapshot as well.
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "blackjack.h"
+#include "deck_of_cards.h"
+#include "rules.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define SNAPSHOT_MAGIC "BJSNAP"
+#define SNAPSHOT_VERSION 3
+
+typedef struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint16_t headerSize;            // the sizes of the structs written, so a build with a different layout is refused
+    uint16_t playerSize;
+    uint16_t dealerSize;
+    uint16_t deckSize;
+    uint16_t cardSize;
+    uint16_t rulesSize;
+    uint64_t fileSize;
+    uint64_t rules;                 // offsets of the sections from the start of the file
+    uint64_t players;
+    uint64_t dealer;
+    uint64_t shoe;
+    uint64_t cards;
+    uint64_t extra;
+    uint64_t extraSize;
+    uint16_t numCards;
+    uint8_t numPlayers;
+    char random[RANDOM_STATE_SIZE];
+} SnapshotHeader;
+
+typedef struct Snapshot
+{
+    void *base;                     // the mapped file, which the restored players, dealer and shoe live in
+    size_t size;
+    void *extra;                    // the caller's block of state, NULL if there wasn't one
+    size_t extraSize;
+} Snapshot;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+bool snapshot_save(const char *path, const Table *table, const void *extra, size_t extraSize);
+Snapshot *snapshot_restore(const char *path, Table *table, Rules *rules);
+void snapshot_close(Snapshot *snapshot);
+
+#endif /* SNAPSHOT_H_ */
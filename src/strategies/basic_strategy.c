@@ -0,0 +1,202 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  basic_strategy.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Example strategy plugin playing basic strategy for a dealer standing on all 17s, with a bet that
+ *               rises with the Hi-Lo true count, taking insurance only when the unseen cards are rich enough in
+ *               tens. Build with "make strategies" and run "blackjack -s ./strategies/basic_strategy.so".
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "../strategy.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define BASE_BET 10
+
+/****************
+ * DECLARATIONS *
+ ****************/
+const Strategy *blackjack_strategy(void);
+static uint32_t basic_bet(const StrategyView *view, void *state);
+static PlayerChoice basic_decide(const StrategyView *view, void *state);
+static bool basic_insure(const StrategyView *view, void *state);
+
+static const Strategy basicStrategy =
+{
+    .abiVersion = STRATEGY_ABI_VERSION,
+    .name = "basic strategy",
+    .bet = basic_bet,
+    .decide = basic_decide,
+    .insure = basic_insure,
+    .state = NULL,
+};
+
+/***************
+ *  Summary: Plugin entry point
+ *
+ *  Returns:
+ *      strategy: this plugin's Strategy struct
+ */
+const Strategy *blackjack_strategy(void)
+{
+    return &basicStrategy;
+}
+
+/***************
+ *  Summary: Bet one unit plus a unit for each point of true count above one
+ *
+ *  Description: The running count is worked out from the cards of each value dealt so far, and divided by the decks
+ *      left in the shoe to get the true count.
+ *
+ *  Parameter(s):
+ *      view: the StrategyView
+ *      state: unused
+ *
+ *  Returns:
+ *      bet: the amount to bet
+ */
+static uint32_t basic_bet(const StrategyView *view, void *state)
+{
+    (void) state;
+    int count = 0;
+
+    for (uint8_t value = 2; value <= 6; value++)
+    {
+        count += view->decks * 4 - view->remaining[VALUE_INDEX(value)];
+    }
+    count -= view->decks * 16 - view->remaining[VALUE_INDEX(10)];
+    count -= view->decks * 4 - view->remaining[VALUE_INDEX(11)];
+
+    int trueCount = (view->cardsLeft >= CARDS_IN_DECK) ? count / (view->cardsLeft / CARDS_IN_DECK) : count;
+    uint32_t units = (trueCount > 1) ? trueCount : 1;
+
+    return units * BASE_BET;
+}
+
+/***************
+ *  Summary: Play basic strategy
+ *
+ *  Parameter(s):
+ *      view: the StrategyView
+ *      state: unused
+ *
+ *  Returns:
+ *      PlayerChoice: the choice for the hand
+ */
+static PlayerChoice basic_decide(const StrategyView *view, void *state)
+{
+    (void) state;
+    uint8_t up = view->upcard->value;
+    uint8_t count = view->count;
+
+    // late surrender 16 against 9, ten or Ace and 15 against a ten, unless a pair of 8s can be split instead
+    if (view->canSurrender && !view->soft && !view->canSplit
+            && ((count == 16 && up >= 9) || (count == 15 && up == 10)))
+    {
+        return SURRENDER;
+    }
+
+    if (view->canSplit)
+    {
+        uint8_t pair = view->hand->cards->card->value;
+        switch (pair)
+        {
+            case 11:
+            case 8:
+                return SPLIT;
+            case 2:
+            case 3:
+            case 7:
+                if (up <= 7) return SPLIT;
+                break;
+            case 4:
+                if (up == 5 || up == 6) return SPLIT;
+                break;
+            case 6:
+                if (up <= 6) return SPLIT;
+                break;
+            case 9:
+                if (up != 7 && up < 10) return SPLIT;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (view->soft)
+    {
+        if (count >= 19) return STAND;
+        if (count == 18)
+        {
+            if (up >= 3 && up <= 6) return view->canDouble ? DOUBLE : STAND;
+            return (up >= 9) ? HIT : STAND;
+        }
+        if (view->canDouble && ((count == 17 && up >= 3 && up <= 6) || (count >= 15 && up >= 4 && up <= 6) ||
+                (count >= 13 && (up == 5 || up == 6))))
+        {
+            return DOUBLE;
+        }
+        return HIT;
+    }
+
+    if (count >= 17) return STAND;
+    if (count >= 13) return (up <= 6) ? STAND : HIT;
+    if (count == 12) return (up >= 4 && up <= 6) ? STAND : HIT;
+    if (view->canDouble && view->hand->cards->nextCard->nextCard == NULL)
+    {
+        if (count == 11 && up <= 10) return DOUBLE;
+        if (count == 10 && up <= 9) return DOUBLE;
+        if (count == 9 && up >= 3 && up <= 6) return DOUBLE;
+    }
+
+    return HIT;
+}
+
+/***************
+ *  Summary: Take insurance when it pays
+ *
+ *  Description: Insurance, and even money on a blackjack, is worth taking when more than a third of the unseen cards
+ *      are tens.
+ *
+ *  Parameter(s):
+ *      view: the StrategyView, with the unseen tens and cards
+ *      state: unused
+ *
+ *  Returns:
+ *      bool: true to take insurance
+ */
+static bool basic_insure(const StrategyView *view, void *state)
+{
+    (void) state;
+    return (3 * (uint32_t) view->unseenTens > view->unseenCards);
+}
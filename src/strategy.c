@@ -0,0 +1,243 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  strategy.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Load a strategy plugin and call it on behalf of the players.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "strategy.h"
+
+#include <dlfcn.h>
+#include <string.h>
+
+#include "engine.h"
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+static void *pluginHandle = NULL;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+
+/***************
+ *  Summary: Load a strategy plugin
+ *
+ *  Description: Opens the shared object and asks it for its Strategy struct, checking it was built against this
+ *      version of the interface. Only one plugin is loaded at a time.
+ *
+ *  Parameter(s):
+ *      path: path of the shared object; include a / to load from a directory rather than the library path
+ *
+ *  Returns:
+ *      strategy: pointer to the plugin's Strategy struct or NULL if an error
+ */
+const Strategy *load_strategy(const char *path)
+{
+    unload_strategy();
+
+    pluginHandle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (pluginHandle == NULL)
+    {
+        zerror("Couldn't load strategy %s: %s", path, dlerror());
+        return NULL;
+    }
+
+    StrategyEntry entry;
+    *(void **) &entry = dlsym(pluginHandle, STRATEGY_SYMBOL);
+    const Strategy *strategy = entry ? entry() : NULL;
+    if (strategy == NULL || strategy->abiVersion != STRATEGY_ABI_VERSION || !strategy->bet || !strategy->decide)
+    {
+        zerror("%s is not a strategy plugin for ABI version %d.", path, STRATEGY_ABI_VERSION);
+        unload_strategy();
+        return NULL;
+    }
+
+    zinfo("Loaded strategy %s from %s.", strategy->name, path);
+    return strategy;
+}
+
+/***************
+ *  Summary: Unload the strategy plugin
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void unload_strategy(void)
+{
+    if (pluginHandle != NULL)
+    {
+        dlclose(pluginHandle);
+        pluginHandle = NULL;
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Fill in the view a strategy decides from
+ *
+ *  Description: Points the view at the hand and the shoe's counts rather than copying them, and works out the count
+ *      and the choices allowed so every plugin doesn't have to. While the dealer's hole card is face down the counts
+ *      are copied into unseen with it put back, so the view holds only what the player can see, the same as
+ *      unseen_tens; an infinite shoe's counts don't change as it's dealt, so there's nothing to put back.
+ *
+ *  Parameter(s):
+ *      view: the StrategyView to fill in
+ *      unseen: room for CARD_VALUES counts, which the view points at while the hole card is face down
+ *      hand: the hand to decide on or NULL when betting
+ *      dealerHand: the dealer's Hand struct with the hole card face down, or NULL when betting
+ *      shoe: the shoe being dealt from
+ *      money: the player's money not already bet
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      N/A
+ */
+void strategy_view(StrategyView *view, uint16_t *unseen, Hand *hand, Hand *dealerHand, Deck *shoe, uint32_t money,
+        const Rules *rules)
+{
+    view->hand = hand;
+    view->upcard = dealerHand ? dealer_upcard(dealerHand) : NULL;
+    view->remaining = shoe->remaining;
+    view->cardsLeft = shoe->cards - shoe->deal;
+    if (dealerHand && dealerHand->cards && shoe->kind != SHOE_INFINITE)
+    {
+        memcpy(unseen, shoe->remaining, sizeof(shoe->remaining));
+        unseen[VALUE_INDEX(dealerHand->cards->card->value)]++;
+        view->remaining = unseen;
+        view->cardsLeft++;
+    }
+    view->decks = shoe->cards / CARDS_IN_DECK;
+    view->rules = rules;
+    view->money = money;
+    view->count = hand ? blackjack_count(*hand) : 0;
+    view->soft = hand ? hand_is_soft(hand) : false;
+    view->canDouble = hand ? can_double(hand, money, rules) : false;
+    view->canSplit = hand ? can_split(hand, money, rules) : false;
+    view->canSurrender = hand ? can_surrender(hand, rules) : false;
+    view->unseenTens = 0;
+    view->unseenCards = 0;
+
+    return;
+}
+
+/***************
+ *  Summary: Ask the strategy for a bet
+ *
+ *  Parameter(s):
+ *      strategy: the loaded Strategy
+ *      shoe: the shoe being dealt from
+ *      money: the player's money
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      bet: the amount to bet, never more than money
+ */
+uint32_t strategy_bet(const Strategy *strategy, Deck *shoe, uint32_t money, const Rules *rules)
+{
+    StrategyView view;
+    strategy_view(&view, NULL, NULL, NULL, shoe, money, rules);
+
+    uint32_t bet = strategy->bet(&view, strategy->state);
+    return (bet > money) ? money : bet;
+}
+
+/***************
+ *  Summary: Ask the strategy for a decision on a hand
+ *
+ *  Description: A choice the hand isn't allowed is turned into STAND, so a misbehaving plugin can't keep the game
+ *      asking forever.
+ *
+ *  Parameter(s):
+ *      strategy: the loaded Strategy
+ *      hand: the hand to decide on
+ *      dealerHand: the dealer's Hand struct
+ *      shoe: the shoe being dealt from
+ *      money: the player's money not already bet
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      PlayerChoice: the choice made
+ */
+PlayerChoice strategy_decide(const Strategy *strategy, Hand *hand, Hand *dealerHand, Deck *shoe, uint32_t money,
+        const Rules *rules)
+{
+    StrategyView view;
+    uint16_t unseen[CARD_VALUES];
+    strategy_view(&view, unseen, hand, dealerHand, shoe, money, rules);
+
+    PlayerChoice choice = strategy->decide(&view, strategy->state);
+    if ((choice == DOUBLE && !view.canDouble) || (choice == SPLIT && !view.canSplit)
+            || (choice == SURRENDER && !view.canSurrender) || (unsigned) choice > SURRENDER)
+    {
+        zerror("Strategy %s chose %d which isn't allowed. Standing.", strategy->name, choice);
+        choice = STAND;
+    }
+
+    return choice;
+}
+
+/***************
+ *  Summary: Ask the strategy whether to take insurance, or even money on a blackjack
+ *
+ *  Description: Only asked for hands that pass can_insure. The view carries the unseen tens and cards so the plugin
+ *      can use the exact chance of the hole card being a ten.
+ *
+ *  Parameter(s):
+ *      strategy: the loaded Strategy
+ *      hand: the hand being offered insurance
+ *      dealerHand: the dealer's Hand struct
+ *      shoe: the shoe being dealt from
+ *      money: the player's money not already bet
+ *      rules: the table's Rules
+ *
+ *  Returns:
+ *      bool: true to take insurance
+ */
+bool strategy_insure(const Strategy *strategy, Hand *hand, Hand *dealerHand, Deck *shoe, uint32_t money,
+        const Rules *rules)
+{
+    if (strategy->insure == NULL) return false;
+
+    StrategyView view;
+    uint16_t unseen[CARD_VALUES];
+    strategy_view(&view, unseen, hand, dealerHand, shoe, money, rules);
+    unseen_tens(shoe, dealerHand, &view.unseenTens, &view.unseenCards);
+
+    return strategy->insure(&view, strategy->state);
+}
@@ -0,0 +1,101 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  strategy.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The interface for strategy plugins. A plugin is a shared object exporting a function named
+ *               blackjack_strategy that returns a pointer to its Strategy struct. The game calls the plugin's
+ *               callbacks instead of asking the player for bets and decisions.
+ *
+ *               Callbacks get a StrategyView pointing straight at the game's own hand and shoe counts; nothing is
+ *               copied, so the view is only valid for the duration of the call and must not be modified.
+ */
+
+#ifndef STRATEGY_H_
+#define STRATEGY_H_
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "deck_of_cards.h"
+#include "engine.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define STRATEGY_ABI_VERSION 4
+#define STRATEGY_SYMBOL "blackjack_strategy"
+
+typedef struct StrategyView
+{
+    const Hand *hand;           // hand to decide on, NULL when betting
+    const Card *upcard;         // dealer's upcard, NULL when betting
+    const uint16_t *remaining;  // cards of each value the player hasn't seen, hole card included, by VALUE_INDEX()
+    uint16_t cardsLeft;         // cards the player hasn't seen, hole card included
+    uint16_t decks;             // decks in the shoe, up to MAX_COUNTED_DECKS when counted
+    const Rules *rules;         // house rules of the table
+    uint32_t money;             // player's money not already bet
+    uint8_t count;              // count of the hand
+    bool soft;                  // count uses an Ace as 11
+    bool canDouble;
+    bool canSplit;
+    bool canSurrender;
+    uint16_t unseenTens;        // when offered insurance: ten valued cards not seen, counting the hole card as unseen
+    uint16_t unseenCards;       // when offered insurance: cards not seen, including the hole card
+} StrategyView;
+
+typedef struct Strategy
+{
+    uint32_t abiVersion;        // STRATEGY_ABI_VERSION the plugin was built against
+    const char *name;
+    uint32_t (*bet)(const StrategyView *view, void *state);
+    PlayerChoice (*decide)(const StrategyView *view, void *state);
+    // take insurance or even money; NULL never does. Insurance pays 2:1, so it gains when more than a third of the
+    // unseen cards are tens: 3 * unseenTens > unseenCards
+    bool (*insure)(const StrategyView *view, void *state);
+    void *state;                // passed back to the callbacks untouched
+} Strategy;
+
+typedef const Strategy *(*StrategyEntry)(void);
+
+/****************
+ * DECLARATIONS *
+ ****************/
+const Strategy *load_strategy(const char *path);
+void unload_strategy(void);
+void strategy_view(StrategyView *view, uint16_t *unseen, Hand *hand, Hand *dealerHand, Deck *shoe, uint32_t money,
+        const Rules *rules);
+uint32_t strategy_bet(const Strategy *strategy, Deck *shoe, uint32_t money, const Rules *rules);
+PlayerChoice strategy_decide(const Strategy *strategy, Hand *hand, Hand *dealerHand, Deck *shoe, uint32_t money,
+        const Rules *rules);
+bool strategy_insure(const Strategy *strategy, Hand *hand, Hand *dealerHand, Deck *shoe, uint32_t money,
+        const Rules *rules);
+
+#endif /* STRATEGY_H_ */
@@ -0,0 +1,252 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  stream.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The JSON lines writer. The writer thread empties every queue it finds summaries in, then formats and
+ *               writes them without holding the lock and flushes once per batch, so a reader following the file sees
+ *               whole lines as soon as they're written.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+/***********
+ * DEFINES *
+ ***********/
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static void *write_summaries(void *arg);
+static void write_summary(FILE *out, const StreamSummary *summary);
+
+/***************
+ *  Summary: Open a stream and start its writer thread
+ *
+ *  Parameter(s):
+ *      path: the file to write the JSON lines to, truncated if it exists, or STREAM_STDOUT
+ *      workers: the number of workers pushing summaries, each gets its own queue
+ *
+ *  Returns:
+ *      stream: pointer to the Stream struct or NULL if an error
+ */
+Stream *stream_open(const char *path, uint16_t workers)
+{
+    // the writer's batch is allocated here so a writer that couldn't get one never leaves the workers waiting
+    Stream *stream = calloc(1, sizeof(Stream));
+    StreamQueue *queues = calloc(workers, sizeof(StreamQueue));
+    StreamSummary *batch = malloc((size_t) workers * STREAM_QUEUE * sizeof(StreamSummary));
+    if (stream == NULL || queues == NULL || batch == NULL)
+    {
+        zerror("Couldn't allocate memory for the stream.");
+        free(stream);
+        free(queues);
+        free(batch);
+        return NULL;
+    }
+
+    stream->out = strcmp(path, STREAM_STDOUT) ? fopen(path, "w") : stdout;
+    if (stream->out == NULL)
+    {
+        zerror("Couldn't open stream file %s.", path);
+        free(stream);
+        free(queues);
+        free(batch);
+        return NULL;
+    }
+    stream->queues = queues;
+    stream->numQueues = workers;
+    stream->batch = batch;
+
+    pthread_mutex_init(&stream->lock, NULL);
+    pthread_cond_init(&stream->ready, NULL);
+    for (uint16_t worker = 0; worker < workers; worker++)
+    {
+        pthread_cond_init(&queues[worker].notFull, NULL);
+    }
+    if (pthread_create(&stream->writer, NULL, write_summaries, stream) != 0)
+    {
+        zerror("Couldn't start the stream writer thread.");
+        stream->writer = pthread_self();
+        stream->closing = true;
+        stream_close(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+/***************
+ *  Summary: Hand a summary to the writer
+ *
+ *  Description: Copies the summary into the worker's queue. Waits only if the queue is full, which holds the worker
+ *      back to the pace the output is written at.
+ *
+ *  Parameter(s):
+ *      stream: the Stream struct
+ *      summary: the summary, with the worker set to the queue to use
+ *
+ *  Returns:
+ *      N/A
+ */
+void stream_push(Stream *stream, const StreamSummary *summary)
+{
+    StreamQueue *queue = &stream->queues[summary->worker % stream->numQueues];
+
+    pthread_mutex_lock(&stream->lock);
+    if (queue->count == STREAM_QUEUE)
+    {
+        stream->stalls++;
+        while (queue->count == STREAM_QUEUE) pthread_cond_wait(&queue->notFull, &stream->lock);
+    }
+    queue->summaries[(queue->head + queue->count) % STREAM_QUEUE] = *summary;
+    if (queue->count++ == 0) pthread_cond_signal(&stream->ready);
+    pthread_mutex_unlock(&stream->lock);
+
+    return;
+}
+
+/***************
+ *  Summary: Close a stream
+ *
+ *  Description: The writer writes out everything still queued before it stops. A file is closed, stdout is only
+ *      flushed.
+ *
+ *  Parameter(s):
+ *      stream: the Stream struct, can be NULL
+ *
+ *  Returns:
+ *      N/A
+ */
+void stream_close(Stream *stream)
+{
+    if (stream == NULL) return;
+
+    pthread_mutex_lock(&stream->lock);
+    stream->closing = true;
+    pthread_cond_signal(&stream->ready);
+    pthread_mutex_unlock(&stream->lock);
+    if (!pthread_equal(stream->writer, pthread_self())) pthread_join(stream->writer, NULL);
+
+    if (stream->stalls) zinfo("Stream output held workers back %llu times.", (unsigned long long) stream->stalls);
+    if (stream->out == stdout) fflush(stdout);
+    else fclose(stream->out);
+    for (uint16_t worker = 0; worker < stream->numQueues; worker++)
+    {
+        pthread_cond_destroy(&stream->queues[worker].notFull);
+    }
+    pthread_cond_destroy(&stream->ready);
+    pthread_mutex_destroy(&stream->lock);
+    free(stream->queues);
+    free(stream->batch);
+    free(stream);
+
+    return;
+}
+
+/***************
+ *  Summary: The writer thread
+ *
+ *  Description: Takes a batch of everything queued into the stream's batch, freeing the queues for the workers
+ *      straight away, and writes it out unlocked.
+ *
+ *  Parameter(s):
+ *      arg: the Stream struct
+ *
+ *  Returns:
+ *      NULL
+ */
+static void *write_summaries(void *arg)
+{
+    Stream *stream = arg;
+    StreamSummary *batch = stream->batch;
+
+    pthread_mutex_lock(&stream->lock);
+    while (true)
+    {
+        uint32_t numBatch = 0;
+        for (uint16_t worker = 0; worker < stream->numQueues; worker++)
+        {
+            StreamQueue *queue = &stream->queues[worker];
+            if (queue->count == 0) continue;
+
+            for (; queue->count; queue->count--, queue->head = (queue->head + 1) % STREAM_QUEUE)
+            {
+                batch[numBatch++] = queue->summaries[queue->head];
+            }
+            pthread_cond_signal(&queue->notFull);
+        }
+
+        if (numBatch == 0)
+        {
+            if (stream->closing) break;
+            pthread_cond_wait(&stream->ready, &stream->lock);
+            continue;
+        }
+
+        pthread_mutex_unlock(&stream->lock);
+        for (uint32_t summary = 0; summary < numBatch; summary++)
+        {
+            write_summary(stream->out, &batch[summary]);
+        }
+        if (fflush(stream->out)) zerror("Couldn't write %u summaries to the stream.", numBatch);
+        pthread_mutex_lock(&stream->lock);
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    return NULL;
+}
+
+/***************
+ *  Summary: Write a summary as one line of JSON
+ */
+static void write_summary(FILE *out, const StreamSummary *summary)
+{
+    static const char *kinds[] = {"shoe", "hands", "final"};
+
+    fprintf(out, "{\"type\":\"%s\",\"worker\":%u,\"rounds\":%llu,\"shoes\":%llu,\"hands\":%llu,"
+            "\"won\":%llu,\"blackjacks\":%llu,\"pushed\":%llu,\"lost\":%llu,\"surrendered\":%llu,\"insured\":%llu,"
+            "\"wagered\":%llu,\"net\":%lld,\"ev\":%.6f,\"seconds\":%.3f}\n",
+            kinds[summary->kind], summary->worker, (unsigned long long) summary->rounds,
+            (unsigned long long) summary->shoes, (unsigned long long) summary->hands,
+            (unsigned long long) summary->results[HAND_WON], (unsigned long long) summary->results[HAND_BLACKJACK],
+            (unsigned long long) summary->results[HAND_PUSH], (unsigned long long) summary->results[HAND_LOST],
+            (unsigned long long) summary->results[HAND_SURRENDERED], (unsigned long long) summary->insured,
+            (unsigned long long) summary->wagered, (long long) summary->net,
+            summary->wagered ? (double) summary->net / summary->wagered : 0.0, summary->seconds);
+
+    return;
+}
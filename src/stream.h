@@ -0,0 +1,108 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  stream.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Streams a run's progress as JSON lines, one summary per shoe or per so many hands, to stdout or a file
+ *               that can be followed while the run goes on. Each worker hands its summaries to a writer thread through
+ *               a bounded queue of its own, so formatting and writing never happen on a worker; a worker only waits
+ *               when its queue is full because the output can't keep up.
+ */
+
+#ifndef STREAM_H_
+#define STREAM_H_
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+/************
+ * INCLUDES *
+ ************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "engine.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define STREAM_STDOUT "-"           // path to stream to stdout
+#define STREAM_QUEUE 64             // summaries a worker can have waiting to be written
+
+typedef enum StreamKind
+{
+    STREAM_SHOE,                    // at the end of a shoe
+    STREAM_HANDS,                   // every so many hands
+    STREAM_FINAL                    // at the end of the run
+} StreamKind;
+
+typedef struct StreamSummary        // the run so far, all counts from its start
+{
+    StreamKind kind;
+    uint16_t worker;
+    uint64_t rounds;
+    uint64_t shoes;
+    uint64_t hands;
+    uint64_t results[HAND_SURRENDERED + 1]; // hands by HandResult
+    uint64_t insured;
+    uint64_t wagered;
+    int64_t net;
+    double seconds;
+} StreamSummary;
+
+typedef struct StreamQueue          // one worker's summaries, a ring of STREAM_QUEUE
+{
+    StreamSummary summaries[STREAM_QUEUE];
+    uint32_t head;                  // next to write out
+    uint32_t count;
+    pthread_cond_t notFull;
+} StreamQueue;
+
+typedef struct Stream
+{
+    FILE *out;
+    StreamQueue *queues;
+    uint16_t numQueues;
+    StreamSummary *batch;           // the writer's copy of everything queued, written out unlocked
+    uint64_t stalls;                // times a worker waited on a full queue
+    bool closing;
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;           // tells the writer there are summaries or it's closing
+} Stream;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+Stream *stream_open(const char *path, uint16_t workers);
+void stream_push(Stream *stream, const StreamSummary *summary);
+void stream_close(Stream *stream);
+
+#endif /* STREAM_H_ */
@@ -0,0 +1,248 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  text_output.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: The plain text renderer behind text_output.h.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#include "text_output.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "logger.h"
+
+/****************
+ * DECLARATIONS *
+ ****************/
+static void text_open(void);
+static void text_close(void);
+static void text_idle(void);
+static void text_table(Table *table);
+static void text_dealer(Dealer *dealer);
+static void text_player(Player *player);
+static void text_message(const char *msg);
+static uint8_t text_num_players(uint8_t max);
+static bool text_name(uint8_t seat, char *name, int size);
+static bool text_read_line(const char *prompt, char *line, int size);
+static PlayerChoice text_choice(Player *player, bool surrender);
+static bool text_yes_no(const char *question);
+static bool read_answer(const char *prompt, char *line, int size);
+
+const Renderer TEXT_RENDERER = {.name = "text", .open = text_open, .close = text_close, .seat = text_table,
+        .table = text_table, .dealer = text_dealer, .player = text_player, .message = text_message,
+        .pause = text_idle, .num_players = text_num_players, .player_name = text_name, .read_line = text_read_line,
+        .choice = text_choice, .yes_no = text_yes_no};
+
+static void text_open(void)
+{
+    puts("*** WELCOME TO BLACKJACK ***");
+    puts("Time to play cards to 21 without going over. Go up against the house to win money. You'll get $1,000 to");
+    puts("start with in your quest to earn more. Lose it all and your game is over. Good luck!");
+
+    return;
+}
+
+static void text_close(void)
+{
+    puts("Game over.");
+    fflush(stdout);
+
+    return;
+}
+
+static void text_idle(void)
+{
+    return;     // the play stays on the screen to be read back, so there's no need to wait
+}
+
+static void text_table(Table *table)
+{
+    text_dealer(table->dealer);
+    for (uint8_t player = 0; player < table->numPlayers; player++)
+    {
+        text_player(&table->players[player]);
+    }
+
+    return;
+}
+
+static void text_dealer(Dealer *dealer)
+{
+    char handString[HAND_STRING_SIZE];
+
+    if (!dealer->hand.cards) return;    // nothing dealt yet
+
+    hand_to_string(&dealer->hand, handString, sizeof(handString), dealer->faceup);
+    printf("%s: %s\n", dealer->name, handString);
+
+    return;
+}
+
+static void text_player(Player *player)
+{
+    char handString[HAND_STRING_SIZE];
+
+    printf("%s ($%u)", player->name, player->money);
+    for (Hand *hand = &player->hand; hand != NULL && hand->cards != NULL; hand = hand->nextHand)
+    {
+        hand_to_string(hand, handString, sizeof(handString), true);
+        printf("%s%s", (hand == &player->hand) ? ": " : " | ", handString);
+    }
+    putchar('\n');
+
+    return;
+}
+
+static void text_message(const char *msg)
+{
+    size_t length = strlen(msg);
+
+    // some messages bring their own newline
+    printf("%s%s", msg, (length && msg[length - 1] == '\n') ? "" : "\n");
+
+    return;
+}
+
+static uint8_t text_num_players(uint8_t max)
+{
+    char prompt[TEXT_LINE_MAX];
+    char line[TEXT_LINE_MAX];
+
+    snprintf(prompt, sizeof(prompt), "How many people are playing? (1-%u or q to quit.) ", max);
+    while (read_answer(prompt, line, sizeof(line)))
+    {
+        if (tolower(line[0]) == 'q') break;
+        int players = atoi(line);
+        if (players >= 1 && players <= max) return (uint8_t) players;
+    }
+
+    return 0;
+}
+
+static bool text_name(uint8_t seat, char *name, int size)
+{
+    char prompt[TEXT_LINE_MAX];
+
+    snprintf(prompt, sizeof(prompt), "What is player %i's name? ", seat + 1);
+    return read_answer(prompt, name, size) && name[0] != '\0';
+}
+
+static bool text_read_line(const char *prompt, char *line, int size)
+{
+    return read_answer(prompt, line, size);
+}
+
+static PlayerChoice text_choice(Player *player, bool surrender)
+{
+    char prompt[TEXT_LINE_MAX];
+    char line[TEXT_LINE_MAX];
+
+    snprintf(prompt, sizeof(prompt), "%s: [S]tand, [H]it, [D]ouble down, S[p]lit%s? ", player->name,
+            surrender ? " or s[U]rrender" : "");
+    while (read_answer(prompt, line, sizeof(line)))
+    {
+        switch (tolower(line[0]))
+        {
+            case 's':
+                return STAND;
+            case 'h':
+                return HIT;
+            case 'd':
+                return DOUBLE;
+            case 'p':
+                return SPLIT;
+            case 'u':
+                if (surrender) return SURRENDER;
+                break;
+            default:
+                break;
+        }
+    }
+
+    zinfo("No more input, %s stands.", player->name);
+    return STAND;
+}
+
+static bool text_yes_no(const char *question)
+{
+    char prompt[TEXT_LINE_MAX];
+    char line[TEXT_LINE_MAX];
+
+    snprintf(prompt, sizeof(prompt), "%s (y/n) ", question);
+    while (read_answer(prompt, line, sizeof(line)))
+    {
+        if (tolower(line[0]) == 'y') return true;
+        if (tolower(line[0]) == 'n') return false;
+    }
+
+    return false;
+}
+
+/***************
+ *  Summary: Ask a question and read the answer
+ *
+ *  Parameter(s):
+ *      prompt: the question, printed without a newline
+ *      line: where the answer goes, without its newline and cut short to fit
+ *      size: the size of line
+ *
+ *  Returns:
+ *      bool: false at the end of the input
+ */
+static bool read_answer(const char *prompt, char *line, int size)
+{
+    fputs(prompt, stdout);
+    fflush(stdout);
+
+    line[0] = '\0';
+    if (!fgets(line, size, stdin))
+    {
+        putchar('\n');
+        return false;
+    }
+
+    char *newline = strchr(line, '\n');
+    if (newline)
+    {
+        *newline = '\0';
+    }
+    else
+    {
+        int skipped;
+        while ((skipped = getchar()) != EOF && skipped != '\n');   // the rest of a line too long for the answer
+    }
+
+    return true;
+}
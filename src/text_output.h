@@ -0,0 +1,50 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  text_output.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: A renderer that plays the game as plain lines of text on stdout, reading the answers a line at a
+ *               time from stdin. It needs no terminal at all, so the game can be played over the dumbest of links
+ *               or driven by a script piped into it; the end of the input ends the game.
+ */
+
+#ifndef TEXT_OUTPUT_H_
+#define TEXT_OUTPUT_H_
+
+/************
+ * INCLUDES *
+ ************/
+#include "renderer.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define TEXT_LINE_MAX 80            // longest answer read, anything more on the line is skipped
+
+extern const Renderer TEXT_RENDERER;
+
+#endif /* TEXT_OUTPUT_H_ */
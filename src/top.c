@@ -0,0 +1,232 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  top.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: blackjack_top, a live view of every running sim and server. Finds their live stats segments in
+ *               /dev/shm, reads each slot without locking and shows the totals per process, refreshed until
+ *               interrupted: rounds, hands, hands per second, EV so far and, for builds with the phase timers, the
+ *               latency of each phase. Segments left behind by processes that have died are removed.
+ */
+
+
+/************
+ * INCLUDES *
+ ************/
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <limits.h>
+#include <sys/mman.h>
+
+#include "live_stats.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define TOP_DELAY 1.0
+#define TOP_SHM_DIR "/dev/shm"      // where Linux keeps POSIX shared memory
+#define TOP_MAX_SEGMENTS 64
+
+typedef struct TopEntry
+{
+    long pid;
+    char name[NAME_MAX + 2];        // a leading / and the file name
+} TopEntry;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+uint16_t find_segments(TopEntry *entries);
+bool show_segment(const char *name);
+int compare_entries(const void *a, const void *b);
+
+int main(int argc, char *argv[])
+{
+    double delay = TOP_DELAY;
+    long iterations = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd':
+                delay = strtod(optarg, NULL);
+                break;
+            case 'n':
+                iterations = strtol(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-d seconds] [-n iterations]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (delay < 0.1) delay = 0.1;
+
+    bool clear = isatty(STDOUT_FILENO);
+    struct timespec pause = {.tv_sec = (time_t) delay, .tv_nsec = (long) ((delay - (time_t) delay) * 1e9)};
+    for (long iteration = 0; iterations == 0 || iteration < iterations; iteration++)
+    {
+        if (iteration > 0) nanosleep(&pause, NULL);
+
+        TopEntry entries[TOP_MAX_SEGMENTS];
+        uint16_t numEntries = find_segments(entries);
+        if (clear) printf("\033[H\033[2J");
+        printf("%-8s %-12s %5s %10s %14s %14s %12s %9s\n", "PID", "PROGRAM", "SLOTS", "UPTIME", "ROUNDS", "HANDS",
+                "HANDS/S", "EV");
+        uint16_t shown = 0;
+        for (uint16_t entry = 0; entry < numEntries; entry++)
+        {
+            shown += show_segment(entries[entry].name);
+        }
+        if (shown == 0) printf("No sims or servers running.\n");
+        fflush(stdout);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/***************
+ *  Summary: List the live stats segments, oldest process first
+ *
+ *  Parameter(s):
+ *      entries: filled with up to TOP_MAX_SEGMENTS segments, sorted by pid
+ *
+ *  Returns:
+ *      count: the number of segments found
+ */
+uint16_t find_segments(TopEntry *entries)
+{
+    uint16_t count = 0;
+    DIR *dir = opendir(TOP_SHM_DIR);
+    if (dir == NULL) return 0;
+
+    struct dirent *file;
+    size_t prefixLen = strlen(LIVE_STATS_PREFIX);
+    while ((file = readdir(dir)) != NULL && count < TOP_MAX_SEGMENTS)
+    {
+        if (strncmp(file->d_name, LIVE_STATS_PREFIX, prefixLen) != 0) continue;
+
+        char *end;
+        long pid = strtol(file->d_name + prefixLen, &end, 10);
+        if (*end != '\0' || pid <= 0) continue;
+
+        entries[count].pid = pid;
+        snprintf(entries[count].name, sizeof(entries[count].name), "/%s", file->d_name);
+        count++;
+    }
+    closedir(dir);
+    qsort(entries, count, sizeof(TopEntry), compare_entries);
+
+    return count;
+}
+
+/***************
+ *  Summary: Show one process's totals and phase latencies
+ *
+ *  Description: The slots are added up: counts are summed, hands per second too since the slots are separate
+ *      threads, and the phases take the count weighted mean and the worst p50 and p99 of any slot. A slot whose
+ *      writer was mid update through every retry is left out of this refresh.
+ *
+ *  Parameter(s):
+ *      name: the segment's name
+ *
+ *  Returns:
+ *      bool: false if the segment couldn't be read or its process has died
+ */
+bool show_segment(const char *name)
+{
+    size_t size;
+    const LiveSegment *segment = live_stats_attach(name, &size);
+    if (segment == NULL) return false;
+
+    if (kill(segment->pid, 0) < 0 && errno == ESRCH)
+    {
+        shm_unlink(name);
+        live_stats_detach(segment, size);
+        return false;
+    }
+
+    LiveSample total = {0};
+    double totalNs[PHASE_COUNT] = {0};
+    for (uint16_t slot = 0; slot < segment->numSlots; slot++)
+    {
+        LiveSample sample;
+        if (!live_stats_read(segment, slot, &sample)) continue;
+
+        total.rounds += sample.rounds;
+        total.hands += sample.hands;
+        total.wagered += sample.wagered;
+        total.net += sample.net;
+        total.handsPerSecond += sample.handsPerSecond;
+        if (sample.seconds > total.seconds) total.seconds = sample.seconds;
+        for (uint8_t phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            PhaseLatency *latency = &total.phases[phase];
+            latency->count += sample.phases[phase].count;
+            totalNs[phase] += (double) sample.phases[phase].meanNs * sample.phases[phase].count;
+            if (sample.phases[phase].p50Ns > latency->p50Ns) latency->p50Ns = sample.phases[phase].p50Ns;
+            if (sample.phases[phase].p99Ns > latency->p99Ns) latency->p99Ns = sample.phases[phase].p99Ns;
+        }
+    }
+
+    char program[sizeof(segment->program) + 1] = {0};
+    memcpy(program, segment->program, sizeof(segment->program));
+    printf("%-8ld %-12s %5u %9.0fs %14llu %14llu %12.0f %+8.3f%%\n", (long) segment->pid, program, segment->numSlots,
+            total.seconds, (unsigned long long) total.rounds, (unsigned long long) total.hands, total.handsPerSecond,
+            total.wagered ? 100.0 * total.net / total.wagered : 0.0);
+    for (uint8_t phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        PhaseLatency *latency = &total.phases[phase];
+        if (latency->count == 0) continue;
+
+        printf("    %-18s %12llu  mean %9.1f us  p50 %9.1f us  p99 %9.1f us\n", phase_name(phase),
+                (unsigned long long) latency->count, totalNs[phase] / latency->count / 1e3, latency->p50Ns / 1e3,
+                latency->p99Ns / 1e3);
+    }
+    live_stats_detach(segment, size);
+
+    return true;
+}
+
+int compare_entries(const void *a, const void *b)
+{
+    long pidA = ((const TopEntry *) a)->pid;
+    long pidB = ((const TopEntry *) b)->pid;
+
+    return (pidA > pidB) - (pidA < pidB);
+}
@@ -0,0 +1,530 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  bench_blackjack.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Microbenchmarks for the deck and hand primitives. Each case is timed over a number of samples of a
+ *      batch of operations, and the results are written to stdout as JSON with the ns/op percentiles across samples
+ *      and the heap allocations made per operation. Allocations are counted by wrapping malloc, calloc and realloc
+ *      at link time (see the bench target in the Makefile).
+ */
+
+/************
+ * INCLUDES *
+ ************/
+#include "../src/blackjack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <locale.h>
+#include <time.h>
+
+#include "../src/logger.h"
+#include "../src/deck_of_cards.h"
+#include "../src/engine.h"
+#include "../src/hand_eval.h"
+#include "../src/curses_output.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define SAMPLES 200         // timed samples per case, override with the first argument
+#define BATCH 256           // operations per sample
+#define WARMUP 10           // untimed samples before timing starts
+#define MAX_HAND 10         // longest hand benchmarked
+#define ROUND_HANDS 7       // hands in a round dealt by deal_round: six seats and the dealer
+#define ROUND_DECKS 10      // enough cards to deal the first two to every hand in a batch
+#define ROUND_DISCARDS 20   // about what a round at six seats leaves in the discard tray
+#define CUT_DISCARDS 250    // what a six deck shoe has dealt at the cut card
+#define BENCH_CASE(function, d, c, setUp, tearDown) \
+    {.name = #function, .decks = d, .cards = c, .setup = setUp, .run = bench_##function, .teardown = tearDown}
+
+typedef struct BenchCase
+{
+    const char *name;
+    uint8_t decks;
+    uint8_t cards;          // cards in the hand for the hand primitives, discards for shuffle_discards, 0 otherwise
+    void (*setup)(struct BenchCase *bench);
+    void (*run)(struct BenchCase *bench);   // one batch of BATCH operations
+    void (*teardown)(struct BenchCase *bench);
+    Deck *shoe;
+    Hand hands[BATCH];
+    HandEval *eval;         // the batch's hands gathered for evaluate_hands
+    Deck *decksMade[BATCH];
+} BenchCase;
+
+static uint64_t allocations = 0;
+
+/****************
+ * DECLARATIONS *
+ ****************/
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+
+uint64_t now_ns(void);
+int compare_doubles(const void *a, const void *b);
+void run_case(BenchCase *bench, uint32_t samples, bool first);
+void fill_hands(BenchCase *bench, uint8_t cards);
+void free_hands(BenchCase *bench);
+void setup_shoe(BenchCase *bench);
+void setup_hands(BenchCase *bench);
+void setup_deal(BenchCase *bench);
+void setup_pairs(BenchCase *bench);
+void setup_eval(BenchCase *bench);
+void teardown_shoe(BenchCase *bench);
+void teardown_hands(BenchCase *bench);
+void bench_init_deck(BenchCase *bench);
+void bench_shuffle_cards(BenchCase *bench);
+void bench_shuffle_discards(BenchCase *bench);
+void bench_deal_card(BenchCase *bench);
+void bench_deal_round(BenchCase *bench);
+void bench_blackjack_count(BenchCase *bench);
+void bench_evaluate_hands(BenchCase *bench);
+void bench_clear_hands(BenchCase *bench);
+void bench_split_hand(BenchCase *bench);
+void bench_hand_to_string(BenchCase *bench);
+
+int main(int argc, char *argv[])
+{
+    setlocale(LC_ALL, "");
+    srandom(1968);
+    uint32_t samples = (argc > 1) ? strtoul(argv[1], NULL, 10) : SAMPLES;
+    if (samples == 0) samples = SAMPLES;
+
+    if (init_zlog("bench_blackjack.conf", "bench_cat"))
+    {
+        return EXIT_FAILURE;
+    }
+
+    BenchCase cases[] =
+    {
+        BENCH_CASE(init_deck, 1, 0, NULL, teardown_shoe),
+        BENCH_CASE(init_deck, 6, 0, NULL, teardown_shoe),
+        BENCH_CASE(init_deck, 8, 0, NULL, teardown_shoe),
+        BENCH_CASE(shuffle_cards, 1, 0, setup_shoe, teardown_shoe),
+        BENCH_CASE(shuffle_cards, 6, 0, setup_shoe, teardown_shoe),
+        BENCH_CASE(shuffle_cards, 8, 0, setup_shoe, teardown_shoe),
+        BENCH_CASE(shuffle_discards, 6, ROUND_DISCARDS, setup_shoe, teardown_shoe),
+        BENCH_CASE(shuffle_discards, 6, CUT_DISCARDS, setup_shoe, teardown_shoe),
+        BENCH_CASE(deal_card, 6, 1, setup_deal, teardown_hands),
+        BENCH_CASE(deal_card, 6, 5, setup_deal, teardown_hands),
+        BENCH_CASE(deal_card, 6, MAX_HAND, setup_deal, teardown_hands),
+        BENCH_CASE(deal_round, ROUND_DECKS, INITIAL_CARDS, setup_shoe, teardown_hands),
+        BENCH_CASE(blackjack_count, 6, 2, setup_hands, teardown_hands),
+        BENCH_CASE(blackjack_count, 6, 5, setup_hands, teardown_hands),
+        BENCH_CASE(blackjack_count, 6, MAX_HAND, setup_hands, teardown_hands),
+        BENCH_CASE(evaluate_hands, 6, 2, setup_eval, teardown_hands),
+        BENCH_CASE(evaluate_hands, 6, 5, setup_eval, teardown_hands),
+        BENCH_CASE(evaluate_hands, 6, MAX_HAND, setup_eval, teardown_hands),
+        BENCH_CASE(clear_hands, 6, 2, setup_hands, teardown_hands),
+        BENCH_CASE(clear_hands, 6, 5, setup_hands, teardown_hands),
+        BENCH_CASE(clear_hands, 6, MAX_HAND, setup_hands, teardown_hands),
+        BENCH_CASE(split_hand, 6, 2, setup_pairs, teardown_hands),
+        BENCH_CASE(hand_to_string, 6, 2, setup_hands, teardown_hands),
+        BENCH_CASE(hand_to_string, 6, 5, setup_hands, teardown_hands),
+        BENCH_CASE(hand_to_string, 6, MAX_HAND, setup_hands, teardown_hands),
+    };
+
+    printf("{\"samples\": %u, \"batch\": %d, \"benchmarks\": [\n", samples, BATCH);
+    for (size_t ii = 0; ii < sizeof(cases) / sizeof(cases[0]); ii++)
+    {
+        run_case(&cases[ii], samples, ii == 0);
+    }
+    printf("\n]}\n");
+
+    end_zlog();
+    return 0;
+}
+
+/***************
+ *  Summary: Allocation counting wrappers
+ *
+ *  Description: The linker sends every malloc, calloc and realloc call to these, which count it and pass it on.
+ */
+void *__wrap_malloc(size_t size)
+{
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    allocations++;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    allocations++;
+    return __real_realloc(ptr, size);
+}
+
+/***************
+ *  Summary: Read the monotonic clock
+ *
+ *  Returns:
+ *      uint64_t: the time in nanoseconds
+ */
+uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/***************
+ *  Summary: Time one benchmark case and print its JSON object
+ *
+ *  Description: Runs the warm-up samples, then times each sample's batch on its own, leaving the set-up and tear-down
+ *      of every sample out of the timing. Allocations are only counted while the batch runs.
+ *
+ *  Parameter(s):
+ *      bench: the BenchCase to run
+ *      samples: the number of timed samples
+ *      first: true for the first case, so no comma is printed before it
+ *
+ *  Returns:
+ *      N/A
+ */
+void run_case(BenchCase *bench, uint32_t samples, bool first)
+{
+    double *nsPerOp = calloc(samples, sizeof(double));
+    uint64_t batchAllocations = 0;
+
+    for (uint32_t sample = 0; sample < samples + WARMUP; sample++)
+    {
+        if (bench->setup) bench->setup(bench);
+
+        uint64_t allocsBefore = allocations;
+        uint64_t start = now_ns();
+        bench->run(bench);
+        uint64_t elapsed = now_ns() - start;
+        uint64_t allocsMade = allocations - allocsBefore;
+
+        if (bench->teardown) bench->teardown(bench);
+        if (sample < WARMUP) continue;
+
+        nsPerOp[sample - WARMUP] = (double) elapsed / BATCH;
+        batchAllocations += allocsMade;
+    }
+
+    if (bench->shoe)
+    {
+        free(bench->shoe->shoe);
+        free(bench->shoe);
+        bench->shoe = NULL;
+    }
+    hand_eval_free(bench->eval);
+    bench->eval = NULL;
+
+    qsort(nsPerOp, samples, sizeof(double), compare_doubles);
+    double sum = 0;
+    for (uint32_t sample = 0; sample < samples; sample++)
+    {
+        sum += nsPerOp[sample];
+    }
+
+    printf("%s  {\"name\": \"%s\", \"decks\": %u, \"cards\": %u, \"ns_per_op\": {\"mean\": %.1f, \"min\": %.1f, "
+            "\"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}, \"allocs_per_op\": %.2f}",
+            first ? "" : ",\n", bench->name, bench->decks, bench->cards, sum / samples, nsPerOp[0],
+            nsPerOp[samples / 2], nsPerOp[(samples * 90) / 100], nsPerOp[(samples * 99) / 100], nsPerOp[samples - 1],
+            (double) batchAllocations / ((double) samples * BATCH));
+
+    free(nsPerOp);
+    return;
+}
+
+/***************
+ *  Summary: Deal a hand of the case's size into each of the batch's hands
+ *
+ *  Parameter(s):
+ *      bench: the BenchCase
+ *      cards: the number of cards per hand
+ *
+ *  Returns:
+ *      N/A
+ */
+void fill_hands(BenchCase *bench, uint8_t cards)
+{
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        for (uint8_t card = 0; card < cards; card++)
+        {
+            if (bench->shoe->deal == bench->shoe->cards) shuffle_cards(bench->shoe);
+            deal_card(bench->shoe, &bench->hands[hand]);
+        }
+    }
+
+    return;
+}
+
+void free_hands(BenchCase *bench)
+{
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        clear_hands(&bench->hands[hand]);
+    }
+
+    return;
+}
+
+void setup_shoe(BenchCase *bench)
+{
+    if (bench->shoe == NULL)
+    {
+        bench->shoe = init_deck(bench->decks);
+    }
+    shuffle_cards(bench->shoe);
+
+    return;
+}
+
+void setup_hands(BenchCase *bench)
+{
+    setup_shoe(bench);
+    fill_hands(bench, bench->cards);
+
+    return;
+}
+
+/***************
+ *  Summary: Deal all but the last card of the case's hand size, leaving enough of the shoe for the timed deals
+ *
+ *  Parameter(s):
+ *      bench: the BenchCase
+ *
+ *  Returns:
+ *      N/A
+ */
+void setup_deal(BenchCase *bench)
+{
+    setup_shoe(bench);
+    fill_hands(bench, bench->cards - 1);
+    if (bench->shoe->cards - bench->shoe->deal < BATCH) shuffle_cards(bench->shoe);
+
+    return;
+}
+
+/***************
+ *  Summary: Give each of the batch's hands a pair of tens with a bet, ready to split
+ *
+ *  Parameter(s):
+ *      bench: the BenchCase
+ *
+ *  Returns:
+ *      N/A
+ */
+void setup_pairs(BenchCase *bench)
+{
+    setup_shoe(bench);
+
+    // deal from an unshuffled copy of the shoe so that the Ks are at known positions
+    Deck *ordered = init_deck(1);
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        ordered->deal = 12;     // K of spades
+        deal_card(ordered, &bench->hands[hand]);
+        ordered->deal = 25;     // K of clubs
+        deal_card(ordered, &bench->hands[hand]);
+        bench->hands[hand].bet = 10;
+    }
+    bench->decksMade[0] = ordered;
+
+    return;
+}
+
+/***************
+ *  Summary: Deal the batch's hands and gather them into the evaluator, leaving only the evaluation to be timed
+ *
+ *  Parameter(s):
+ *      bench: the BenchCase
+ *
+ *  Returns:
+ *      N/A
+ */
+void setup_eval(BenchCase *bench)
+{
+    setup_hands(bench);
+    if (bench->eval == NULL)
+    {
+        bench->eval = hand_eval_new(BATCH);
+    }
+    hand_eval_clear(bench->eval);
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        hand_eval_add(bench->eval, &bench->hands[hand]);
+    }
+
+    return;
+}
+
+void teardown_shoe(BenchCase *bench)
+{
+    for (uint16_t deck = 0; deck < BATCH; deck++)
+    {
+        if (bench->decksMade[deck] == NULL) continue;
+        free(bench->decksMade[deck]->shoe);
+        free(bench->decksMade[deck]);
+        bench->decksMade[deck] = NULL;
+    }
+
+    return;
+}
+
+void teardown_hands(BenchCase *bench)
+{
+    free_hands(bench);
+    teardown_shoe(bench);
+
+    return;
+}
+
+/***************
+ *  Summary: The timed batches, BATCH operations each
+ */
+void bench_init_deck(BenchCase *bench)
+{
+    for (uint16_t deck = 0; deck < BATCH; deck++)
+    {
+        bench->decksMade[deck] = init_deck(bench->decks);
+    }
+
+    return;
+}
+
+void bench_shuffle_cards(BenchCase *bench)
+{
+    for (uint16_t op = 0; op < BATCH; op++)
+    {
+        shuffle_cards(bench->shoe);
+    }
+
+    return;
+}
+
+void bench_shuffle_discards(BenchCase *bench)
+{
+    for (uint16_t op = 0; op < BATCH; op++)
+    {
+        bench->shoe->deal = bench->cards;   // as if dealt and the hands cleared
+        shuffle_discards(bench->shoe);
+    }
+
+    return;
+}
+
+void bench_deal_card(BenchCase *bench)
+{
+    // each hand already holds cards - 1 cards, so every deal walks to the end of a hand of that size
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        deal_card(bench->shoe, &bench->hands[hand]);
+    }
+
+    return;
+}
+
+void bench_deal_round(BenchCase *bench)
+{
+    // an operation is one hand's first two cards, to compare with two deal_card calls
+    Hand *round[ROUND_HANDS];
+    for (uint16_t hand = 0; hand < BATCH; hand += ROUND_HANDS)
+    {
+        uint16_t numHands = (BATCH - hand < ROUND_HANDS) ? BATCH - hand : ROUND_HANDS;
+        for (uint16_t seat = 0; seat < numHands; seat++)
+        {
+            round[seat] = &bench->hands[hand + seat];
+        }
+        deal_round(bench->shoe, round, numHands);
+    }
+
+    return;
+}
+
+void bench_blackjack_count(BenchCase *bench)
+{
+    volatile uint32_t total = 0;
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        total += blackjack_count(bench->hands[hand]);
+    }
+
+    return;
+}
+
+void bench_evaluate_hands(BenchCase *bench)
+{
+    // the whole batch is evaluated at once, so ns/op is the time per hand
+    evaluate_hands(bench->eval);
+
+    return;
+}
+
+void bench_clear_hands(BenchCase *bench)
+{
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        clear_hands(&bench->hands[hand]);
+    }
+
+    return;
+}
+
+void bench_split_hand(BenchCase *bench)
+{
+    uint32_t bank = UINT32_MAX;
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        // each split deals two cards, more than one shoe holds over a batch, so start the shoe again when it runs out
+        if (bench->shoe->cards - bench->shoe->deal < 2) bench->shoe->deal = 0;
+        split_hand(&bench->hands[hand], &bank, bench->shoe, &RULES_S17);
+    }
+
+    return;
+}
+
+void bench_hand_to_string(BenchCase *bench)
+{
+    char handString[HAND_STRING_SIZE];
+    for (uint16_t hand = 0; hand < BATCH; hand++)
+    {
+        hand_to_string(&bench->hands[hand], handString, sizeof(handString), TRUE);
+    }
+
+    return;
+}
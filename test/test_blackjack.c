@@ -28,7 +28,8 @@
  *  Created on: Nov 25, 2018
  *      Author: Keri Southwood-Smith
  *
- *  Description: Test suite for the Blackjack program (just the deck_of_cards module).
+ *  Description: Test suite for the Blackjack program: the deck_of_cards module, and asserts on the engine, rules,
+ *      snapshots, the bankroll store and the server's session.
  */
 
 /************
@@ -39,13 +40,63 @@
 #include <stdio.h>
 #include <locale.h>
 #include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stddef.h>
 
 #include "../src/logger.h"
 #include "../src/deck_of_cards.h"
+#include "../src/engine.h"
+#include "../src/rules.h"
+#include "../src/seat_batch.h"
+#include "../src/snapshot.h"
+#include "../src/bankroll.h"
+#include "../src/session.h"
+#include "../src/strategy.h"
 
 /***********
  * DEFINES *
  ***********/
+#define TEST_BET 10
+#define TEST_BATCH_SEATS 300                     // seats settled in one batch, a few times round SETTLE_CASES
+#define TEST_RULES_PATH "test_rules.conf"        // written and removed by test_load_rules
+#define TEST_SNAPSHOT_PATH "test_snapshot.snap"  // written and removed by test_snapshot
+#define TEST_BANKROLL_PATH "test_bankroll"        // test_bankroll's store, with the two files it's kept in
+#define TEST_BANKROLL_JOURNAL TEST_BANKROLL_PATH ".journal"
+#define TEST_BANKROLL_INDEX TEST_BANKROLL_PATH ".index"
+#define TEST_BANKROLL_PLAYERS 8
+#define TEST_BANKROLL_UPDATES 6000                // enough records to pass the size that compacts the journal
+#define TEST_SESSION_LINES 10000                  // lines fed to the session, several shoes' worth of rounds
+#define TEST_DRAWS 52000                          // cards drawn from an infinite shoe, a thousand decks' worth
+
+typedef struct SettleCase
+{
+    uint8_t player[4];      // card values, 0 after the last
+    uint8_t dealerCount;
+    bool dealerBlackjack;
+    uint8_t splits;
+    bool surrendered;
+    bool evenMoney;
+    HandResult result;
+    uint32_t payout;        // on a bet of TEST_BET
+} SettleCase;
+
+// one of each way a hand settles, checked by test_settle_hand and test_settle_batch
+static const SettleCase SETTLE_CASES[] = {
+    {.player = {10, 8}, .dealerCount = 17, .result = HAND_WON, .payout = 20},
+    {.player = {10, 7}, .dealerCount = 17, .result = HAND_PUSH, .payout = 10},
+    {.player = {10, 6}, .dealerCount = 17, .result = HAND_LOST, .payout = 0},
+    {.player = {10, 6}, .dealerCount = 22, .result = HAND_WON, .payout = 20},
+    {.player = {10, 6, 10}, .dealerCount = 22, .result = HAND_LOST, .payout = 0},
+    {.player = {5, 5, 11}, .dealerCount = 20, .result = HAND_WON, .payout = 20},
+    {.player = {11, 10}, .dealerCount = 20, .result = HAND_BLACKJACK, .payout = 25},
+    {.player = {11, 10}, .dealerCount = 21, .dealerBlackjack = true, .result = HAND_PUSH, .payout = 10},
+    {.player = {11, 10}, .dealerCount = 21, .dealerBlackjack = true, .splits = 1, .result = HAND_LOST},
+    {.player = {10, 10}, .dealerCount = 21, .dealerBlackjack = true, .result = HAND_LOST, .payout = 0},
+    {.player = {10, 6}, .dealerCount = 20, .surrendered = true, .result = HAND_SURRENDERED, .payout = 5},
+    {.player = {11, 10}, .dealerCount = 21, .dealerBlackjack = true, .evenMoney = true, .result = HAND_WON,
+            .payout = 20},
+};
 
 /****************
  * DECLARATIONS *
@@ -59,11 +110,26 @@ void test_clear_hands(Hand *hand);
 void test_split_hand(Hand *handToSplit, uint32_t *bank, Deck *shoe);
 void test_deal_card(Deck *shoe, Hand *hand);
 void test_clear_split_hands(Hand *hand);
+void make_hand(Hand *hand, Card *cards, CardList *nodes, const uint8_t *values, uint8_t count);
+void test_natural_beats_21(void);
+void test_settle_hand(void);
+void test_settle_batch(void);
+void test_can_split_double(void);
+void test_dealer_must_hit(void);
+void test_insurance(void);
+void test_load_rules(void);
+void test_snapshot(void);
+void test_counted_shoe(void);
+void test_deal_round(void);
+void test_strategy_view(void);
+void test_bankroll(void);
+void test_session_full_table(void);
+void test_session_blackjacks_push(void);
 
 int main(void)
 {
     setlocale(LC_ALL, "");
-    srandom(1968);
+    srandom(1845);   // a shoe that splits and resplits tens below
     
     // Initialize logging
     if (init_zlog("test_blackjack.conf", "test_cat"))
@@ -72,6 +138,21 @@ int main(void)
     }
     
     init_test_deck();
+    test_natural_beats_21();
+    test_settle_hand();
+    test_settle_batch();
+    test_can_split_double();
+    test_dealer_must_hit();
+    test_insurance();
+    test_load_rules();
+    test_snapshot();
+    test_counted_shoe();
+    test_deal_round();
+    test_strategy_view();
+    test_bankroll();
+    test_session_full_table();
+    test_session_blackjacks_push();
+    printf("All asserts passed.\n");
     
     end_zlog();
     return 0;
@@ -101,7 +182,7 @@ void init_test_deck()
     Player *player = init_player();
     print_hand(&player->hand);
     
-    // deal 5H, 6C, 3C
+    // deal 9H, 7C, AS
     for (int i = 0; i < 3; i++)
     {
         test_deal_card(deck, &player->hand);
@@ -114,17 +195,17 @@ void init_test_deck()
     player->hand.bet = 150;
     print_hand(&player->hand);
     
-    // deal Q
+    // deal 10S
     test_deal_card(deck, &player->hand);
     print_hand(&player->hand);
     test_split_hand(&player->hand, &player->money, deck);
     
-    // deal J
+    // deal JD
     test_deal_card(deck, &player->hand);
     print_hand(&player->hand);
     test_split_hand(&player->hand, &player->money, deck);
     
-    // print hands after split (should be Q-K and J-K)
+    // print hands after split (should be 10-Q and J-Q)
     print_hand(&player->hand);
     
     // re-split both hands
@@ -377,4 +458,874 @@ void test_deal_card(Deck *shoe, Hand *hand)
     }
     return;
 
-}
\ No newline at end of file
+}
+
+/***************
+ *  Summary: Build a hand from card values
+ *
+ *  Description: The cards and their list nodes are the caller's, so the hand needs no freeing.
+ *
+ *  Parameter(s):
+ *      hand - the Hand struct to fill
+ *      cards - room for count Card structs
+ *      nodes - room for count CardList structs
+ *      values - the card values, Aces as 11
+ *      count - the number of cards
+ *
+ *  Returns:
+ *      N/A
+ */
+void make_hand(Hand *hand, Card *cards, CardList *nodes, const uint8_t *values, uint8_t count)
+{
+    for (uint8_t card = 0; card < count; card++)
+    {
+        cards[card].value = values[card];
+        nodes[card].card = &cards[card];
+        nodes[card].nextCard = (card + 1 < count) ? &nodes[card + 1] : NULL;
+    }
+    hand->cards = nodes;
+
+    return;
+}
+
+/***************
+ *  Summary: Check a blackjack beats a dealer's 21 in three cards
+ *
+ *  Description: edge's deal_ev pays a player blackjack at the rules' payout unless the dealer has blackjack, so
+ *      settle_hand, used by the game and the server, and settle_batch, used by the sim, must both pay that against a
+ *      dealer who drew to 21. A split hand's 21 in two cards isn't a blackjack and only pushes.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_natural_beats_21(void)
+{
+    printf("Settling a blackjack against a dealer's 21...\n");
+    Rules rules = RULES_S17_INIT;
+    Card cards[5];
+    CardList nodes[5];
+    Hand player = {0};
+    Hand dealer = {0};
+    make_hand(&player, cards, nodes, (const uint8_t []) {11, 10}, 2);
+    make_hand(&dealer, &cards[2], &nodes[2], (const uint8_t []) {10, 5, 6}, 3);
+    player.bet = 10;
+    uint8_t dealerCount = blackjack_count(dealer);
+    assert(dealerCount == 21);
+
+    uint32_t bank = 0;
+    uint32_t payout;
+    assert(settle_hand(&player, dealerCount, false, &rules, &bank, &payout) == HAND_BLACKJACK);
+    assert(payout == 25 && bank == 25);
+
+    SeatBatch *batch = seat_batch_new(2);
+    assert(batch != NULL);
+    assert(seat_batch_add(batch, 0, &player));
+    player.splits = 1;
+    assert(seat_batch_add(batch, 1, &player));
+    settle_batch(batch, dealerCount, false, &rules);
+    assert(batch->result[0] == HAND_BLACKJACK && batch->payout[0] == 25);
+    assert(batch->result[1] == HAND_PUSH && batch->payout[1] == 10);
+
+    bank = 0;
+    assert(settle_hand(&player, dealerCount, false, &rules, &bank, &payout) == HAND_PUSH);
+    assert(payout == 10 && bank == 10);
+
+    seat_batch_free(batch);
+    return;
+}
+
+/***************
+ *  Summary: Check settle_hand on every kind of outcome
+ *
+ *  Description: Each case in SETTLE_CASES is settled with settle_hand and must give the result and payout expected
+ *      under S17 3:2 rules, then a 6:5 blackjack is paid.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_settle_hand(void)
+{
+    const uint8_t numCases = sizeof(SETTLE_CASES) / sizeof(SETTLE_CASES[0]);
+    printf("Settling %u hands...\n", numCases);
+    Rules rules = RULES_S17_INIT;
+
+    for (uint8_t ii = 0; ii < numCases; ii++)
+    {
+        const SettleCase *test = &SETTLE_CASES[ii];
+        Card cards[4];
+        CardList nodes[4];
+        Hand hand = {.bet = TEST_BET, .splits = test->splits, .surrendered = test->surrendered,
+                .evenMoney = test->evenMoney};
+        make_hand(&hand, cards, nodes, test->player, strnlen((const char *) test->player, sizeof(test->player)));
+
+        uint32_t bank = 0;
+        uint32_t payout;
+        assert(settle_hand(&hand, test->dealerCount, test->dealerBlackjack, &rules, &bank, &payout) == test->result);
+        assert(payout == test->payout && bank == test->payout);
+    }
+
+    // 6:5 rounds the bonus down
+    rules = RULES_H17_6TO5;
+    Card cards[2];
+    CardList nodes[2];
+    Hand hand = {.bet = 15};
+    make_hand(&hand, cards, nodes, (const uint8_t []) {11, 10}, 2);
+    uint32_t bank = 0;
+    uint32_t payout;
+    assert(settle_hand(&hand, 19, false, &rules, &bank, &payout) == HAND_BLACKJACK && payout == 15 + 18);
+
+    return;
+}
+
+/***************
+ *  Summary: Check a batch of seats settles the same as each hand on its own
+ *
+ *  Description: Each case in SETTLE_CASES is settled by settle_batch on its own, then a table of TEST_BATCH_SEATS
+ *      seats is settled in one batch and credited to the bankrolls, each seat as settle_hand would pay it. A full
+ *      batch refuses more hands.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_settle_batch(void)
+{
+    printf("Settling a batch of %u seats...\n", TEST_BATCH_SEATS);
+    const uint8_t numCases = sizeof(SETTLE_CASES) / sizeof(SETTLE_CASES[0]);
+    Rules rules = RULES_S17_INIT;
+    Card cards[numCases][4];
+    CardList nodes[numCases][4];
+    Hand hands[numCases];
+
+    for (uint8_t ii = 0; ii < numCases; ii++)
+    {
+        const SettleCase *test = &SETTLE_CASES[ii];
+        hands[ii] = (Hand) {.bet = TEST_BET, .splits = test->splits, .surrendered = test->surrendered,
+                .evenMoney = test->evenMoney};
+        make_hand(&hands[ii], cards[ii], nodes[ii], test->player,
+                strnlen((const char *) test->player, sizeof(test->player)));
+    }
+
+    SeatBatch *batch = seat_batch_new(TEST_BATCH_SEATS);
+    assert(batch != NULL);
+    for (uint8_t ii = 0; ii < numCases; ii++)
+    {
+        const SettleCase *test = &SETTLE_CASES[ii];
+        seat_batch_clear(batch);
+        assert(seat_batch_add(batch, 0, &hands[ii]));
+        settle_batch(batch, test->dealerCount, test->dealerBlackjack, &rules);
+        assert(batch->result[0] == test->result && batch->payout[0] == test->payout);
+    }
+
+    // every seat against a dealer's 19, each checked against settle_hand
+    uint32_t banks[TEST_BATCH_SEATS] = {0};
+    seat_batch_clear(batch);
+    for (uint16_t seat = 0; seat < TEST_BATCH_SEATS; seat++)
+    {
+        assert(seat_batch_add(batch, seat, &hands[seat % numCases]));
+    }
+    assert(!seat_batch_add(batch, 0, &hands[0]) && batch->count == TEST_BATCH_SEATS);
+    settle_batch(batch, 19, false, &rules);
+    credit_batch(batch, banks);
+    for (uint16_t seat = 0; seat < TEST_BATCH_SEATS; seat++)
+    {
+        uint32_t bank = 0;
+        uint32_t payout;
+        HandResult result = settle_hand(&hands[seat % numCases], 19, false, &rules, &bank, &payout);
+        assert(batch->seat[seat] == seat && batch->result[seat] == result && batch->payout[seat] == payout);
+        assert(banks[seat] == payout);
+    }
+    seat_batch_free(batch);
+
+    return;
+}
+
+/***************
+ *  Summary: Check when a hand may be split or doubled
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_can_split_double(void)
+{
+    printf("Checking splits and doubles...\n");
+    Rules rules = RULES_S17_INIT;
+    Card cards[3];
+    CardList nodes[3];
+    Hand hand = {.bet = TEST_BET};
+
+    make_hand(&hand, cards, nodes, (const uint8_t []) {8, 8}, 2);
+    assert(can_split(&hand, 100, &rules));
+    assert(!can_split(&hand, TEST_BET, &rules));            // the split needs more than the bet in the bank
+    hand.splits = rules.maxHands - 1;
+    assert(!can_split(&hand, 100, &rules));
+    hand.splits = 0;
+    rules.maxHands = 1;
+    assert(!can_split(&hand, 100, &rules));
+    rules = RULES_S17;
+
+    make_hand(&hand, cards, nodes, (const uint8_t []) {10, 9}, 2);
+    assert(!can_split(&hand, 100, &rules));
+    make_hand(&hand, cards, nodes, (const uint8_t []) {4, 4, 4}, 3);
+    assert(!can_split(&hand, 100, &rules));
+    assert(!can_double(&hand, 100, &rules));
+
+    make_hand(&hand, cards, nodes, (const uint8_t []) {5, 4}, 2);
+    assert(can_double(&hand, TEST_BET, &rules));
+    assert(!can_double(&hand, TEST_BET - 1, &rules));
+    rules.doubleOn = DOUBLE_9_TO_11;
+    assert(can_double(&hand, 100, &rules));
+    rules.doubleOn = DOUBLE_10_11;
+    assert(!can_double(&hand, 100, &rules));
+    make_hand(&hand, cards, nodes, (const uint8_t []) {6, 5}, 2);
+    assert(can_double(&hand, 100, &rules));
+
+    hand.splits = 1;
+    assert(can_double(&hand, 100, &rules));
+    rules.doubleAfterSplit = false;
+    assert(!can_double(&hand, 100, &rules));
+
+    return;
+}
+
+/***************
+ *  Summary: Check the dealer draws to 17, and on soft 17 only under H17
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_dealer_must_hit(void)
+{
+    printf("Checking the dealer's draws...\n");
+    Rules s17 = RULES_S17_INIT;
+    Rules h17 = RULES_H17_INIT;
+    Card cards[3];
+    CardList nodes[3];
+    Hand hand = {0};
+
+    make_hand(&hand, cards, nodes, (const uint8_t []) {10, 6}, 2);
+    assert(dealer_must_hit(&hand, &s17) && dealer_must_hit(&hand, &h17));
+    make_hand(&hand, cards, nodes, (const uint8_t []) {10, 7}, 2);
+    assert(!dealer_must_hit(&hand, &s17) && !dealer_must_hit(&hand, &h17));
+    make_hand(&hand, cards, nodes, (const uint8_t []) {11, 6}, 2);
+    assert(!dealer_must_hit(&hand, &s17) && dealer_must_hit(&hand, &h17));
+    assert(!dealer_must_hit_s17(&hand) && dealer_must_hit_h17(&hand));
+    make_hand(&hand, cards, nodes, (const uint8_t []) {11, 6, 10}, 3);  // the Ace counts 1, a hard 17
+    assert(!dealer_must_hit(&hand, &s17) && !dealer_must_hit(&hand, &h17));
+    make_hand(&hand, cards, nodes, (const uint8_t []) {11, 7}, 2);
+    assert(!dealer_must_hit(&hand, &s17) && !dealer_must_hit(&hand, &h17));
+
+    return;
+}
+
+/***************
+ *  Summary: Check insurance and even money are offered, taken and settled
+ *
+ *  Description: Insurance costs half the bet and pays 2:1 on a dealer blackjack. A blackjack is offered even money
+ *      instead, which costs nothing and wins 1:1 whatever the dealer has. The unseen counts put the hole card back.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_insurance(void)
+{
+    printf("Taking insurance and even money...\n");
+    Rules rules = RULES_S17_INIT;
+    Card dealerCards[2], cards[2];
+    CardList dealerNodes[2], nodes[2];
+    Hand dealer = {0};
+    Hand hand = {.bet = TEST_BET};
+    uint32_t bank = 100;
+
+    // only against an Ace, on a bet of at least 2 the player can cover half of
+    make_hand(&dealer, dealerCards, dealerNodes, (const uint8_t []) {11, 10}, 2);
+    make_hand(&hand, cards, nodes, (const uint8_t []) {10, 7}, 2);
+    assert(!can_insure(&hand, &dealer, bank));
+    make_hand(&dealer, dealerCards, dealerNodes, (const uint8_t []) {10, 11}, 2);
+    assert(can_insure(&hand, &dealer, bank) && !can_insure(&hand, &dealer, TEST_BET / 2 - 1));
+    hand.bet = 1;
+    assert(!can_insure(&hand, &dealer, bank));
+    hand.bet = TEST_BET;
+
+    // insurance won and lost
+    assert(!take_insurance(&hand, &bank));
+    assert(hand.insurance == TEST_BET / 2 && bank == 100 - TEST_BET / 2 && !hand.evenMoney);
+    assert(!can_insure(&hand, &dealer, bank));
+    assert(settle_insurance(&hand, true, &bank) == 3 * (TEST_BET / 2) && bank == 100 + TEST_BET);
+    assert(hand.insurance == 0);
+    bank = 100;
+    take_insurance(&hand, &bank);
+    assert(settle_insurance(&hand, false, &bank) == 0 && bank == 100 - TEST_BET / 2 && hand.insurance == 0);
+    assert(settle_insurance(&hand, true, &bank) == 0);     // nothing bet, nothing paid
+
+    // even money takes nothing from the bank and pays 1:1 with or without the dealer's blackjack
+    bank = 0;
+    make_hand(&hand, cards, nodes, (const uint8_t []) {11, 10}, 2);
+    assert(can_insure(&hand, &dealer, bank));
+    assert(take_insurance(&hand, &bank) && hand.evenMoney && hand.insurance == 0 && bank == 0);
+    assert(!can_insure(&hand, &dealer, bank));
+    uint32_t payout;
+    assert(settle_hand(&hand, 21, true, &rules, &bank, &payout) == HAND_WON && payout == 2 * TEST_BET);
+    assert(settle_hand(&hand, 18, false, &rules, &bank, &payout) == HAND_WON && payout == 2 * TEST_BET);
+    assert(bank == 4 * TEST_BET);
+
+    // the hole card is put back into the unseen cards, the upcard isn't
+    Deck *deck = init_deck(1);
+    Hand dealt = {0};
+    uint16_t tens, unseen;
+    unseen_tens(deck, &dealt, &tens, &unseen);
+    assert(tens == 16 && unseen == 52);
+    assert(deal_card(deck, &dealt) && deal_card(deck, &dealt));
+    unseen_tens(deck, &dealt, &tens, &unseen);
+    assert(tens == 16 - (dealer_upcard(&dealt)->value == 10) && unseen == 51);
+    clear_hands(&dealt);
+    free(deck->shoe);
+    free(deck);
+
+    return;
+}
+
+/***************
+ *  Summary: Check a rules file is read, and a bad one refused
+ *
+ *  Description: The shipped rules.conf is the S17 preset. Each file is written, read back and removed: one changing
+ *      every rule, files naming the H17 presets, where the rules left out keep the S17 values, and files with a bad
+ *      value or an unknown key, which are refused.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_load_rules(void)
+{
+    printf("Loading rules...\n");
+    Rules rules;
+    assert(load_rules("../src/rules.conf", &rules) && rules_equal(&rules, &RULES_S17));
+    assert(!load_rules("no such rules.conf", &rules));
+    assert(!rules_equal(&RULES_S17, &RULES_H17) && !rules_equal(&RULES_H17, &RULES_H17_6TO5));
+
+    static const Rules everyRule = {.hitSoft17 = true, .payoutNum = 6, .payoutDen = 5, .doubleAfterSplit = false,
+            .doubleOn = DOUBLE_10_11, .maxHands = 2, .surrender = true, .continuousShuffle = true};
+    static const struct
+    {
+        const char *text;
+        const Rules *rules;     // the rules read, NULL if the file is refused
+    } files[] = {
+        {"# every rule changed\ndealer_hits_soft_17 = yes\nblackjack_pays = 6:5\ndouble_after_split = no\n"
+                "double_on = 10-11\nmax_split_hands = 2\nsurrender = yes\ncontinuous_shuffler = yes\n", &everyRule},
+        {"\n  dealer_hits_soft_17 = yes  \n", &RULES_H17},
+        {"dealer_hits_soft_17=yes\nblackjack_pays=6:5\n", &RULES_H17_6TO5},
+        {"blackjack_pays = 3:0\n", NULL},
+        {"double_on = 8-11\n", NULL},
+        {"max_split_hands = 0\n", NULL},
+        {"max_split_hands = 9\n", NULL},
+        {"surrender\n", NULL},
+        {"dealer_peeks = yes\n", NULL},
+    };
+    for (uint8_t file = 0; file < sizeof(files) / sizeof(files[0]); file++)
+    {
+        FILE *out = fopen(TEST_RULES_PATH, "w");
+        assert(out != NULL);
+        fputs(files[file].text, out);
+        fclose(out);
+
+        bool loaded = load_rules(TEST_RULES_PATH, &rules);
+        remove(TEST_RULES_PATH);
+        assert(loaded == (files[file].rules != NULL));
+        if (loaded) assert(rules_equal(&rules, files[file].rules));
+    }
+
+    return;
+}
+
+/***************
+ *  Summary: Check a table comes back from a snapshot as it was saved
+ *
+ *  Description: Saves a table part way through a shoe and restores it, random state included. A snapshot from
+ *      another version, with too many seats, a deal past the end of its shoe or a bad card isn't restored, and one with
+ *      bad counts has them worked out again. A counted shoe comes back with its counts unless they don't add up, and
+ *      a table with cards in a hand isn't saved.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_snapshot(void)
+{
+    printf("Saving and restoring a snapshot...\n");
+    Rules rules = RULES_H17_INIT;
+    Player players[2] = {{.name = "Ann", .money = 750}, {.name = "Bob", .money = 1200}};
+    Dealer dealer = {.name = "Dealer"};
+    Deck *shoe = init_deck(2);
+    assert(shoe != NULL);
+    seed_random(1968);  // the snapshot keeps the random state, which only seed_random sets up
+    shuffle_cards(shoe);
+    for (uint8_t card = 0; card < 37; card++) assert(deal_card(shoe, &players[0].hand));
+    clear_hands(&players[0].hand);
+    Table table = {.numPlayers = 2, .players = players, .dealer = &dealer, .shoe = shoe, .rules = &rules};
+    uint32_t extra = 0xfeedface;
+    assert(snapshot_save(TEST_SNAPSHOT_PATH, &table, &extra, sizeof(extra)));
+    long nextRandom = random();
+
+    Table restored = {0};
+    Rules restoredRules;
+    Snapshot *snapshot = snapshot_restore(TEST_SNAPSHOT_PATH, &restored, &restoredRules);
+    assert(snapshot != NULL);
+    assert(rules_equal(&restoredRules, &rules));
+    assert(restored.numPlayers == 2 && !strcmp(restored.players[1].name, "Bob") && restored.players[1].money == 1200);
+    assert(!strcmp(restored.dealer->name, "Dealer"));
+    assert(restored.shoe->kind == SHOE_ORDERED && restored.shoe->cards == shoe->cards && restored.shoe->deal == 37);
+    assert(!memcmp(restored.shoe->shoe, shoe->shoe, sizeof(Card) * shoe->cards));
+    assert(!memcmp(restored.shoe->remaining, shoe->remaining, sizeof(shoe->remaining)));
+    assert(snapshot->extraSize == sizeof(extra) && *(uint32_t *) snapshot->extra == extra);
+    assert(random() == nextRandom);
+    snapshot_close(snapshot);
+
+    // a build of another version, too many seats, a deal past the end of the shoe or a card that can't be dealt
+    // marks the file damaged; damaged counts are worked out again
+    const uint32_t version = SNAPSHOT_VERSION + 1;
+    const uint8_t seats = MAX_PLAYERS + 1;
+    const uint16_t deal = shoe->cards + 1;
+    const uint8_t values[] = {1, 12};
+    const char face[sizeof(shoe->shoe[0].face)] = {'X', 'X', 'X', 'X', 'X', 'X'};
+    const uint16_t counts[CARD_VALUES] = {999};
+    SnapshotHeader header;
+    const struct
+    {
+        const uint64_t *section;    // the header's offset of the section damaged, NULL for the header itself
+        uint64_t offset;
+        const void *bytes;
+        size_t size;
+    } damage[] = {
+        {NULL, offsetof(SnapshotHeader, version), &version, sizeof(version)},
+        {NULL, offsetof(SnapshotHeader, numPlayers), &seats, sizeof(seats)},
+        {&header.shoe, offsetof(Deck, deal), &deal, sizeof(deal)},
+        {&header.cards, 5 * sizeof(Card) + offsetof(Card, value), &values[0], sizeof(values[0])},
+        {&header.cards, 90 * sizeof(Card) + offsetof(Card, value), &values[1], sizeof(values[1])},
+        {&header.cards, offsetof(Card, face), face, sizeof(face)},
+        {&header.shoe, offsetof(Deck, remaining), counts, sizeof(counts)},
+    };
+    const uint8_t numDamage = sizeof(damage) / sizeof(damage[0]);
+    for (uint8_t test = 0; test < numDamage; test++)
+    {
+        assert(snapshot_save(TEST_SNAPSHOT_PATH, &table, NULL, 0));
+        FILE *file = fopen(TEST_SNAPSHOT_PATH, "r+b");
+        assert(file != NULL && fread(&header, sizeof(header), 1, file) == 1);
+        long offset = damage[test].offset + (damage[test].section ? *damage[test].section : 0);
+        assert(fseek(file, offset, SEEK_SET) == 0 && fwrite(damage[test].bytes, damage[test].size, 1, file) == 1);
+        fclose(file);
+        snapshot = snapshot_restore(TEST_SNAPSHOT_PATH, &restored, &restoredRules);
+        assert((snapshot == NULL) == (test < numDamage - 1));
+    }
+    assert(!memcmp(restored.shoe->remaining, shoe->remaining, sizeof(shoe->remaining)));
+    snapshot_close(snapshot);
+    remove(TEST_SNAPSHOT_PATH);
+
+    // a counted shoe keeps only its counts, which must come back as they were
+    Deck *counted = init_counted_deck(8);
+    assert(counted != NULL);
+    Hand drawn = {0};
+    for (uint8_t card = 0; card < 30; card++) assert(deal_card(counted, &drawn));
+    clear_hands(&drawn);
+    table.shoe = counted;
+    assert(snapshot_save(TEST_SNAPSHOT_PATH, &table, NULL, 0));
+    snapshot = snapshot_restore(TEST_SNAPSHOT_PATH, &restored, &restoredRules);
+    assert(snapshot != NULL && snapshot->extra == NULL);
+    assert(restored.shoe->kind == SHOE_COUNTED && restored.shoe->cards == 8 * 52 && restored.shoe->deal == 30);
+    assert(!memcmp(restored.shoe->remaining, counted->remaining, sizeof(counted->remaining)));
+    snapshot_close(snapshot);
+
+    // its counts can't be worked out again, so ones that don't add up to the cards left are refused
+    FILE *file = fopen(TEST_SNAPSHOT_PATH, "r+b");
+    assert(file != NULL && fread(&header, sizeof(header), 1, file) == 1);
+    counted->remaining[VALUE_INDEX(7)]++;
+    assert(fseek(file, header.shoe + offsetof(Deck, remaining), SEEK_SET) == 0);
+    assert(fwrite(counted->remaining, sizeof(counted->remaining), 1, file) == 1);
+    fclose(file);
+    assert(snapshot_restore(TEST_SNAPSHOT_PATH, &restored, &restoredRules) == NULL);
+    remove(TEST_SNAPSHOT_PATH);
+    table.shoe = shoe;
+    free(counted->shoe);
+    free(counted);
+
+    Card cards[1];
+    CardList nodes[1];
+    make_hand(&players[0].hand, cards, nodes, (const uint8_t []) {10}, 1);
+    assert(!snapshot_save(TEST_SNAPSHOT_PATH, &table, NULL, 0));
+    remove(TEST_SNAPSHOT_PATH);
+
+    free(shoe->shoe);
+    free(shoe);
+    return;
+}
+
+/***************
+ *  Summary: Check a counted shoe draws in proportion to the cards left and keeps its counts
+ *
+ *  Description: Two counted decks are drawn to the last card, with the counts and deal kept in step after each card
+ *      and every card of each value drawn. A shoe left with a few cards draws only those. An infinite shoe never
+ *      runs down and draws each value about as often as a single deck holds it.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_counted_shoe(void)
+{
+    printf("Drawing from counted shoes...\n");
+    uint32_t drawn[CARD_VALUES] = {0};
+    Hand hand = {0};
+
+    Deck *shoe = init_counted_deck(2);
+    assert(shoe != NULL && shoe->kind == SHOE_COUNTED && shoe->cards == 2 * CARDS_IN_DECK && shoe->deal == 0);
+    assert(shoe->remaining[VALUE_INDEX(10)] == 32 && shoe->remaining[VALUE_INDEX(11)] == 8);
+    for (uint16_t card = 0; card < 2 * CARDS_IN_DECK; card++)
+    {
+        assert(deal_card(shoe, &hand));
+        uint8_t value = hand.cards->card->value;
+        drawn[VALUE_INDEX(value)]++;
+        clear_hands(&hand);
+
+        uint16_t left = 0;
+        for (uint8_t index = 0; index < CARD_VALUES; index++) left += shoe->remaining[index];
+        assert(shoe->deal == card + 1 && left == shoe->cards - shoe->deal);
+        assert(shoe->remaining[VALUE_INDEX(value)] == ((value == 10) ? 32 : 8) - drawn[VALUE_INDEX(value)]);
+    }
+    for (uint8_t index = 0; index < CARD_VALUES; index++)
+    {
+        assert(drawn[index] == ((index == VALUE_INDEX(10)) ? 32 : 8) && shoe->remaining[index] == 0);
+    }
+
+    // three fives and a ten left: those are the cards drawn, whatever the random numbers
+    shuffle_cards(shoe);
+    memset(shoe->remaining, 0, sizeof(shoe->remaining));
+    shoe->remaining[VALUE_INDEX(5)] = 3;
+    shoe->remaining[VALUE_INDEX(10)] = 1;
+    shoe->deal = shoe->cards - 4;
+    uint8_t fives = 0;
+    for (uint8_t card = 0; card < 4; card++)
+    {
+        assert(deal_card(shoe, &hand));
+        fives += (hand.cards->card->value == 5);
+        assert(hand.cards->card->value == 5 || hand.cards->card->value == 10);
+        clear_hands(&hand);
+    }
+    assert(fives == 3 && shoe->deal == shoe->cards);
+    free(shoe->shoe);
+    free(shoe);
+
+    shoe = init_counted_deck(INFINITE_DECKS);
+    assert(shoe != NULL && shoe->kind == SHOE_INFINITE && shoe->cards == CARDS_IN_DECK);
+    memset(drawn, 0, sizeof(drawn));
+    for (uint32_t card = 0; card < TEST_DRAWS; card++)
+    {
+        assert(deal_card(shoe, &hand));
+        drawn[VALUE_INDEX(hand.cards->card->value)]++;
+        clear_hands(&hand);
+        assert(shoe->deal == 0);
+    }
+    assert(shoe->remaining[VALUE_INDEX(10)] == 16 && shoe->remaining[VALUE_INDEX(11)] == 4);
+    // a thousand decks hold 16,000 tens and 4,000 of each other value; both are allowed six standard deviations
+    assert(drawn[VALUE_INDEX(10)] > 16000 - 650 && drawn[VALUE_INDEX(10)] < 16000 + 650);
+    for (uint8_t value = 2; value <= 11; value++)
+    {
+        if (value != 10) assert(drawn[VALUE_INDEX(value)] > 4000 - 370 && drawn[VALUE_INDEX(value)] < 4000 + 370);
+    }
+    free(shoe->shoe);
+    free(shoe);
+
+    return;
+}
+
+/***************
+ *  Summary: Check a round is dealt a card to each hand in turn, and refused when the shoe is short
+ *
+ *  Description: Each hand gets the shoe's next card then, once round the table, a second, in the nodes kept in the
+ *      Hand. The deal and the counts of the cards left move on by the round. A shoe without the cards for the round
+ *      deals nothing, and a counted shoe draws the round.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_deal_round(void)
+{
+    printf("Dealing rounds...\n");
+    Hand seats[3] = {{0}};
+    Hand *hands[3] = {&seats[0], &seats[1], &seats[2]};
+
+    Deck *shoe = init_deck(1);
+    assert(shoe != NULL);
+    shuffle_cards(shoe);
+    shoe->deal = 10;
+    uint16_t remaining[CARD_VALUES];
+    memcpy(remaining, shoe->remaining, sizeof(remaining));
+    assert(deal_round(shoe, hands, 3));
+    assert(shoe->deal == 16);
+    for (uint8_t hand = 0; hand < 3; hand++)
+    {
+        CardList *first = seats[hand].cards;
+        assert(first == &seats[hand].dealt[0] && first->nextCard == &seats[hand].dealt[1]);
+        assert(first->nextCard->nextCard == NULL);
+        assert(first->card == &shoe->shoe[10 + hand] && first->nextCard->card == &shoe->shoe[13 + hand]);
+        remaining[VALUE_INDEX(first->card->value)]--;
+        remaining[VALUE_INDEX(first->nextCard->card->value)]--;
+    }
+    assert(!memcmp(remaining, shoe->remaining, sizeof(remaining)));
+    for (uint8_t hand = 0; hand < 3; hand++) clear_hands(&seats[hand]);
+
+    // five cards left won't deal three hands, and nothing is touched
+    shoe->deal = shoe->cards - 5;
+    memcpy(remaining, shoe->remaining, sizeof(remaining));
+    assert(!deal_round(shoe, hands, 3));
+    assert(shoe->deal == shoe->cards - 5 && !memcmp(remaining, shoe->remaining, sizeof(remaining)));
+    for (uint8_t hand = 0; hand < 3; hand++) assert(seats[hand].cards == NULL);
+    shoe->deal = shoe->cards - 6;
+    assert(deal_round(shoe, hands, 3) && shoe->deal == shoe->cards);
+    for (uint8_t hand = 0; hand < 3; hand++) clear_hands(&seats[hand]);
+    free(shoe->shoe);
+    free(shoe);
+
+    shoe = init_counted_deck(6);
+    assert(shoe != NULL);
+    assert(deal_round(shoe, hands, 3) && shoe->deal == 6);
+    uint16_t left = 0;
+    for (uint8_t index = 0; index < CARD_VALUES; index++) left += shoe->remaining[index];
+    assert(left == shoe->cards - 6);
+    for (uint8_t hand = 0; hand < 3; hand++)
+    {
+        assert(seats[hand].cards == &seats[hand].dealt[0] && blackjack_count(seats[hand]) >= 4);
+        clear_hands(&seats[hand]);
+    }
+    free(shoe->shoe);
+    free(shoe);
+
+    return;
+}
+
+/***************
+ *  Summary: Check a strategy sees the cards the player hasn't, the dealer's hole card among them
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_strategy_view(void)
+{
+    printf("Filling in a strategy's view...\n");
+    Rules rules = RULES_S17_INIT;
+    Hand player = {.bet = TEST_BET};
+    Hand dealer = {0};
+    Hand *hands[2] = {&player, &dealer};
+    StrategyView view;
+    uint16_t unseen[CARD_VALUES];
+
+    Deck *shoe = init_deck(1);
+    assert(shoe != NULL);
+    shuffle_cards(shoe);
+    strategy_view(&view, unseen, NULL, NULL, shoe, 100, &rules);
+    assert(view.remaining == shoe->remaining && view.cardsLeft == CARDS_IN_DECK && view.upcard == NULL);
+
+    assert(deal_round(shoe, hands, 2));
+    strategy_view(&view, unseen, &player, &dealer, shoe, 100, &rules);
+    assert(view.upcard == dealer_upcard(&dealer) && view.cardsLeft == CARDS_IN_DECK - 3);
+    uint16_t left = 0;
+    for (uint8_t index = 0; index < CARD_VALUES; index++)
+    {
+        uint16_t hole = (index == VALUE_INDEX(dealer.cards->card->value));
+        assert(view.remaining[index] == shoe->remaining[index] + hole);
+        left += view.remaining[index];
+    }
+    assert(left == view.cardsLeft);
+    clear_hands(&player);
+    clear_hands(&dealer);
+    free(shoe->shoe);
+    free(shoe);
+
+    // an infinite shoe's counts never move, so nothing is put back
+    shoe = init_counted_deck(INFINITE_DECKS);
+    assert(shoe != NULL && deal_round(shoe, hands, 2));
+    strategy_view(&view, unseen, &player, &dealer, shoe, 100, &rules);
+    assert(view.remaining == shoe->remaining && view.cardsLeft == CARDS_IN_DECK);
+    clear_hands(&player);
+    clear_hands(&dealer);
+    free(shoe->shoe);
+    free(shoe);
+
+    return;
+}
+
+/***************
+ *  Summary: Check the bankroll store keeps balances across a reopen and compacts its journal
+ *
+ *  Description: Makes enough updates for the writer to compact part way through, then closes the store, which
+ *      compacts the rest. The journal must be left empty with every balance in the index.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_bankroll(void)
+{
+    printf("Updating bankrolls...\n");
+    remove(TEST_BANKROLL_JOURNAL);
+    remove(TEST_BANKROLL_INDEX);
+
+    BankrollStore *store = bankroll_open(TEST_BANKROLL_PATH);
+    assert(store != NULL);
+    char name[BANKROLL_NAME];
+    for (uint32_t update = 0; update < TEST_BANKROLL_UPDATES; update++)
+    {
+        snprintf(name, sizeof(name), "Player %u", update % TEST_BANKROLL_PLAYERS);
+        assert(bankroll_update(store, name, update));
+    }
+    uint32_t money;
+    assert(!bankroll_lookup(store, "Nobody", &money));
+    bankroll_close(store);
+
+    FILE *journal = fopen(TEST_BANKROLL_JOURNAL, "rb");
+    assert(journal != NULL);
+    assert(fseek(journal, 0, SEEK_END) == 0 && ftell(journal) == 0);
+    fclose(journal);
+
+    store = bankroll_open(TEST_BANKROLL_PATH);
+    assert(store != NULL);
+    for (uint32_t player = 0; player < TEST_BANKROLL_PLAYERS; player++)
+    {
+        snprintf(name, sizeof(name), "Player %u", player);
+        assert(bankroll_lookup(store, name, &money));
+        assert(money == TEST_BANKROLL_UPDATES - TEST_BANKROLL_PLAYERS + player);
+    }
+    bankroll_close(store);
+
+    remove(TEST_BANKROLL_JOURNAL);
+    remove(TEST_BANKROLL_INDEX);
+    return;
+}
+
+/***************
+ *  Summary: Play a full table down the server's shoe
+ *
+ *  Description: Five seats bet $1 and hit every hand until it's done, through enough rounds to reshuffle the shoe
+ *      several times. The shoe must never deal past its last card and the session must stay open. An ordered shoe
+ *      that has run out refuses the card instead.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_session_full_table(void)
+{
+    printf("Playing a full table down the shoe...\n");
+    Session *session = session_new(&RULES_S17);
+    assert(session != NULL);
+    const char *sit = "SIT Ann Bob Cy Di Ed\n";
+    assert(session_feed(session, sit, strlen(sit)));
+
+    Deck *shoe = session->table.shoe;
+    uint16_t lastDeal = shoe->deal;
+    uint32_t shuffles = 0;
+    for (uint32_t line = 0; line < TEST_SESSION_LINES; line++)
+    {
+        const char *reply = (session->state == SESSION_BETTING) ? "BET 1\n"
+                : (session->state == SESSION_INSURING) ? "N\n" : "H\n";
+        assert(session_feed(session, reply, strlen(reply)));
+        assert(shoe->deal <= shoe->cards);
+        if (shoe->deal < lastDeal) shuffles++;
+        lastDeal = shoe->deal;
+        session_consume(session, session->outLen);
+    }
+    assert(shuffles > 1);
+    session_free(session);
+
+    Deck *deck = init_deck(1);
+    Hand hand = {0};
+    deck->deal = deck->cards;
+    assert(!can_deal(deck, 1) && !deal_card(deck, &hand));
+    assert(deck->deal == deck->cards && hand.cards == NULL);
+    deck->deal = deck->cards - 1;
+    assert(can_deal(deck, 1) && !can_deal(deck, 2) && deal_card(deck, &hand));
+    assert(deck->deal == deck->cards && hand.cards != NULL);
+    clear_hands(&hand);
+    free(deck->shoe);
+    free(deck);
+
+    return;
+}
+
+/***************
+ *  Summary: Check the server pushes a blackjack against a dealer blackjack
+ *
+ *  Description: The shoe is stacked so one seat and the dealer are both dealt an Ace and a King, the dealer's King
+ *      face up. The dealer's blackjack ends the round straight away and the seat's blackjack gets its bet back.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void test_session_blackjacks_push(void)
+{
+    printf("Settling blackjacks at the server...\n");
+    Session *session = session_new(&RULES_S17);
+    assert(session != NULL);
+    const char *sit = "SIT Ann\n";
+    assert(session_feed(session, sit, strlen(sit)));
+
+    // the seat and the dealer are dealt in turn: seat, hole card, seat, upcard
+    Deck *shoe = session->table.shoe;
+    const uint8_t stack[] = {11, 11, 10, 10};
+    for (uint16_t card = 0; card < sizeof(stack); card++)
+    {
+        uint16_t find = shoe->deal + card;
+        while (shoe->shoe[find].value != stack[card]) find++;
+        Card swap = shoe->shoe[shoe->deal + card];
+        shoe->shoe[shoe->deal + card] = shoe->shoe[find];
+        shoe->shoe[find] = swap;
+    }
+
+    session_consume(session, session->outLen);
+    const char *bet = "BET 10\n";
+    assert(session_feed(session, bet, strlen(bet)));
+    assert(session->outLen < SESSION_LINE_MAX * 8);
+    char out[SESSION_LINE_MAX * 8];
+    memcpy(out, session->out, session->outLen);
+    out[session->outLen] = '\0';
+    assert(strstr(out, "RESULT 1 1 PUSH 10 1000\n") != NULL);
+    assert(session->state == SESSION_BETTING && session->players[0].money == 1000);
+    session_free(session);
+
+    return;
+}
@@ -28,7 +28,10 @@
  *  Created on: Nov 9, 2018
  *      Author: Keri Southwood-Smith
  *
- *  Description: Test suite for the Blackjack programs curses routines.
+ *  Description: Test suite for the Blackjack programs curses routines. Run on its own it steps through the screens a
+ *      key at a time. With -c it runs them on a pseudo-terminal of its own instead, pressing the keys itself, and
+ *      prints how many bytes each step and each round wrote to the terminal, so drawing more than needed shows up as
+ *      bigger numbers.
  */
 
 /************
@@ -37,7 +40,12 @@
 #include "../src/blackjack.h"
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <locale.h>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include "../src/curses_output.h"
 #include "../src/logger.h"
@@ -47,13 +55,61 @@
  * DEFINES *
  ***********/
 #define CENTER(message) ((columns - strlen(message)) / 2)
+#define ROUNDS 8                // rounds dealt after the single screens
+#define CAPTURE_LINES 24        // the pseudo-terminal's size
+#define CAPTURE_COLS 80
+#define CAPTURE_TERM "xterm"    // fixed, so the byte counts compare between machines
+#define QUIET_MS 150            // a step's output is over when the terminal is quiet this long
 
 /****************
  * DECLARATIONS *
  ****************/
+void run_screens(void);
+int capture_screens(void);
+bool drain_output(int terminal, size_t *bytes);
+void discard_hand(Hand *hand);
 
+// what's on the screen while the test waits for each key, in order
+static const char *steps[] = {"start", "message window", "welcome screen", "dealer, hole card down",
+        "dealer, both cards up", "player"};
 
-int main(void)
+int main(int argc, char *argv[])
+{
+    int opt;
+    bool capture = FALSE;
+
+    while ((opt = getopt(argc, argv, "c")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c':
+                capture = TRUE;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-c]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (capture) return capture_screens();
+
+    run_screens();
+    return 0;
+}
+
+/***************
+ *  Summary: Step through the screens
+ *
+ *  Description: Shows each part of the display in turn, waiting for a key after each, then deals ROUNDS rounds to a
+ *      player and the dealer the way the game redraws the table between rounds.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      N/A
+ */
+void run_screens(void)
 {
     setlocale(LC_ALL, "");
     srandom(1968);
@@ -70,14 +126,14 @@ int main(void)
     zinfo("Initialize the curses system.");
     init_window();
     wgetch(stdscr);
-    WINDOW *messageWindow = init_message_window();
+    WINDOW *messageWindow = init_message_window(NULL);
     zinfo("Initialized curses system.");
     print_message(messageWindow, msg1);
-    wgetch(stdscr);
+    read_key();
 
     zinfo("Create and shuffle deck.");
     print_message(messageWindow, "Creating and shuffling deck.\n");
-    Table table;
+    Table table = {0};
     table.shoe = init_deck(1);
     shuffle_cards(table.shoe);
     
@@ -102,13 +158,13 @@ int main(void)
     zinfo("Calling dealer window with hole card down.");
     display_dealer(table.dealer);
     print_message(messageWindow, msg3);
-    wgetch(stdscr);
+    read_key();
     
     zinfo("Calling dealer window with both cards up.");
     table.dealer->faceup = TRUE;
     display_dealer(table.dealer);
     print_message(messageWindow, msg4);
-    wgetch(stdscr);
+    read_key();
     
     zinfo("Setting up player.");
     table.players = calloc(1, sizeof(Player));
@@ -120,18 +176,167 @@ int main(void)
     zinfo("Calling player window.");
     display_player(&table.players[0]);
     print_message(messageWindow, msg5);
-    wgetch(stdscr);
-    
-    
+    read_key();
+
+    zinfo("Dealing %d rounds.", ROUNDS);
+    table.numPlayers = 1;
+    for (uint8_t round = 1; round <= ROUNDS; round++)
+    {
+        char msg[80];
+
+        discard_hand(&table.dealer->hand);
+        discard_hand(&table.players[0].hand);
+        if (table.shoe->deal + 4 > table.shoe->cards) shuffle_cards(table.shoe);
+        table.dealer->faceup = FALSE;
+        display_table(&table);
+
+        snprintf(msg, sizeof(msg), "Round %u. Dealing cards.\n", round);
+        print_message(messageWindow, msg);
+        deal_card(table.shoe, &table.players[0].hand);
+        deal_card(table.shoe, &table.dealer->hand);
+        deal_card(table.shoe, &table.players[0].hand);
+        deal_card(table.shoe, &table.dealer->hand);
+        display_dealer(table.dealer);
+        display_player(&table.players[0]);
+
+        table.dealer->faceup = TRUE;
+        display_dealer(table.dealer);
+        snprintf(msg, sizeof(msg), "Round %u over. Press a key to continue.\n", round);
+        print_message(messageWindow, msg);
+        read_key();
+    }
+    discard_hand(&table.dealer->hand);
+    discard_hand(&table.players[0].hand);
+
+    FrameStats frames = frame_stats();
+    zinfo("Frames drawn: %llu, %llu bytes.", (unsigned long long) frames.frames, (unsigned long long) frames.bytes);
+
     zinfo("Freeing memory allocations.");
-    delwin(messageWindow);
     free(table.players);
     free(table.dealer);
     free(table.shoe->shoe);
     free(table.shoe);
     
     zinfo("Terminating curses mode.");
-    end_window(table.msgWin);
+    end_window();
     end_zlog();
-    return 0;
+    return;
+}
+
+/***************
+ *  Summary: Run the screens on a pseudo-terminal and measure their output
+ *
+ *  Description: Forks the screens onto a pseudo-terminal of CAPTURE_LINES by CAPTURE_COLS, then reads everything they
+ *      write, pressing a key each time the output stops. The bytes written before each key are printed, along with
+ *      the average for a round.
+ *
+ *  Parameter(s):
+ *      N/A
+ *
+ *  Returns:
+ *      status: EXIT_SUCCESS, or EXIT_FAILURE if the screens couldn't be run
+ */
+int capture_screens(void)
+{
+    struct winsize size = {.ws_row = CAPTURE_LINES, .ws_col = CAPTURE_COLS};
+    int terminal;
+
+    pid_t child = forkpty(&terminal, NULL, NULL, &size);
+    if (child < 0)
+    {
+        perror("forkpty");
+        return EXIT_FAILURE;
+    }
+    if (child == 0)
+    {
+        setenv("TERM", CAPTURE_TERM, 1);
+        run_screens();
+        _exit(EXIT_SUCCESS);
+    }
+
+    printf("Bytes written to a %dx%d %s terminal:\n", CAPTURE_COLS, CAPTURE_LINES, CAPTURE_TERM);
+    size_t total = 0, roundBytes = 0;
+    uint32_t step = 0;
+    bool running = TRUE;
+    while (running)
+    {
+        size_t bytes = 0;
+        running = drain_output(terminal, &bytes);
+        total += bytes;
+
+        uint32_t numSteps = sizeof(steps) / sizeof(steps[0]);
+        if (step < numSteps)
+        {
+            printf("  %-24s %8zu\n", steps[step], bytes);
+        }
+        else if (step < numSteps + ROUNDS)
+        {
+            printf("  round %-18u %8zu\n", step - numSteps + 1, bytes);
+            roundBytes += bytes;
+        }
+        else
+        {
+            printf("  %-24s %8zu\n", running ? "game over" : "end", bytes);
+        }
+
+        if (running && write(terminal, "x", 1) != 1) running = FALSE;
+        step++;
+    }
+    close(terminal);
+
+    int status;
+    waitpid(child, &status, 0);
+    printf("  %-24s %8zu\n", "total", total);
+    printf("  %-24s %8zu\n", "average round", roundBytes / ROUNDS);
+
+    return (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/***************
+ *  Summary: Read a terminal's output until it goes quiet
+ *
+ *  Parameter(s):
+ *      terminal: the pseudo-terminal's master side
+ *      bytes: the bytes read are added to this
+ *
+ *  Returns:
+ *      bool: FALSE once the other side has closed the terminal
+ */
+bool drain_output(int terminal, size_t *bytes)
+{
+    char buffer[4096];
+    struct pollfd waiting = {.fd = terminal, .events = POLLIN};
+
+    while (poll(&waiting, 1, QUIET_MS) > 0)
+    {
+        ssize_t got = read(terminal, buffer, sizeof(buffer));
+        if (got <= 0) return FALSE;     // EIO when the screens have exited
+        *bytes += got;
+    }
+
+    return TRUE;
+}
+
+/***************
+ *  Summary: Give a hand's cards back
+ *
+ *  Parameter(s):
+ *      hand: the Hand to empty
+ *
+ *  Returns:
+ *      N/A
+ */
+void discard_hand(Hand *hand)
+{
+    CardList *card = hand->cards;
+
+    while (card != NULL)
+    {
+        CardList *next = card->nextCard;
+        free(card);
+        card = next;
+    }
+    hand->cards = NULL;
+
+    return;
 }
@@ -0,0 +1,346 @@
+/***********************************************************************************
+ *  MIT License                                                                    *
+ *                                                                                 *
+ *  Copyright (c) 2018 Keri Southwood-Smith                                        *
+ *                                                                                 *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ *  of this software and associated documentation files (the "Software"), to deal  *
+ *  in the Software without restriction, including without limitation the rights   *
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ *  copies of the Software, and to permit persons to whom the Software is          *
+ *  furnished to do so, subject to the following conditions:                       *
+ *                                                                                 *
+ *  The above copyright notice and this permission notice shall be included in all *
+ *  copies or substantial portions of the Software.                                *
+ *                                                                                 *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ *  SOFTWARE.                                                                      *
+ ***********************************************************************************/
+
+/*
+ *  test_shuffle.c
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Description: Statistical checks that the shuffles are uniform. A single deck is shuffled from the same starting
+ *      order over and over, across one thread per core, counting where each card lands and which card follows which.
+ *      Both tables are judged with a chi-square test: for a uniform shuffle every card is equally likely in every
+ *      position, and every ordered pair of different cards equally likely to be adjacent. Sattolo's algorithm, the
+ *      Fisher-Yates slip that never leaves a card in place, is run alongside as a control the tests have to reject.
+ *      Exits with failure if a shuffle fails or the control passes.
+ */
+
+/************
+ * INCLUDES *
+ ************/
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "../src/logger.h"
+#include "../src/deck_of_cards.h"
+#include "../src/shoe_prep.h"
+
+/***********
+ * DEFINES *
+ ***********/
+#define SHUFFLES 200000000          // hundreds of millions for a nightly run, -n fewer for a quick check
+#define MAX_THREADS 256
+#define Z_LIMIT 5.0                 // upper tail of the normal, p about 3e-7, so a week of nightly runs stays quiet
+#define DEGREES ((CARDS_IN_DECK - 1) * (CARDS_IN_DECK - 1))
+
+typedef void (*ShuffleFunc)(Card *cards, uint16_t numCards, uint64_t *state);
+
+typedef struct Shuffler
+{
+    const char *name;
+    ShuffleFunc shuffle;
+    bool control;                   // known to be biased, the tests must reject it
+} Shuffler;
+
+typedef struct ShuffleWork          // one thread's share of the shuffles and its own counts
+{
+    const Shuffler *shuffler;
+    uint64_t shuffles;
+    uint64_t seed;
+    uint64_t positions[CARDS_IN_DECK][CARDS_IN_DECK];   // [position][card]
+    uint64_t pairs[CARDS_IN_DECK][CARDS_IN_DECK];       // [card][card after it]
+    pthread_t thread;
+} ShuffleWork;
+
+static uint8_t cardIds[256][256];   // by the rank's last character and the last byte of the suit's UTF-8
+
+/****************
+ * DECLARATIONS *
+ ****************/
+bool test_shuffler(const Shuffler *shuffler, uint64_t shuffles, uint16_t threads, uint64_t seed);
+void *shuffle_work(void *arg);
+double chi_square_z(double chiSquare, double degrees);
+void shuffle_random(Card *cards, uint16_t numCards, uint64_t *state);
+void shuffle_prepared(Card *cards, uint16_t numCards, uint64_t *state);
+void shuffle_discarded(Card *cards, uint16_t numCards, uint64_t *state);
+void shuffle_sattolo(Card *cards, uint16_t numCards, uint64_t *state);
+uint64_t next_random(uint64_t *state);
+
+int main(int argc, char *argv[])
+{
+    uint64_t shuffles = SHUFFLES;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = time(NULL);
+    const char *only = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:j:S:t:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                shuffles = strtoull(optarg, NULL, 10);
+                break;
+            case 'j':
+                threads = strtol(optarg, NULL, 10);
+                break;
+            case 'S':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 't':
+                only = optarg;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n shuffles (default %llu)] [-j threads] [-S seed] "
+                        "[-t shuffle_cards|shoe_prep|shuffle_discards|sattolo]\n", argv[0],
+                        (unsigned long long) SHUFFLES);
+                return EXIT_FAILURE;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (shuffles < (uint64_t) threads) shuffles = threads;
+
+    if (init_zlog("test_shuffle.conf", "shuffle_cat"))
+    {
+        return EXIT_FAILURE;
+    }
+    srandom(seed);
+
+    Card deck[CARDS_IN_DECK];
+    fill_cards(deck, CARDS_IN_DECK);
+    for (uint8_t card = 0; card < CARDS_IN_DECK; card++)
+    {
+        cardIds[(uint8_t) deck[card].rank[1]][(uint8_t) deck[card].suit[2]] = card;
+    }
+
+    static const Shuffler shufflers[] =
+    {
+        {"shuffle_cards", shuffle_random, false},
+        {"shoe_prep", shuffle_prepared, false},
+        {"shuffle_discards", shuffle_discarded, false},
+        {"sattolo", shuffle_sattolo, true},
+    };
+
+    printf("%llu shuffles of %d cards on %ld threads, seed %llu\n", (unsigned long long) shuffles, CARDS_IN_DECK,
+            threads, (unsigned long long) seed);
+    bool passed = true;
+    for (uint8_t shuffler = 0; shuffler < sizeof(shufflers) / sizeof(shufflers[0]); shuffler++)
+    {
+        if (only && strcmp(only, shufflers[shuffler].name)) continue;
+
+        bool uniform = test_shuffler(&shufflers[shuffler], shuffles, threads, seed);
+        passed = passed && (uniform != shufflers[shuffler].control);
+    }
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+
+    end_zlog();
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/***************
+ *  Summary: Run one shuffle through both tests
+ *
+ *  Description: The shuffles are split evenly across the threads, then their counts are added up and each table's
+ *      chi-square statistic is turned into a z score with the Wilson-Hilferty approximation. Both tables have
+ *      (52 - 1)^2 degrees of freedom: the position table because its rows and columns all add up to the number of
+ *      shuffles, and the pair table because each pair can turn up at most once a shuffle.
+ *
+ *  Parameter(s):
+ *      shuffler: the Shuffler to test
+ *      shuffles: the number of shuffles
+ *      threads: the number of threads to run them on
+ *      seed: seed for the threads' generators
+ *
+ *  Returns:
+ *      bool: true if both tests found the shuffle uniform
+ */
+bool test_shuffler(const Shuffler *shuffler, uint64_t shuffles, uint16_t threads, uint64_t seed)
+{
+    ShuffleWork *work = calloc(threads, sizeof(ShuffleWork));
+    if (work == NULL)
+    {
+        zerror("Couldn't allocate memory for %u threads.", threads);
+        return false;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint16_t thread = 0; thread < threads; thread++)
+    {
+        work[thread].shuffler = shuffler;
+        work[thread].shuffles = shuffles / threads + (thread < shuffles % threads);
+        work[thread].seed = seed ^ ((uint64_t) (thread + 1) << 48);
+        pthread_create(&work[thread].thread, NULL, shuffle_work, &work[thread]);
+    }
+
+    double positionChi = 0, pairChi = 0;
+    double expected = (double) shuffles / CARDS_IN_DECK;
+    for (uint16_t thread = 0; thread < threads; thread++)
+    {
+        pthread_join(work[thread].thread, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (uint8_t first = 0; first < CARDS_IN_DECK; first++)
+    {
+        for (uint8_t second = 0; second < CARDS_IN_DECK; second++)
+        {
+            uint64_t positions = 0, pairs = 0;
+            for (uint16_t thread = 0; thread < threads; thread++)
+            {
+                positions += work[thread].positions[first][second];
+                pairs += work[thread].pairs[first][second];
+            }
+
+            positionChi += (positions - expected) * (positions - expected) / expected;
+            if (first != second) pairChi += (pairs - expected) * (pairs - expected) / expected;
+        }
+    }
+    free(work);
+
+    double positionZ = chi_square_z(positionChi, DEGREES);
+    double pairZ = chi_square_z(pairChi, DEGREES);
+    bool uniform = (positionZ < Z_LIMIT && pairZ < Z_LIMIT);
+    printf("%-16s %6.1f s  position chi2 %12.1f (z %+9.2f)  pairs chi2 %12.1f (z %+9.2f)  %s%s\n", shuffler->name,
+            (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, positionChi, positionZ, pairChi, pairZ,
+            uniform ? "uniform" : "BIASED", shuffler->control ? " (control, expected biased)" : "");
+
+    return uniform;
+}
+
+/***************
+ *  Summary: Shuffle and count on one thread
+ *
+ *  Description: Every shuffle starts from the same order, so where a card lands is measured against where it started.
+ *
+ *  Parameter(s):
+ *      arg: the thread's ShuffleWork struct
+ *
+ *  Returns:
+ *      NULL
+ */
+void *shuffle_work(void *arg)
+{
+    ShuffleWork *work = arg;
+    Card deck[CARDS_IN_DECK], cards[CARDS_IN_DECK];
+    uint64_t state = work->seed;
+
+    fill_cards(deck, CARDS_IN_DECK);
+    for (uint64_t shuffle = 0; shuffle < work->shuffles; shuffle++)
+    {
+        memcpy(cards, deck, sizeof(cards));
+        work->shuffler->shuffle(cards, CARDS_IN_DECK, &state);
+
+        uint8_t previous = 0;
+        for (uint8_t position = 0; position < CARDS_IN_DECK; position++)
+        {
+            uint8_t card = cardIds[(uint8_t) cards[position].rank[1]][(uint8_t) cards[position].suit[2]];
+            work->positions[position][card]++;
+            if (position > 0) work->pairs[previous][card]++;
+            previous = card;
+        }
+    }
+
+    return NULL;
+}
+
+/***************
+ *  Summary: Turn a chi-square statistic into a z score
+ *
+ *  Description: The Wilson-Hilferty cube root approximation, close enough at thousands of degrees of freedom.
+ *
+ *  Parameter(s):
+ *      chiSquare: the statistic
+ *      degrees: its degrees of freedom
+ *
+ *  Returns:
+ *      z: standard normal score, large and positive when the counts are further from uniform than chance allows
+ */
+double chi_square_z(double chiSquare, double degrees)
+{
+    double spread = 2.0 / (9.0 * degrees);
+
+    return (cbrt(chiSquare / degrees) - (1.0 - spread)) / sqrt(spread);
+}
+
+/***************
+ *  Summary: The shuffles under test, all with the same signature
+ *
+ *  Description: shuffle_random runs the shoe's own shuffle_cards, which draws from random() and so shares its one
+ *      generator, and its lock, across the threads. shuffle_prepared is the background shoe's shuffle with a seed
+ *      for each shuffle, as shoe_prep gives it. shuffle_discarded deals two thirds of the deck, in order, and shuffles
+ *      them back with shuffle_discards; the third left in the shoe is put in random order first, as a shoe's undealt
+ *      cards always are. shuffle_sattolo is the control.
+ */
+void shuffle_random(Card *cards, uint16_t numCards, uint64_t *state)
+{
+    (void) state;
+    Deck shoe = {.shoe = cards, .kind = SHOE_ORDERED, .cards = numCards};
+
+    shuffle_cards(&shoe);
+}
+
+void shuffle_prepared(Card *cards, uint16_t numCards, uint64_t *state)
+{
+    shoe_prep_shuffle(cards, numCards, next_random(state));
+}
+
+void shuffle_discarded(Card *cards, uint16_t numCards, uint64_t *state)
+{
+    Deck shoe = {.shoe = cards, .kind = SHOE_ORDERED, .cards = numCards, .deal = numCards * 2 / 3};
+
+    shoe_prep_shuffle(cards + shoe.deal, numCards - shoe.deal, next_random(state));
+    shuffle_discards(&shoe);
+}
+
+void shuffle_sattolo(Card *cards, uint16_t numCards, uint64_t *state)
+{
+    for (int card = numCards - 1; card > 0; card--)
+    {
+        uint16_t swap = next_random(state) % card;
+
+        Card cardTmp = cards[swap];
+        cards[swap] = cards[card];
+        cards[card] = cardTmp;
+    }
+}
+
+uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+    return z ^ (z >> 31);
+}